@@ -0,0 +1,282 @@
+#include "AdaptiveScan.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+constexpr int AdaptiveScan::maxScanDepth;
+
+AdaptiveScan::AdaptiveScan(
+	const SIRSInputParameters &baseParameters,
+	Evaluator evaluator,
+	double orderTolerance,
+	double susceptibilityFraction
+	) : m_baseParameters(baseParameters),
+		m_evaluator(evaluator),
+		m_orderTolerance{orderTolerance},
+		m_susceptibilityFraction{susceptibilityFraction}
+{
+
+}
+
+const SIRSResults& AdaptiveScan::evaluate(long i, long j, const SIRSInputParameters &parameters)
+{
+	auto key = std::make_pair(i, j);
+	auto cached = m_cache.find(key);
+	if(cached != m_cache.end())
+	{
+		return cached->second;
+	}
+
+	return m_cache[key] = m_evaluator(parameters);
+}
+
+bool AdaptiveScan::needsRefinement(const std::vector<const SIRSResults*> &corners, double peakSusceptibility) const
+{
+	double minOrder = corners.front()->orderParameter;
+	double maxOrder = corners.front()->orderParameter;
+	double maxSusceptibility = corners.front()->susceptibility;
+
+	for(const auto &corner : corners)
+	{
+		minOrder = std::min(minOrder, corner->orderParameter);
+		maxOrder = std::max(maxOrder, corner->orderParameter);
+		maxSusceptibility = std::max(maxSusceptibility, corner->susceptibility);
+	}
+
+	// Refine across sharp changes in the order parameter or near the susceptibility peak.
+	return (maxOrder - minOrder > m_orderTolerance) ||
+		   (peakSusceptibility > 0 && maxSusceptibility >= m_susceptibilityFraction * peakSusceptibility);
+}
+
+void AdaptiveScan::checkGrid(int coarseCount, int maxDepth)
+{
+	if(coarseCount < 1)
+	{
+		throw std::invalid_argument("A scan needs at least one coarse interval but got " + std::to_string(coarseCount));
+	}
+
+	if(maxDepth < 0 || maxDepth > maxScanDepth)
+	{
+		throw std::invalid_argument("Scan depth must be between 0 and " + std::to_string(maxScanDepth) + " but got " + std::to_string(maxDepth));
+	}
+}
+
+std::vector<AdaptiveScan::ScanPoint> AdaptiveScan::scanProbabilities(int coarseCount, int maxDepth)
+{
+	checkGrid(coarseCount, maxDepth);
+	m_cache.clear();
+
+	// Every point lies on the finest grid so it can be identified by integer coordinates.
+	const long scale = static_cast<long>(coarseCount) << maxDepth;
+
+	SIRSInputParameters parameters = m_baseParameters;
+	auto point = [&](long i, long j) -> const SIRSResults&
+	{
+		parameters.probSI = static_cast<double>(i)/scale;
+		parameters.probRS = static_cast<double>(j)/scale;
+		return evaluate(i, j, parameters);
+	};
+
+	// A cell is the square with lower corner (i,j) and side length size on the finest grid.
+	struct Cell
+	{
+		long i;
+		long j;
+		long size;
+		int depth;
+	};
+
+	std::vector<Cell> cells;
+	for(int a = 0; a < coarseCount; ++a)
+	{
+		for(int b = 0; b < coarseCount; ++b)
+		{
+			cells.push_back(Cell{static_cast<long>(a) << maxDepth, static_cast<long>(b) << maxDepth, 1L << maxDepth, 0});
+		}
+	}
+
+	// Work level by level so the peak susceptibility is known before deciding what to refine.
+	while(!cells.empty())
+	{
+		std::vector<std::vector<const SIRSResults*> > corners;
+		corners.reserve(cells.size());
+		for(const auto &cell : cells)
+		{
+			corners.push_back(
+			{
+				&point(cell.i, cell.j),
+				&point(cell.i + cell.size, cell.j),
+				&point(cell.i, cell.j + cell.size),
+				&point(cell.i + cell.size, cell.j + cell.size),
+			});
+		}
+
+		double peakSusceptibility = 0;
+		for(const auto &entry : m_cache)
+		{
+			peakSusceptibility = std::max(peakSusceptibility, entry.second.susceptibility);
+		}
+
+		std::vector<Cell> refined;
+		for(std::size_t c = 0; c < cells.size(); ++c)
+		{
+			const Cell &cell = cells[c];
+			if(cell.depth < maxDepth && needsRefinement(corners[c], peakSusceptibility))
+			{
+				long half = cell.size / 2;
+				refined.push_back(Cell{cell.i, cell.j, half, cell.depth + 1});
+				refined.push_back(Cell{cell.i + half, cell.j, half, cell.depth + 1});
+				refined.push_back(Cell{cell.i, cell.j + half, half, cell.depth + 1});
+				refined.push_back(Cell{cell.i + half, cell.j + half, half, cell.depth + 1});
+			}
+		}
+
+		cells.swap(refined);
+	}
+
+	// The cache is ordered by i then j which is p1 then p3.
+	std::vector<ScanPoint> points;
+	points.reserve(m_cache.size());
+	for(const auto &entry : m_cache)
+	{
+		points.push_back(ScanPoint
+		{
+			static_cast<double>(entry.first.first)/scale,
+			static_cast<double>(entry.first.second)/scale,
+			entry.second
+		});
+	}
+
+	return points;
+}
+
+std::vector<AdaptiveScan::ScanPoint> AdaptiveScan::scanImmunity(double low, double high, int coarseCount, int maxDepth)
+{
+	checkGrid(coarseCount, maxDepth);
+	m_cache.clear();
+
+	const long scale = static_cast<long>(coarseCount) << maxDepth;
+
+	SIRSInputParameters parameters = m_baseParameters;
+	auto immuneFraction = [&](long i)
+	{
+		return low + (high - low) * static_cast<double>(i)/scale;
+	};
+	auto point = [&](long i) -> const SIRSResults&
+	{
+		parameters.immuneFraction = immuneFraction(i);
+		return evaluate(i, 0, parameters);
+	};
+
+	// An interval starts at i and has length size on the finest grid.
+	struct Interval
+	{
+		long i;
+		long size;
+		int depth;
+	};
+
+	std::vector<Interval> intervals;
+	for(int a = 0; a < coarseCount; ++a)
+	{
+		intervals.push_back(Interval{static_cast<long>(a) << maxDepth, 1L << maxDepth, 0});
+	}
+
+	while(!intervals.empty())
+	{
+		std::vector<std::vector<const SIRSResults*> > ends;
+		ends.reserve(intervals.size());
+		for(const auto &interval : intervals)
+		{
+			ends.push_back({&point(interval.i), &point(interval.i + interval.size)});
+		}
+
+		double peakSusceptibility = 0;
+		for(const auto &entry : m_cache)
+		{
+			peakSusceptibility = std::max(peakSusceptibility, entry.second.susceptibility);
+		}
+
+		std::vector<Interval> refined;
+		for(std::size_t n = 0; n < intervals.size(); ++n)
+		{
+			const Interval &interval = intervals[n];
+			if(interval.depth < maxDepth && needsRefinement(ends[n], peakSusceptibility))
+			{
+				long half = interval.size / 2;
+				refined.push_back(Interval{interval.i, half, interval.depth + 1});
+				refined.push_back(Interval{interval.i + half, half, interval.depth + 1});
+			}
+		}
+
+		intervals.swap(refined);
+	}
+
+	std::vector<ScanPoint> points;
+	points.reserve(m_cache.size());
+	for(const auto &entry : m_cache)
+	{
+		points.push_back(ScanPoint{immuneFraction(entry.first.first), 0.0, entry.second});
+	}
+
+	return points;
+}
+
+double AdaptiveScan::bisectImmuneThreshold(double low, double high, double tolerance)
+{
+	SIRSInputParameters parameters = m_baseParameters;
+
+	// The epidemic is dead if on average less than a single cell is infected, counted in whatever
+	// population the evaluator simulated, which is not rows times columns for networks or other dimensions.
+	auto dead = [&](double immuneFraction)
+	{
+		parameters.immuneFraction = immuneFraction;
+		SIRSResults results = m_evaluator(parameters);
+		return results.orderParameter * results.population < 1.0;
+	};
+
+	if(dead(low) || !dead(high))
+	{
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	while(high - low > tolerance)
+	{
+		double middle = 0.5 * (low + high);
+		if(dead(middle))
+		{
+			high = middle;
+		}
+		else
+		{
+			low = middle;
+		}
+	}
+
+	return 0.5 * (low + high);
+}
+
+void AdaptiveScan::writeProbabilityScan(std::ostream &orderOut, std::ostream &susceptibilityOut, const std::vector<ScanPoint> &points)
+{
+	for(std::size_t n = 0; n < points.size(); ++n)
+	{
+		// Insert blank lines when p1 changes so they can be plotted via pm3d as heat maps.
+		if(n > 0 && points[n].x != points[n-1].x)
+		{
+			orderOut << '\n';
+			susceptibilityOut << '\n';
+		}
+
+		orderOut << points[n].x << ' ' << points[n].y << ' ' << points[n].results.orderParameter << '\n';
+		susceptibilityOut << points[n].x << ' ' << points[n].y << ' ' << points[n].results.susceptibility << '\n';
+	}
+}
+
+void AdaptiveScan::writeImmunityScan(std::ostream &out, const std::vector<ScanPoint> &points)
+{
+	for(const auto &point : points)
+	{
+		out << point.x << ' ' << point.results.orderParameter << ' ' << point.results.orderParameterError << '\n';
+	}
+}
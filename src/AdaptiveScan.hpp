@@ -0,0 +1,154 @@
+#ifndef AdaptiveScan_hpp
+#define AdaptiveScan_hpp
+
+#include "SIRSInputParameters.hpp"
+#include "SIRSResults.hpp"
+#include <functional>
+#include <vector>
+#include <map>
+#include <utility>
+#include <iostream>
+
+/**
+ *\file
+ *\class AdaptiveScan
+ *\brief Class for scanning the phase diagram with refinement concentrated where it changes.
+ *
+ * A scan starts on a coarse grid and repeatedly subdivides the cells in which the order parameter
+ * changes sharply between corners, or in which the susceptibility is close to the largest value seen
+ * so far. Flat regions are therefore sampled only at the coarse resolution. Points are evaluated
+ * through a user supplied function so the same refinement can be driven by full simulations or by
+ * anything else that produces SIRSResults.
+ */
+class AdaptiveScan
+{
+public:
+	/// Function that produces the results for a set of parameters.
+	using Evaluator = std::function<SIRSResults(const SIRSInputParameters&)>;
+
+	/// Largest refinement depth, which keeps coarseCount << depth well inside a long.
+	static constexpr int maxScanDepth = 30;
+
+	/**
+	 *\class ScanPoint
+	 *\brief Class holding the coordinates of an evaluated point and its results.
+	 */
+	class ScanPoint
+	{
+	public:
+		/// First coordinate, p1 or the immune fraction.
+		double x;
+		/// Second coordinate, p3 or unused for one dimensional scans.
+		double y;
+		/// Results at this point.
+		SIRSResults results;
+	};
+
+private:
+	/// Member variable holding the parameters that are not being scanned.
+	SIRSInputParameters m_baseParameters;
+
+	/// Member variable for the function used to evaluate each point.
+	Evaluator m_evaluator;
+
+	/// Member variable for the order parameter change between neighbouring points that triggers refinement.
+	double m_orderTolerance;
+
+	/// Member variable for the fraction of the peak susceptibility above which cells are refined.
+	double m_susceptibilityFraction;
+
+	/// Member variable caching the results of evaluated points on the finest grid.
+	std::map<std::pair<long, long>, SIRSResults> m_cache;
+
+	/**
+	 *\brief Evaluates a point on the finest grid, reusing the cached result if there is one.
+	 *\param i integer coordinate along the first axis.
+	 *\param j integer coordinate along the second axis.
+	 *\param parameters SIRSInputParameters instance with the scanned values filled in.
+	 *\return constant SIRSResults reference for the point.
+	 */
+	const SIRSResults& evaluate(long i, long j, const SIRSInputParameters &parameters);
+
+	/**
+	 *\brief Decides whether a cell should be subdivided from the results at its corners.
+	 *\param corners vector of the results at the corners of the cell.
+	 *\param peakSusceptibility floating point value representing the largest susceptibility seen so far.
+	 *\return Boolean value representing whether the cell should be refined.
+	 */
+	bool needsRefinement(const std::vector<const SIRSResults*> &corners, double peakSusceptibility) const;
+
+	/**
+	 *\brief Checks the arguments of a scan describe a grid whose finest points can be numbered.
+	 *\param coarseCount integer value representing the number of intervals along each axis of the initial grid.
+	 *\param maxDepth integer value representing the maximum number of times an interval can be halved.
+	 *
+	 * Throws std::invalid_argument unless coarseCount is at least 1 and maxDepth is from 0 to maxScanDepth.
+	 */
+	static void checkGrid(int coarseCount, int maxDepth);
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param baseParameters SIRSInputParameters reference for all parameters that are not scanned.
+	 *\param evaluator Evaluator that runs a single point.
+	 *\param orderTolerance floating point value for the order parameter change that triggers refinement.
+	 *\param susceptibilityFraction floating point value for the fraction of the peak susceptibility that triggers refinement.
+	 */
+	AdaptiveScan(
+		const SIRSInputParameters &baseParameters,
+		Evaluator evaluator,
+		double orderTolerance = 0.05,
+		double susceptibilityFraction = 0.5);
+
+	/**
+	 *\brief Scans the p1-p3 plane over [0,1]x[0,1].
+	 *\param coarseCount integer value representing the number of cells along each axis of the initial grid.
+	 *\param maxDepth integer value representing the maximum number of times a cell can be halved.
+	 *\return vector of ScanPoint instances with x = p1 and y = p3, sorted by p1 then p3.
+	 *
+	 * Throws std::invalid_argument if the grid is empty or maxDepth is outside 0 to maxScanDepth.
+	 */
+	std::vector<ScanPoint> scanProbabilities(int coarseCount, int maxDepth);
+
+	/**
+	 *\brief Scans the immune fraction over a range.
+	 *\param low floating point value representing the smallest immune fraction.
+	 *\param high floating point value representing the largest immune fraction.
+	 *\param coarseCount integer value representing the number of intervals in the initial grid.
+	 *\param maxDepth integer value representing the maximum number of times an interval can be halved.
+	 *\return vector of ScanPoint instances with x = immune fraction, sorted by x.
+	 *
+	 * Throws std::invalid_argument if the grid is empty or maxDepth is outside 0 to maxScanDepth.
+	 */
+	std::vector<ScanPoint> scanImmunity(double low, double high, int coarseCount, int maxDepth);
+
+	/**
+	 *\brief Bisects for the smallest immune fraction at which the epidemic dies out.
+	 *\param low floating point value representing an immune fraction at which the epidemic survives.
+	 *\param high floating point value representing an immune fraction at which the epidemic dies out.
+	 *\param tolerance floating point value representing the width of the final bracket.
+	 *\return floating point value representing the middle of the final bracket, NaN if [low,high] is not a bracket.
+	 *
+	 * The epidemic is considered dead when less than one cell is infected on average.
+	 */
+	double bisectImmuneThreshold(double low, double high, double tolerance);
+
+	/**
+	 *\brief Outputs a p1-p3 scan in the same format as collate.sh.
+	 *\param orderOut std::ostream reference for the order parameter, lines of "p1 p3 order".
+	 *\param susceptibilityOut std::ostream reference for the susceptibility, lines of "p1 p3 susceptibility".
+	 *\param points vector of ScanPoint instances sorted by p1 then p3.
+	 *
+	 * A blank line is inserted whenever p1 changes so the files can be plotted with pm3d.
+	 */
+	static void writeProbabilityScan(std::ostream &orderOut, std::ostream &susceptibilityOut, const std::vector<ScanPoint> &points);
+
+	/**
+	 *\brief Outputs an immune fraction scan in the same format as collate.sh.
+	 *\param out std::ostream reference, lines of "immune-fraction order error".
+	 *\param points vector of ScanPoint instances sorted by immune fraction.
+	 */
+	static void writeImmunityScan(std::ostream &out, const std::vector<ScanPoint> &points);
+};
+
+#endif /* AdaptiveScan_hpp */
@@ -0,0 +1,280 @@
+#include "ClusterAnalysis.hpp"
+#include "parallelFor.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+
+ClusterAnalysis::ClusterAnalysis(int threadCount) : m_threadCount{threadCount}, m_spanningCount{0}, m_latticeSize{0}
+{
+
+}
+
+int ClusterAnalysis::findRoot(int index)
+{
+	// Path halving, every other cell on the way is pointed at its grandparent.
+	while(m_parent[index] != index)
+	{
+		m_parent[index] = m_parent[m_parent[index]];
+		index = m_parent[index];
+	}
+
+	return index;
+}
+
+void ClusterAnalysis::merge(int a, int b)
+{
+	int rootA = findRoot(a);
+	int rootB = findRoot(b);
+
+	if(rootA < rootB)
+	{
+		m_parent[rootB] = rootA;
+	}
+	else if(rootB < rootA)
+	{
+		m_parent[rootA] = rootB;
+	}
+}
+
+void ClusterAnalysis::labelTile(const SIRSArray &lattice, int rowBegin, int rowEnd)
+{
+	const SIRSArray::StateVector &board = lattice.getBoardData();
+	const int cols = lattice.getCols();
+
+	for(int row = rowBegin; row < rowEnd; ++row)
+	{
+		for(int col = 0; col < cols; ++col)
+		{
+			int index = col + row * cols;
+			if(SIRSArray::Infected != board[index])
+			{
+				m_parent[index] = -1;
+				continue;
+			}
+
+			m_parent[index] = index;
+
+			// Only look back at cells that have already been labelled and are inside this tile.
+			if(col > 0 && SIRSArray::Infected == board[index - 1])
+			{
+				merge(index, index - 1);
+			}
+
+			if(row > rowBegin && SIRSArray::Infected == board[index - cols])
+			{
+				merge(index, index - cols);
+			}
+		}
+
+		// Periodic boundary conditions along the row.
+		int first = row * cols;
+		int last  = first + cols - 1;
+		if(cols > 1 && SIRSArray::Infected == board[first] && SIRSArray::Infected == board[last])
+		{
+			merge(first, last);
+		}
+	}
+}
+
+bool ClusterAnalysis::wraps(int rows, int cols)
+{
+	const int size = rows * cols;
+	const int unreached = std::numeric_limits<int>::min();
+	const int steps[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+	std::fill(m_unwrappedRow.begin(), m_unwrappedRow.end(), unreached);
+	for(int start = 0; start < size; ++start)
+	{
+		if(m_label[start] < 0 || unreached != m_unwrappedRow[start])
+		{
+			continue;
+		}
+
+		// Every infected neighbour is in the same cluster, so the walk covers exactly this cluster.
+		m_unwrappedRow[start] = start / cols;
+		m_unwrappedCol[start] = start % cols;
+		m_stack.assign(1, start);
+		while(!m_stack.empty())
+		{
+			const int index = m_stack.back();
+			m_stack.pop_back();
+
+			const int row = index / cols;
+			const int col = index - row * cols;
+			for(const auto &step : steps)
+			{
+				const int neighbour = (col + step[1] + cols) % cols + ((row + step[0] + rows) % rows) * cols;
+				if(m_label[neighbour] < 0)
+				{
+					continue;
+				}
+
+				const int unwrappedRow = m_unwrappedRow[index] + step[0];
+				const int unwrappedCol = m_unwrappedCol[index] + step[1];
+				if(unreached == m_unwrappedRow[neighbour])
+				{
+					m_unwrappedRow[neighbour] = unwrappedRow;
+					m_unwrappedCol[neighbour] = unwrappedCol;
+					m_stack.push_back(neighbour);
+				}
+				else if(unwrappedRow != m_unwrappedRow[neighbour] || unwrappedCol != m_unwrappedCol[neighbour])
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+ClusterAnalysis::Labelling ClusterAnalysis::label(const SIRSArray &lattice)
+{
+	const SIRSArray::StateVector &board = lattice.getBoardData();
+	const int rows = lattice.getRows();
+	const int cols = lattice.getCols();
+	const int size = lattice.getSize();
+
+	if(static_cast<int>(m_parent.size()) != size)
+	{
+		m_parent.resize(size);
+		m_label.resize(size);
+		m_clusterSize.resize(size);
+		m_unwrappedRow.resize(size);
+		m_unwrappedCol.resize(size);
+	}
+
+	Labelling labelling{size, 0, 0, false, std::vector<int>()};
+
+	// Label each tile independently, recording where the tiles start so they can be stitched together.
+	const int tileCount = std::max(1, std::min(m_threadCount, rows));
+	std::vector<int> tileBegin(tileCount);
+	parallelFor(0, rows, tileCount, [this, &lattice, &tileBegin](int rowBegin, int rowEnd, int tile)
+	{
+		tileBegin[tile] = rowBegin;
+		labelTile(lattice, rowBegin, rowEnd);
+	});
+
+	// Merge across the first row of every tile and the row above it, for the first tile this is the
+	// periodic boundary between the last and first rows.
+	for(int tile = 0; tile < tileCount; ++tile)
+	{
+		int row   = tileBegin[tile];
+		int above = (row + rows - 1) % rows;
+		for(int col = 0; col < cols; ++col)
+		{
+			int index      = col + row * cols;
+			int aboveIndex = col + above * cols;
+			if(SIRSArray::Infected == board[index] && SIRSArray::Infected == board[aboveIndex])
+			{
+				merge(index, aboveIndex);
+			}
+		}
+	}
+
+	// Resolve every cell to its root, the parent array is only read here so the tiles can share it.
+	parallelFor(0, size, m_threadCount, [this](int begin, int end, int)
+	{
+		for(int index = begin; index < end; ++index)
+		{
+			int root = m_parent[index];
+			if(root >= 0)
+			{
+				while(m_parent[root] != root)
+				{
+					root = m_parent[root];
+				}
+			}
+
+			m_label[index] = root;
+		}
+	});
+
+	std::fill(m_clusterSize.begin(), m_clusterSize.end(), 0);
+	for(int index = 0; index < size; ++index)
+	{
+		if(m_label[index] >= 0 && 0 == m_clusterSize[m_label[index]]++)
+		{
+			++labelling.clusterCount;
+		}
+	}
+
+	labelling.clusterSizes.reserve(labelling.clusterCount);
+	for(int index = 0; index < size; ++index)
+	{
+		if(m_clusterSize[index] > 0)
+		{
+			labelling.clusterSizes.push_back(m_clusterSize[index]);
+			labelling.largest = std::max(labelling.largest, m_clusterSize[index]);
+		}
+	}
+
+	labelling.spanning = wraps(rows, cols);
+	return labelling;
+}
+
+void ClusterAnalysis::add(const Labelling &labelling)
+{
+	if(labelling.latticeSize != m_latticeSize)
+	{
+		m_latticeSize = labelling.latticeSize;
+		m_sizeHistogram.assign(m_latticeSize + 1, 0);
+	}
+
+	for(int clusterSize : labelling.clusterSizes)
+	{
+		++m_sizeHistogram[clusterSize];
+	}
+
+	m_largestCluster.push_back(labelling.largest);
+	m_clusterCount.push_back(labelling.clusterCount);
+
+	if(labelling.spanning)
+	{
+		++m_spanningCount;
+	}
+}
+
+void ClusterAnalysis::measure(const SIRSArray &lattice)
+{
+	add(label(lattice));
+}
+
+const std::vector<long long>& ClusterAnalysis::getSizeHistogram() const
+{
+	return m_sizeHistogram;
+}
+
+const DataArray& ClusterAnalysis::getLargestClusterData() const
+{
+	return m_largestCluster;
+}
+
+double ClusterAnalysis::spanningProbability() const
+{
+	return m_largestCluster.getSize() > 0 ? static_cast<double>(m_spanningCount)/m_largestCluster.getSize() : 0.0;
+}
+
+void ClusterAnalysis::writeHistogram(std::ostream &out) const
+{
+	for(std::size_t clusterSize = 1; clusterSize < m_sizeHistogram.size(); ++clusterSize)
+	{
+		if(m_sizeHistogram[clusterSize] > 0)
+		{
+			out << clusterSize << ' ' << m_sizeHistogram[clusterSize] << '\n';
+		}
+	}
+}
+
+std::ostream& operator<<(std::ostream &out, const ClusterAnalysis &clusters)
+{
+	int outputColumnWidth = 30;
+	out << "Clusters..." << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Largest-Cluster: " <<
+	std::right << clusters.m_largestCluster.mean()/clusters.m_latticeSize << " +/- " << clusters.m_largestCluster.error()/clusters.m_latticeSize << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Cluster-Count: " <<
+	std::right << clusters.m_clusterCount.mean() << " +/- " << clusters.m_clusterCount.error() << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Spanning-Probability: " <<
+	std::right << clusters.spanningProbability() << '\n';
+	return out;
+}
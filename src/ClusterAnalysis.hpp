@@ -0,0 +1,183 @@
+#ifndef ClusterAnalysis_hpp
+#define ClusterAnalysis_hpp
+
+#include "SIRSArray.hpp"
+#include "DataArray.hpp"
+#include <vector>
+#include <iostream>
+
+/**
+ *\file
+ *\class ClusterAnalysis
+ *\brief Class for labelling clusters of infected cells and accumulating their statistics over measurements.
+ *
+ * Clusters are sets of infected cells connected through their N,E,S,W neighbours with periodic boundary
+ * conditions. They are labelled with a Hoshen-Kopelman style union-find: each thread labels a tile of
+ * rows on its own, the tiles are then merged along their boundaries, including the wrap from the last
+ * row to the first. The size histogram, the largest cluster and whether any cluster spans the lattice,
+ * that is wraps round the torus, are accumulated in memory so they can be written once at the end of
+ * the run.
+ *
+ * Labelling and accumulating are separate steps so a lattice can be labelled on one thread, each
+ * with its own ClusterAnalysis for the scratch arrays, and the labellings added to the totals in
+ * sweep order by another.
+ */
+class ClusterAnalysis
+{
+public:
+	/**
+	 *\struct Labelling
+	 *\brief Struct holding the statistics of the clusters on a single lattice.
+	 */
+	struct Labelling
+	{
+		/// Number of cells in the lattice that was labelled.
+		int latticeSize;
+
+		/// Size of the largest cluster.
+		int largest;
+
+		/// Number of clusters.
+		int clusterCount;
+
+		/// Whether any cluster wrapped round the lattice along the rows or the columns.
+		bool spanning;
+
+		/// Size of every cluster.
+		std::vector<int> clusterSizes;
+	};
+
+private:
+	/// Member variable for the number of threads used to label the tiles.
+	int m_threadCount;
+
+	/// Member variable holding the union-find parent of each cell, -1 for cells that are not infected.
+	std::vector<int> m_parent;
+
+	/// Member variable holding the root of the cluster each cell belongs to, -1 for cells that are not infected.
+	std::vector<int> m_label;
+
+	/// Member variable holding the size of the cluster rooted at each cell.
+	std::vector<int> m_clusterSize;
+
+	/// Member variable holding the unwrapped row each cell was reached at while walking its cluster.
+	std::vector<int> m_unwrappedRow;
+
+	/// Member variable holding the unwrapped column each cell was reached at while walking its cluster.
+	std::vector<int> m_unwrappedCol;
+
+	/// Member variable holding the cells waiting to be walked from.
+	std::vector<int> m_stack;
+
+	/// Member variable holding the number of clusters of each size summed over all measurements.
+	std::vector<long long> m_sizeHistogram;
+
+	/// Member variable holding the size of the largest cluster on each measurement.
+	DataArray m_largestCluster;
+
+	/// Member variable holding the number of clusters on each measurement.
+	DataArray m_clusterCount;
+
+	/// Member variable counting the measurements on which a cluster spanned the lattice.
+	int m_spanningCount;
+
+	/// Member variable for the number of cells in the lattice being measured.
+	int m_latticeSize;
+
+	/**
+	 *\brief Finds the root of the cluster a cell belongs to, compressing the path on the way.
+	 *\param index integer index of an infected cell.
+	 *\return integer index of the root cell.
+	 */
+	int findRoot(int index);
+
+	/**
+	 *\brief Merges the clusters two infected cells belong to, the smaller root index becomes the root.
+	 *\param a integer index of the first cell.
+	 *\param b integer index of the second cell.
+	 */
+	void merge(int a, int b);
+
+	/**
+	 *\brief Labels the infected cells of a tile of rows considering only connections inside the tile.
+	 *\param lattice constant SIRSArray reference being measured.
+	 *\param rowBegin first row of the tile.
+	 *\param rowEnd one past the last row of the tile.
+	 */
+	void labelTile(const SIRSArray &lattice, int rowBegin, int rowEnd);
+
+	/**
+	 *\brief Decides whether any cluster of the labelled lattice wraps round the torus.
+	 *\param rows integer number of rows of the lattice.
+	 *\param cols integer number of columns of the lattice.
+	 *\return Boolean value, true if some cluster connects a cell to a copy of itself a whole number of lattice lengths away.
+	 *
+	 * Touching every row or every column is not enough on a periodic lattice, a band can do that without
+	 * joining up with itself. Each cluster is walked from one of its cells instead, remembering the unwrapped
+	 * position each cell is first reached at, and it wraps if a cell is reached again at a different one.
+	 */
+	bool wraps(int rows, int cols);
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param threadCount Integer value representing the number of threads used for labelling.
+	 */
+	ClusterAnalysis(int threadCount = 1);
+
+	/**
+	 *\brief Labels the clusters on the lattice without adding them to the totals.
+	 *\param lattice constant SIRSArray reference to label.
+	 *\return Labelling of the lattice.
+	 */
+	Labelling label(const SIRSArray &lattice);
+
+	/**
+	 *\brief Adds the statistics of a labelled lattice to the totals.
+	 *\param labelling constant Labelling reference, possibly from another ClusterAnalysis.
+	 */
+	void add(const Labelling &labelling);
+
+	/**
+	 *\brief Labels the clusters on the lattice and adds their statistics to the totals.
+	 *\param lattice constant SIRSArray reference to measure.
+	 */
+	void measure(const SIRSArray &lattice);
+
+	/**
+	 *\brief Getter for the cluster size histogram.
+	 *\return constant reference to the vector where element s is the number of clusters of size s seen over all measurements.
+	 */
+	const std::vector<long long>& getSizeHistogram() const;
+
+	/**
+	 *\brief Getter for the size of the largest cluster on each measurement.
+	 *\return constant DataArray reference.
+	 */
+	const DataArray& getLargestClusterData() const;
+
+	/**
+	 *\brief Calculates the fraction of measurements on which a cluster wrapped round the lattice.
+	 *\return Floating point value representing the spanning probability.
+	 */
+	double spanningProbability() const;
+
+	/**
+	 *\brief Outputs the non-empty bins of the size histogram as lines of "size count".
+	 *\param out std::ostream reference that is being streamed to.
+	 */
+	void writeHistogram(std::ostream &out) const;
+
+	/**
+	 *\brief operator<< overload for outputting a summary of the cluster statistics.
+	 *\param out std::ostream reference that is being streamed to.
+	 *\param clusters constant ClusterAnalysis reference to be output.
+	 *\return std::ostream reference so the operator can be chained.
+	 *
+	 * The summary is a formatted table in the same style as SIRSResults, the largest cluster is given as
+	 * a fraction of the lattice.
+	 */
+	friend std::ostream& operator<<(std::ostream &out, const ClusterAnalysis &clusters);
+};
+
+#endif /* ClusterAnalysis_hpp */
@@ -0,0 +1,182 @@
+#include "CorrelationFunction.hpp"
+#include <cmath>
+#include <limits>
+#include <iomanip>
+#include <algorithm>
+
+CorrelationFunction::CorrelationFunction(
+	int rows,
+	int cols
+	) : m_rowCount{rows},
+		m_colCount{cols},
+		m_rowTransform(cols),
+		m_colTransform(rows),
+		m_field(rows * cols),
+		m_structureFactorSum(rows * cols, 0.0),
+		m_measurementCount{0}
+{
+
+}
+
+void CorrelationFunction::transformField(const SIRSArray &lattice)
+{
+	const SIRSArray::StateVector &board = lattice.getBoardData();
+	const int size = m_rowCount * m_colCount;
+
+	// Subtract the average so the k = 0 mode does not swamp everything else.
+	double infectedFraction = lattice.stateFraction(SIRSArray::Infected);
+	for(int index = 0; index < size; ++index)
+	{
+		m_field[index] = (SIRSArray::Infected == board[index] ? 1.0 : 0.0) - infectedFraction;
+	}
+
+	transform2D(m_field, m_rowTransform, m_colTransform);
+}
+
+void CorrelationFunction::measure(const SIRSArray &lattice)
+{
+	const int size = m_rowCount * m_colCount;
+
+	transformField(lattice);
+
+	for(int index = 0; index < size; ++index)
+	{
+		m_structureFactorSum[index] += std::norm(m_field[index]) / size;
+	}
+
+	++m_measurementCount;
+}
+
+std::vector<double> CorrelationFunction::structureFactorOf(const SIRSArray &lattice)
+{
+	const int size = m_rowCount * m_colCount;
+
+	transformField(lattice);
+
+	std::vector<double> structureFactor(size);
+	for(int index = 0; index < size; ++index)
+	{
+		structureFactor[index] = std::norm(m_field[index]) / size;
+	}
+
+	return structureFactor;
+}
+
+void CorrelationFunction::add(const std::vector<double> &structureFactor)
+{
+	for(std::size_t index = 0; index < structureFactor.size(); ++index)
+	{
+		m_structureFactorSum[index] += structureFactor[index];
+	}
+
+	++m_measurementCount;
+}
+
+std::vector<std::pair<double, double> > CorrelationFunction::radialAverage(const std::vector<double> &values, double scaleRows, double scaleCols, double binWidth) const
+{
+	std::vector<double> sums;
+	std::vector<int> counts;
+
+	for(int row = 0; row < m_rowCount; ++row)
+	{
+		// Minimum image distance on the periodic lattice.
+		double dr = std::min(row, m_rowCount - row) * scaleRows;
+		for(int col = 0; col < m_colCount; ++col)
+		{
+			double dc = std::min(col, m_colCount - col) * scaleCols;
+			std::size_t bin = static_cast<std::size_t>(std::lround(std::sqrt(dr * dr + dc * dc) / binWidth));
+
+			if(bin >= sums.size())
+			{
+				sums.resize(bin + 1, 0.0);
+				counts.resize(bin + 1, 0);
+			}
+
+			sums[bin] += values[col + row * m_colCount];
+			++counts[bin];
+		}
+	}
+
+	std::vector<std::pair<double, double> > shells;
+	for(std::size_t bin = 0; bin < sums.size(); ++bin)
+	{
+		if(counts[bin] > 0)
+		{
+			shells.push_back(std::make_pair(bin * binWidth, sums[bin] / counts[bin]));
+		}
+	}
+
+	return shells;
+}
+
+std::vector<std::pair<double, double> > CorrelationFunction::structureFactor() const
+{
+	std::vector<double> average(m_structureFactorSum.size(), 0.0);
+	if(m_measurementCount > 0)
+	{
+		for(std::size_t index = 0; index < average.size(); ++index)
+		{
+			average[index] = m_structureFactorSum[index] / m_measurementCount;
+		}
+	}
+
+	// Wave vector components are 2 pi n / L, bins are one smallest wave number wide.
+	const double twoPi = 6.28318530717958647692;
+	return radialAverage(average, twoPi / m_rowCount, twoPi / m_colCount, twoPi / std::max(m_rowCount, m_colCount));
+}
+
+std::vector<std::pair<double, double> > CorrelationFunction::correlation() const
+{
+	// C(r) is the inverse transform of the averaged structure factor.
+	std::vector<std::complex<double> > field(m_structureFactorSum.size());
+	for(std::size_t index = 0; index < field.size(); ++index)
+	{
+		field[index] = m_measurementCount > 0 ? m_structureFactorSum[index] / m_measurementCount : 0.0;
+	}
+
+	FourierTransform rowTransform(m_colCount);
+	FourierTransform colTransform(m_rowCount);
+	transform2D(field, rowTransform, colTransform, true);
+
+	std::vector<double> values(field.size());
+	for(std::size_t index = 0; index < field.size(); ++index)
+	{
+		values[index] = field[index].real();
+	}
+
+	return radialAverage(values, 1.0, 1.0, 1.0);
+}
+
+double CorrelationFunction::correlationLength() const
+{
+	std::vector<std::pair<double, double> > shells = correlation();
+	if(shells.empty() || shells.front().second <= 0)
+	{
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	const double threshold = shells.front().second / std::exp(1.0);
+	for(std::size_t n = 1; n < shells.size(); ++n)
+	{
+		if(shells[n].second < threshold)
+		{
+			// Linear interpolation between this shell and the one before it.
+			double r0 = shells[n-1].first;
+			double c0 = shells[n-1].second;
+			double r1 = shells[n].first;
+			double c1 = shells[n].second;
+			return r0 + (c0 - threshold) * (r1 - r0) / (c0 - c1);
+		}
+	}
+
+	return std::numeric_limits<double>::quiet_NaN();
+}
+
+std::ostream& operator<<(std::ostream &out, const CorrelationFunction &correlations)
+{
+	int outputColumnWidth = 30;
+	out << "Correlations..." << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Correlation-Length: " <<
+	std::right << correlations.correlationLength() << '\n';
+	return out;
+}
@@ -0,0 +1,119 @@
+#ifndef CorrelationFunction_hpp
+#define CorrelationFunction_hpp
+
+#include "SIRSArray.hpp"
+#include "FourierTransform.hpp"
+#include <vector>
+#include <complex>
+#include <iostream>
+#include <utility>
+
+/**
+ *\file
+ *\class CorrelationFunction
+ *\brief Class for measuring the equal-time spatial correlations of the infected field.
+ *
+ * On each measurement the indicator field phi(x) = 1 if x is infected, minus its lattice average, is
+ * Fourier transformed and the structure factor S(k) = |phi(k)|^2 / N is accumulated. At the end the
+ * averaged S(k) is transformed back to give C(r) = (1/N) sum_x phi(x) phi(x+r), so each measurement costs
+ * O(N log N) instead of the O(N^2) of a direct pair sum. Both are binned radially using minimum image
+ * distances on the periodic lattice.
+ *
+ * The structure factor of a lattice can also be worked out on one instance and added to the sum
+ * held by another, so several threads can transform lattices while one keeps the totals.
+ */
+class CorrelationFunction
+{
+private:
+	/// Member variable for the number of rows of the lattice being measured.
+	int m_rowCount;
+
+	/// Member variable for the number of columns of the lattice being measured.
+	int m_colCount;
+
+	/// Member variable for the transform along each row.
+	FourierTransform m_rowTransform;
+
+	/// Member variable for the transform along each column.
+	FourierTransform m_colTransform;
+
+	/// Member variable holding the field while it is transformed.
+	std::vector<std::complex<double> > m_field;
+
+	/// Member variable holding the structure factor summed over the measurements.
+	std::vector<double> m_structureFactorSum;
+
+	/// Member variable counting the measurements.
+	int m_measurementCount;
+
+	/**
+	 *\brief Fills the field with the mean-subtracted infected indicator of the lattice and transforms it.
+	 *\param lattice constant SIRSArray reference, must have the size given to the constructor.
+	 */
+	void transformField(const SIRSArray &lattice);
+
+	/**
+	 *\brief Averages values over shells of equal rounded distance from the origin.
+	 *\param values vector of rows*cols values indexed like the lattice.
+	 *\param scaleRows floating point value multiplying the row distance.
+	 *\param scaleCols floating point value multiplying the column distance.
+	 *\param binWidth floating point value representing the width of each shell.
+	 *\return vector of (shell centre, mean value) pairs for every non-empty shell.
+	 */
+	std::vector<std::pair<double, double> > radialAverage(const std::vector<double> &values, double scaleRows, double scaleCols, double binWidth) const;
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param rows integer value representing the number of rows of the lattice that will be measured.
+	 *\param cols integer value representing the number of columns of the lattice that will be measured.
+	 */
+	CorrelationFunction(int rows, int cols);
+
+	/**
+	 *\brief Adds the structure factor of the current lattice to the running sum.
+	 *\param lattice constant SIRSArray reference to measure, must have the size given to the constructor.
+	 */
+	void measure(const SIRSArray &lattice);
+
+	/**
+	 *\brief Calculates the structure factor of a lattice without adding it to the running sum.
+	 *\param lattice constant SIRSArray reference, must have the size given to the constructor.
+	 *\return vector of S(k) indexed like the lattice.
+	 */
+	std::vector<double> structureFactorOf(const SIRSArray &lattice);
+
+	/**
+	 *\brief Adds a structure factor to the running sum.
+	 *\param structureFactor constant vector reference from structureFactorOf on any instance of the same size.
+	 */
+	void add(const std::vector<double> &structureFactor);
+
+	/**
+	 *\brief Radially binned structure factor averaged over the measurements.
+	 *\return vector of (|k|, S(k)) pairs, |k| in units of inverse lattice spacing.
+	 */
+	std::vector<std::pair<double, double> > structureFactor() const;
+
+	/**
+	 *\brief Radially binned correlation function averaged over the measurements.
+	 *\return vector of (r, C(r)) pairs with r in lattice spacings.
+	 */
+	std::vector<std::pair<double, double> > correlation() const;
+
+	/**
+	 *\brief Calculates the distance at which the radial correlation function first falls below C(0)/e.
+	 *\return Floating point value found by linear interpolation between shells, NaN if it never falls that far.
+	 */
+	double correlationLength() const;
+
+	/**
+	 *\brief operator<< overload for outputting the correlation length.
+	 *\param out std::ostream reference that is being streamed to.
+	 *\param correlations constant CorrelationFunction reference to be output.
+	 *\return std::ostream reference so the operator can be chained.
+	 */
+	friend std::ostream& operator<<(std::ostream &out, const CorrelationFunction &correlations);
+};
+
+#endif /* CorrelationFunction_hpp */
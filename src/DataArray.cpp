@@ -1,8 +1,9 @@
 #include "DataArray.hpp"
+#include <algorithm>
 
 DataArray::DataArray():m_size{0}{}
 
-DataArray::DataArray(int size):m_size{size}
+DataArray::DataArray(int size):m_size{0}
 {
     m_data.reserve(size);
 }
@@ -29,6 +30,12 @@ void DataArray::pop_back()
     m_size--;
 }
 
+void DataArray::clear()
+{
+    m_data.clear();
+    m_size = 0;
+}
+
 void DataArray::reserve(int size)
 {
     m_data.reserve(size);
@@ -81,6 +88,88 @@ double DataArray::error() const
       return std::sqrt(variance() / (m_size - 1));
 }
 
+DataArray::BlockingAnalysis DataArray::blocking() const
+{
+    if(m_size < 4)
+    {
+        return BlockingAnalysis{error(), static_cast<double>(m_size), 0};
+    }
+
+    // Variance, lag one autocovariance and length of the series at each blocking level.
+    std::vector<double> variances;
+    std::vector<double> autoCovariances;
+    std::vector<int> sizes;
+
+    std::vector<double> blocks(m_data);
+    while(blocks.size() >= 2)
+    {
+        const int n = blocks.size();
+
+        double mean = 0;
+        for(const auto &block : blocks)
+        {
+            mean += block;
+        }
+        mean /= n;
+
+        double variance = 0;
+        double autoCovariance = 0;
+        for(int i = 0; i < n; ++i)
+        {
+            variance += (blocks[i] - mean) * (blocks[i] - mean);
+            if(i + 1 < n)
+            {
+                autoCovariance += (blocks[i] - mean) * (blocks[i+1] - mean);
+            }
+        }
+
+        variances.push_back(variance / n);
+        autoCovariances.push_back(autoCovariance / n);
+        sizes.push_back(n);
+
+        // Average neighbouring pairs, an odd sample at the end is dropped.
+        for(int i = 0; i < n / 2; ++i)
+        {
+            blocks[i] = 0.5 * (blocks[2*i] + blocks[2*i+1]);
+        }
+        blocks.resize(n / 2);
+    }
+
+    const int levels = variances.size();
+
+    // M_k = sum_{j>=k} n_j (gamma_j / s_j)^2 is chi squared distributed with levels - k degrees of
+    // freedom once the blocks are uncorrelated. The 99% quantile uses the Wilson-Hilferty approximation.
+    int plateau = levels - 1;
+    double statistic = 0;
+    std::vector<double> statistics(levels);
+    for(int k = levels - 1; k >= 0; --k)
+    {
+        if(variances[k] > 0)
+        {
+            statistic += sizes[k] * (autoCovariances[k] / variances[k]) * (autoCovariances[k] / variances[k]);
+        }
+        statistics[k] = statistic;
+    }
+
+    for(int k = 0; k < levels; ++k)
+    {
+        double degreesOfFreedom = levels - k;
+        double spread = std::sqrt(2.0 / (9.0 * degreesOfFreedom));
+        double quantile = degreesOfFreedom * std::pow(1.0 - 2.0 / (9.0 * degreesOfFreedom) + 2.3263478740 * spread, 3);
+        if(statistics[k] < quantile)
+        {
+            plateau = k;
+            break;
+        }
+    }
+
+    // Use the same normalisation as error() so uncorrelated data gives the same answer.
+    double blockedError = (sizes[plateau] > 1) ? std::sqrt(variances[plateau] / (sizes[plateau] - 1)) : error();
+    double effectiveSampleSize = (blockedError > 0) ? std::min<double>(m_size, variances[0] / (blockedError * blockedError)) : m_size;
+
+    return BlockingAnalysis{blockedError, effectiveSampleSize, plateau};
+}
+
 
 
 
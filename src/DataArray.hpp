@@ -51,6 +51,21 @@ public:
 			virtual double operator()(const DataArray &data) const = 0;
 	};
 
+	/**
+	 *\class BlockingAnalysis
+	 *\brief Class holding the outcome of a blocking analysis of the error in the mean.
+	 */
+	class BlockingAnalysis
+	{
+		public:
+			/// Error in the mean at the level where the blocked errors reach their plateau.
+			double error;
+			/// Number of independent samples the series is worth, variance / error^2.
+			double effectiveSampleSize;
+			/// Number of times the series was halved to reach the plateau.
+			int level;
+	};
+
 	/**
 	 *\brief Default constructor.
 	 */
@@ -99,6 +114,11 @@ public:
      */
     void pop_back();
 
+    /**
+     *\brief Removes every sample but keeps the memory, so refilling the DataArray allocates nothing.
+     */
+    void clear();
+
     /**
      *\brief Reserves memory for DataArray making it faster.
      *\param size integer value representing the number of elements to reserve space for.
@@ -144,6 +164,19 @@ public:
      */
     double error() const;
 
+    /**
+     *\brief Method to calculate the error of the mean of correlated data by blocking.
+     *\return BlockingAnalysis instance holding the corrected error and the effective sample size.
+     *
+     * Flyvbjerg-Petersen blocking: the series is repeatedly replaced by the averages of neighbouring
+     * pairs, which leaves the error of the mean unchanged but makes the blocks less correlated, so
+     * the naive error grows until it reaches a plateau at the true error. The halving costs O(N)
+     * in total. The plateau is detected automatically with the test of Jonsson (Phys. Rev. E 98,
+     * 043304, 2018), which stops at the first level from which the remaining lag-one
+     * autocorrelations are consistent with zero at the 99% level.
+     */
+    BlockingAnalysis blocking() const;
+
     /**
      *\brief operator<< overload to output the data array to a stream.
      *\param out std::ostream reference that is the stream being output to.
@@ -0,0 +1,335 @@
+#include "DeterministicSolver.hpp"
+#include "Neighbourhood.hpp"
+#include "SIRSNetwork.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	/// State each state moves to when it makes a transition, immune cells never move.
+	const int successorState[SIRSArray::MAXSTATE] =
+	{
+		SIRSArray::Infected,
+		SIRSArray::Recovered,
+		SIRSArray::Susceptible,
+		-1,
+	};
+
+	/// Infected fractions below this count as the infection having died out.
+	const double extinctFraction = 1e-12;
+}
+
+DeterministicSolver::DeterministicSolver(
+	Closure closure,
+	double timeStep,
+	double maxTime,
+	double tolerance
+	) : m_closure{closure},
+		m_timeStep{timeStep},
+		m_maxTime{maxTime},
+		m_tolerance{tolerance}
+{
+
+}
+
+bool DeterministicSolver::parseEngine(const std::string &engine, Closure &closure)
+{
+	if("mean-field" == engine)
+	{
+		closure = MeanField;
+		return true;
+	}
+
+	if("pair" == engine)
+	{
+		closure = PairApproximation;
+		return true;
+	}
+
+	return false;
+}
+
+int DeterministicSolver::coordinationNumber(const SIRSInputParameters &parameters)
+{
+	if("lattice" != parameters.topology)
+	{
+		return parameters.meanDegree;
+	}
+
+	if(2 != parameters.dimensions)
+	{
+		return 2 * parameters.dimensions;
+	}
+
+	const int radius = parameters.radius;
+	switch(parseNeighbourhood(parameters.neighbourhood))
+	{
+		case VonNeumannNeighbourhood : return 2 * radius * (radius + 1);
+		case MooreNeighbourhood		 : return (2 * radius + 1) * (2 * radius + 1) - 1;
+		default						 : return 0;
+	}
+}
+
+int DeterministicSolver::populationSize(const SIRSInputParameters &parameters)
+{
+	if("edge-list" == parameters.topology)
+	{
+		return SIRSNetwork::loadEdgeList(parameters.edgeListFile).getSize();
+	}
+
+	if("lattice" != parameters.topology)
+	{
+		return parameters.nodeCount;
+	}
+
+	// The same axes Simulation builds, a 2D lattice keeps its sizes in the rows and columns.
+	std::vector<int> sizes = parameters.axisSizes;
+	if(2 == parameters.dimensions && sizes.empty())
+	{
+		sizes = {parameters.rowCount, parameters.colCount};
+	}
+	else if(sizes.empty())
+	{
+		sizes.assign(std::max(0, parameters.dimensions), parameters.rowCount);
+	}
+
+	std::uint64_t size = 1;
+	for(int axisSize : sizes)
+	{
+		size *= static_cast<std::uint64_t>(std::max(0, axisSize));
+		if(size > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+		{
+			throw std::invalid_argument("The lattice has more cells than can be indexed, at most " +
+				std::to_string(std::numeric_limits<int>::max()) + " are allowed");
+		}
+	}
+
+	return static_cast<int>(size);
+}
+
+void DeterministicSolver::integrate(
+	std::vector<double> &state,
+	const std::function<void(const std::vector<double>&, std::vector<double>&)> &derivative,
+	const std::function<double(const std::vector<double>&)> &infected) const
+{
+	const std::size_t size = state.size();
+	std::vector<double> k1(size), k2(size), k3(size), k4(size), trial(size);
+
+	for(double time = 0; time < m_maxTime; time += m_timeStep)
+	{
+		derivative(state, k1);
+		for(std::size_t n = 0; n < size; ++n) trial[n] = state[n] + 0.5 * m_timeStep * k1[n];
+		derivative(trial, k2);
+		for(std::size_t n = 0; n < size; ++n) trial[n] = state[n] + 0.5 * m_timeStep * k2[n];
+		derivative(trial, k3);
+		for(std::size_t n = 0; n < size; ++n) trial[n] = state[n] + m_timeStep * k3[n];
+		derivative(trial, k4);
+
+		double largestRate = 0;
+		for(std::size_t n = 0; n < size; ++n)
+		{
+			double rate = (k1[n] + 2 * k2[n] + 2 * k3[n] + k4[n]) / 6;
+			state[n] = std::max(0.0, state[n] + m_timeStep * rate);
+			largestRate = std::max(largestRate, std::abs(rate));
+		}
+
+		if(largestRate < m_tolerance || infected(state) < extinctFraction)
+		{
+			return;
+		}
+	}
+}
+
+SIRSResults DeterministicSolver::solve(const SIRSInputParameters &parameters) const
+{
+	if(!parameters.regionMapFile.empty())
+	{
+		throw std::invalid_argument("The deterministic solvers do not support region maps");
+	}
+
+	const int z = coordinationNumber(parameters);
+	if(z <= 0)
+	{
+		throw std::invalid_argument("Unsupported neighbourhood: " + parameters.neighbourhood);
+	}
+
+	if("per-contact" == parameters.infection && MeanField != m_closure)
+	{
+		throw std::invalid_argument("Only the mean-field solver supports per-contact infection");
+	}
+
+	const double p1 = parameters.probSI;
+	const double p2 = parameters.probIR;
+	const double p3 = parameters.probRS;
+	const double immune = parameters.immuneFraction;
+	const double mobile = 1.0 - immune;
+
+	// Probability a susceptible cell is infected in an update and its slope in the infected fraction, a
+	// cell with any infected neighbour is infected with probability p1, or every infected neighbour is a
+	// separate chance of p1.
+	const bool perContact = ("per-contact" == parameters.infection);
+	auto infectionProbability = [=](double infected)
+	{
+		return perContact ? 1.0 - std::pow(1.0 - p1 * infected, z) : p1 * (1.0 - std::pow(1.0 - infected, z));
+	};
+	auto infectionSlope = [=](double infected)
+	{
+		return perContact ? p1 * z * std::pow(1.0 - p1 * infected, z - 1) : p1 * z * std::pow(1.0 - infected, z - 1);
+	};
+
+	// Start from the even mix of susceptible, infected and recovered cells a simulation starts from.
+	double s = mobile / 3;
+	double i = mobile / 3;
+	double r = mobile / 3;
+
+	if(MeanField == m_closure)
+	{
+		std::vector<double> state{s, i, r};
+		integrate(state, [=](const std::vector<double> &y, std::vector<double> &dy)
+		{
+			double infection = y[0] * infectionProbability(y[1]);
+			dy[0] = -infection + p3 * y[2];
+			dy[1] =  infection - p2 * y[1];
+			dy[2] =  p2 * y[1] - p3 * y[2];
+		}, [](const std::vector<double> &y)
+		{
+			return y[1];
+		});
+
+		s = state[0];
+		i = (state[1] < extinctFraction) ? 0.0 : state[1];
+		r = mobile - s - i;
+	}
+	else
+	{
+		// Ordered pairs [XY] of neighbouring states, stored at X * MAXSTATE + Y and uncorrelated to begin with.
+		const int states = SIRSArray::MAXSTATE;
+		double single[states] = {s, i, r, immune};
+		std::vector<double> pairs(states * states);
+		for(int x = 0; x < states; ++x)
+		{
+			for(int y = 0; y < states; ++y)
+			{
+				pairs[x * states + y] = single[x] * single[y];
+			}
+		}
+
+		auto singleFraction = [states](const std::vector<double> &p, int x)
+		{
+			double sum = 0;
+			for(int y = 0; y < states; ++y)
+			{
+				sum += p[x * states + y];
+			}
+			return sum;
+		};
+
+		integrate(pairs, [=](const std::vector<double> &p, std::vector<double> &dp)
+		{
+			// Chance one of the other z - 1 neighbours of a susceptible cell is infected, given the state of its partner.
+			double susceptible = singleFraction(p, SIRSArray::Susceptible);
+			double infectedGivenSusceptible = (susceptible > 0) ? p[SIRSArray::Susceptible * states + SIRSArray::Infected] / susceptible : 0.0;
+			double otherInfected = 1.0 - std::pow(1.0 - infectedGivenSusceptible, z - 1);
+
+			// Rate at which a cell in state x moves on when its partner is in state y.
+			auto rate = [&](int x, int y) -> double
+			{
+				switch(x)
+				{
+					case SIRSArray::Susceptible : return p1 * ((SIRSArray::Infected == y) ? 1.0 : otherInfected);
+					case SIRSArray::Infected	: return p2;
+					case SIRSArray::Recovered	: return p3;
+					default						: return 0.0;
+				}
+			};
+
+			std::fill(dp.begin(), dp.end(), 0.0);
+			for(int x = 0; x < states; ++x)
+			{
+				for(int y = 0; y < states; ++y)
+				{
+					// Either cell of the pair can move on, taking the probability of the pair with it.
+					double first  = p[x * states + y] * rate(x, y);
+					double second = p[x * states + y] * rate(y, x);
+					dp[x * states + y] -= first + second;
+					if(successorState[x] >= 0)
+					{
+						dp[successorState[x] * states + y] += first;
+					}
+					if(successorState[y] >= 0)
+					{
+						dp[x * states + successorState[y]] += second;
+					}
+				}
+			}
+		}, [=](const std::vector<double> &p)
+		{
+			return singleFraction(p, SIRSArray::Infected);
+		});
+
+		s = singleFraction(pairs, SIRSArray::Susceptible);
+		i = singleFraction(pairs, SIRSArray::Infected);
+		i = (i < extinctFraction) ? 0.0 : i;
+		r = mobile - s - i;
+	}
+
+	double susceptibility = 0;
+	if(MeanField == m_closure && i > 0)
+	{
+		// Linear noise approximation in (s,i) with r = mobile - s - i. The drift has Jacobian A and each
+		// transition adds its rate times the outer product of its jump to the noise matrix B, the
+		// covariance C then solves A C + C A^T + B = 0.
+		double infection = infectionProbability(i);
+		double slope = infectionSlope(i);
+
+		double a11 = -infection - p3;
+		double a12 = -s * slope - p3;
+		double a21 =  infection;
+		double a22 =  s * slope - p2;
+
+		double b11 = s * infection + p3 * r;
+		double b12 = -s * infection;
+		double b22 = s * infection + p2 * i;
+
+		// The three equations for (Css, Csi, Cii), solved by Cramer's rule.
+		double m[3][3] = {{2 * a11, 2 * a12, 0}, {a21, a11 + a22, a12}, {0, 2 * a21, 2 * a22}};
+		double v[3] = {-b11, -b12, -b22};
+
+		auto determinant = [](double d[3][3])
+		{
+			return d[0][0] * (d[1][1] * d[2][2] - d[1][2] * d[2][1]) -
+				   d[0][1] * (d[1][0] * d[2][2] - d[1][2] * d[2][0]) +
+				   d[0][2] * (d[1][0] * d[2][1] - d[1][1] * d[2][0]);
+		};
+
+		double d = determinant(m);
+		if(d != 0)
+		{
+			double mi[3][3];
+			std::copy(&m[0][0], &m[0][0] + 9, &mi[0][0]);
+			for(int row = 0; row < 3; ++row)
+			{
+				mi[row][2] = v[row];
+			}
+			susceptibility = determinant(mi) / d;
+		}
+	}
+
+	return SIRSResults
+	{
+		i,
+		0.0,
+		susceptibility,
+		0.0,
+		0.0,
+		0,
+		0.0,
+		0.0,
+		// The rate equations have no cells, report the lattice or network they stand in for.
+		populationSize(parameters),
+	};
+}
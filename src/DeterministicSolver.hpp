@@ -0,0 +1,116 @@
+#ifndef DeterministicSolver_hpp
+#define DeterministicSolver_hpp
+
+#include "SIRSArray.hpp"
+#include "SIRSInputParameters.hpp"
+#include "SIRSResults.hpp"
+#include <vector>
+#include <string>
+#include <functional>
+
+/**
+ *\file
+ *\class DeterministicSolver
+ *\brief Class that predicts the steady state of the SIRS model by integrating approximate rate equations.
+ *
+ * One sweep gives every cell one update on average, so in the limit of a large lattice the fraction
+ * of cells in each state obeys rate equations with time measured in sweeps: a susceptible cell with
+ * at least one infected neighbour becomes infected at rate p1, and infected and recovered cells move
+ * on at rates p2 and p3. Immune cells never change. Two closures for the chance that a susceptible
+ * cell has an infected neighbour are provided.
+ *
+ * The mean-field closure treats the z neighbours as independent of the cell and of each other, so
+ * the chance is 1 - (1 - i)^z. The pair approximation follows the probability of every ordered pair
+ * of neighbouring states and treats the neighbours as independent given the state of the centre
+ * cell, so the chance is 1 - (1 - [SI]/[S])^z. It keeps the clustering of infected cells that the
+ * mean field misses and moves the absorbing boundary much closer to where simulations find it.
+ *
+ * The equations are integrated with fourth order Runge-Kutta from the initial conditions of a
+ * simulation until they stop changing, which takes well under a millisecond away from the boundary.
+ * Results come back as SIRSResults so a solver can stand in for a simulation in AdaptiveScan.
+ */
+class DeterministicSolver
+{
+public:
+	/**
+	 * \enum Closure
+	 * \brief Enumeration of the approximations for the infected neighbours of a cell.
+	 */
+	enum Closure
+	{
+		MeanField,
+		PairApproximation,
+	};
+
+private:
+	/// Member variable for the approximation used.
+	Closure m_closure;
+
+	/// Member variable for the time step in sweeps.
+	double m_timeStep;
+
+	/// Member variable for the longest time in sweeps to integrate for.
+	double m_maxTime;
+
+	/// Member variable for the rate of change below which the fractions count as steady.
+	double m_tolerance;
+
+	/**
+	 *\brief Integrates a set of rate equations with fourth order Runge-Kutta until they are steady.
+	 *\param state vector of the variables, replaced by their steady values.
+	 *\param derivative function filling in the rate of change of every variable.
+	 *\param infected function returning the infected fraction from the variables.
+	 */
+	void integrate(std::vector<double> &state,
+		const std::function<void(const std::vector<double>&, std::vector<double>&)> &derivative,
+		const std::function<double(const std::vector<double>&)> &infected) const;
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param closure Closure used for the infected neighbours.
+	 *\param timeStep floating point value representing the Runge-Kutta step in sweeps.
+	 *\param maxTime floating point value representing the longest time in sweeps to integrate for.
+	 *\param tolerance floating point value representing the rate of change at which the fractions are steady.
+	 */
+	DeterministicSolver(Closure closure, double timeStep = 0.1, double maxTime = 20000, double tolerance = 1e-10);
+
+	/**
+	 *\brief Converts the name of an engine into a closure.
+	 *\param engine string holding the engine, mean-field or pair.
+	 *\param closure Closure reference set to the closure if the engine is a solver.
+	 *\return Boolean value representing whether the engine is a deterministic solver.
+	 */
+	static bool parseEngine(const std::string &engine, Closure &closure);
+
+	/**
+	 *\brief Calculates the number of neighbours of each cell for a set of parameters.
+	 *\param parameters SIRSInputParameters reference describing the geometry.
+	 *\return Integer value representing the coordination number, the mean degree on a network.
+	 */
+	static int coordinationNumber(const SIRSInputParameters &parameters);
+
+	/**
+	 *\brief Calculates the number of cells the rate equations stand in for, as Simulation counts them.
+	 *\param parameters SIRSInputParameters reference describing the geometry.
+	 *\return Integer value representing the number of nodes of a network, otherwise the product of the axis sizes.
+	 *
+	 * An edge-list network is read to count its nodes. Throws std::invalid_argument if it cannot be read
+	 * or the lattice has more cells than an int can hold.
+	 */
+	static int populationSize(const SIRSInputParameters &parameters);
+
+	/**
+	 *\brief Solves for the steady state.
+	 *\param parameters SIRSInputParameters reference, the probabilities, immune fraction and geometry are used.
+	 *\return SIRSResults instance with the infected fraction as the order parameter and no statistical errors.
+	 *
+	 * The susceptibility is the variance of the number of infected cells per cell predicted by the linear
+	 * noise approximation of the mean field about its steady state, which grows without bound at the
+	 * mean-field boundary. The pair approximation has no equivalent and reports 0. Throws
+	 * std::invalid_argument for parameters a solver cannot describe, such as a region map.
+	 */
+	SIRSResults solve(const SIRSInputParameters &parameters) const;
+};
+
+#endif /* DeterministicSolver_hpp */
@@ -0,0 +1,185 @@
+#include "EngineComparison.hpp"
+#include "Simulation.hpp"
+#include "significanceTests.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+
+namespace
+{
+	/**
+	 *\brief Calculates the mean of some values.
+	 *\param values constant vector reference.
+	 *\return Floating point value representing the mean, 0 if there are no values.
+	 */
+	double average(const std::vector<double> &values)
+	{
+		double sum = 0;
+		for(double value : values)
+		{
+			sum += value;
+		}
+
+		return values.empty() ? 0.0 : sum / values.size();
+	}
+}
+
+EngineComparison::EngineComparison(
+	const SIRSInputParameters &baseParameters,
+	int runCount,
+	double significance
+	) : m_baseParameters(baseParameters),
+		m_runCount{std::max(2, runCount)},
+		m_significance{significance}
+{
+
+}
+
+std::vector<EngineComparison::Point> EngineComparison::standardMatrix()
+{
+	const double probabilities[][4] =
+	{
+		{1.0, 1.0, 1.0, 0.0},
+		{0.8, 0.1, 0.01, 0.0},
+		{0.5, 0.5, 0.5, 0.0},
+		{1.0, 1.0, 1.0, 0.25},
+		{0.6, 0.2, 0.05, 0.1},
+	};
+
+	std::vector<Point> points;
+	for(int size : {32, 64})
+	{
+		for(const auto &point : probabilities)
+		{
+			points.push_back(Point{point[0], point[1], point[2], point[3], size});
+		}
+	}
+
+	return points;
+}
+
+EngineComparison::Sample EngineComparison::sample(const SIRSInputParameters &parameters, int firstReplica) const
+{
+	Sample sample{std::vector<double>(), std::vector<double>(), 0, 0.0};
+
+	Timer timer;
+	long long updates = 0;
+	for(int run = 0; run < m_runCount; ++run)
+	{
+		Simulation simulation(parameters, firstReplica + run);
+		SIRSResults results = simulation.run();
+
+		sample.orderParameters.push_back(results.orderParameter);
+		sample.susceptibilities.push_back(results.susceptibility);
+
+		const SIRSArray::StateVector &cells = simulation.getStateData();
+		if(cells.end() == std::find(cells.begin(), cells.end(), SIRSArray::Infected))
+		{
+			++sample.extinctCount;
+		}
+
+		updates += static_cast<long long>(parameters.burnPeriod + parameters.sweeps) * cells.size();
+	}
+
+	double elapsed = timer.elapsed();
+	sample.updatesPerSecond = (elapsed > 0) ? updates / elapsed : 0.0;
+
+	return sample;
+}
+
+std::vector<EngineComparison::Comparison> EngineComparison::compare(const std::vector<Point> &points) const
+{
+	const double pThreshold = threshold(points.size());
+
+	std::vector<Comparison> comparisons;
+	for(const auto &point : points)
+	{
+		SIRSInputParameters parameters = m_baseParameters;
+		parameters.probSI = point.probSI;
+		parameters.probIR = point.probIR;
+		parameters.probRS = point.probRS;
+		parameters.immuneFraction = point.immuneFraction;
+		parameters.rowCount = point.size;
+		parameters.colCount = point.size;
+
+		SIRSInputParameters referenceParameters = parameters;
+		referenceParameters.engine = "exact";
+
+		// The candidate's runs follow the reference's so the two samples are independent.
+		Comparison comparison;
+		comparison.point     = point;
+		comparison.reference = sample(referenceParameters, 0);
+		comparison.candidate = sample(parameters, m_runCount);
+
+		comparison.orderPValue          = welchTest(comparison.reference.orderParameters, comparison.candidate.orderParameters);
+		comparison.susceptibilityPValue = welchTest(comparison.reference.susceptibilities, comparison.candidate.susceptibilities);
+		comparison.extinctionPValue     = fisherExactTest(comparison.reference.extinctCount, m_runCount, comparison.candidate.extinctCount, m_runCount);
+
+		comparison.passed = comparison.orderPValue >= pThreshold &&
+			comparison.susceptibilityPValue >= pThreshold &&
+			comparison.extinctionPValue >= pThreshold;
+
+		comparisons.push_back(comparison);
+	}
+
+	return comparisons;
+}
+
+double EngineComparison::threshold(int pointCount) const
+{
+	// Three tests at every point.
+	return m_significance / std::max(1, 3 * pointCount);
+}
+
+void EngineComparison::writeComparisons(std::ostream &out, const std::vector<Comparison> &comparisons)
+{
+	out << "# size p1 p2 p3 immune order(exact) order(candidate) p(order) susceptibility(exact) susceptibility(candidate) p(susceptibility) " <<
+	"extinct(exact) extinct(candidate) p(extinct) updates/s(exact) updates/s(candidate) passed" << '\n';
+
+	for(const auto &comparison : comparisons)
+	{
+		const Point &point = comparison.point;
+		out << point.size << ' ' << point.probSI << ' ' << point.probIR << ' ' << point.probRS << ' ' << point.immuneFraction << ' ' <<
+		average(comparison.reference.orderParameters) << ' ' << average(comparison.candidate.orderParameters) << ' ' << comparison.orderPValue << ' ' <<
+		average(comparison.reference.susceptibilities) << ' ' << average(comparison.candidate.susceptibilities) << ' ' << comparison.susceptibilityPValue << ' ' <<
+		comparison.reference.extinctCount << ' ' << comparison.candidate.extinctCount << ' ' << comparison.extinctionPValue << ' ' <<
+		comparison.reference.updatesPerSecond << ' ' << comparison.candidate.updatesPerSecond << ' ' << comparison.passed << '\n';
+	}
+}
+
+void EngineComparison::writeSummary(std::ostream &out, const std::vector<Comparison> &comparisons) const
+{
+	int failures = 0;
+	double smallestPValue = 1.0;
+	double referenceRate = 0;
+	double candidateRate = 0;
+	for(const auto &comparison : comparisons)
+	{
+		failures += comparison.passed ? 0 : 1;
+		smallestPValue = std::min({smallestPValue, comparison.orderPValue, comparison.susceptibilityPValue, comparison.extinctionPValue});
+		referenceRate += comparison.reference.updatesPerSecond;
+		candidateRate += comparison.candidate.updatesPerSecond;
+	}
+
+	int outputColumnWidth = 30;
+	out << "Equivalence..." << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Candidate-Engine: " <<
+	std::right << m_baseParameters.engine << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Runs-Per-Point: " <<
+	std::right << m_runCount << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Points: " <<
+	std::right << comparisons.size() << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Threshold-P-Value: " <<
+	std::right << threshold(comparisons.size()) << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Smallest-P-Value: " <<
+	std::right << smallestPValue << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Failures: " <<
+	std::right << failures << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Exact-Updates/s: " <<
+	std::right << (comparisons.empty() ? 0.0 : referenceRate / comparisons.size()) << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Candidate-Updates/s: " <<
+	std::right << (comparisons.empty() ? 0.0 : candidateRate / comparisons.size()) << '\n';
+	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Speed-Up: " <<
+	std::right << (referenceRate > 0 ? candidateRate / referenceRate : 0.0) << '\n';
+}
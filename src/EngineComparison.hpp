@@ -0,0 +1,161 @@
+#ifndef EngineComparison_hpp
+#define EngineComparison_hpp
+
+#include "SIRSInputParameters.hpp"
+#include <vector>
+#include <string>
+#include <iostream>
+
+/**
+ *\file
+ *\class EngineComparison
+ *\brief Class that tests whether a candidate engine samples the same dynamics as the exact engine.
+ *
+ * At every point of a matrix of probabilities, immune fractions and lattice sizes both engines make
+ * the same number of independent runs, each a Simulation with a replica index of its own so no two
+ * runs share random numbers. Per run order parameters and susceptibilities are compared with
+ * Welch's t-test, which needs no assumption about their autocorrelation because each run gives a
+ * single value, and the fraction of runs in which the infection died out with Fisher's exact test.
+ * A point fails if any of its p-values is below the significance divided by the total number of
+ * tests, so the chance of a false failure over the whole matrix is at most the significance.
+ *
+ * The time each engine spends on its runs is recorded as well, so the speed of a candidate can be
+ * read off next to the evidence that it is correct.
+ */
+class EngineComparison
+{
+public:
+	/**
+	 *\struct Point
+	 *\brief Struct describing one point of the matrix.
+	 */
+	struct Point
+	{
+		/// Probability of a susceptible cell being infected by an infected neighbour.
+		double probSI;
+
+		/// Probability of an infected cell recovering.
+		double probIR;
+
+		/// Probability of a recovered cell becoming susceptible.
+		double probRS;
+
+		/// Fraction of cells that are immune.
+		double immuneFraction;
+
+		/// Number of rows and columns of the lattice.
+		int size;
+	};
+
+	/**
+	 *\struct Sample
+	 *\brief Struct holding the runs of one engine at one point.
+	 */
+	struct Sample
+	{
+		/// Order parameter of each run.
+		std::vector<double> orderParameters;
+
+		/// Susceptibility of each run.
+		std::vector<double> susceptibilities;
+
+		/// Number of runs that ended with no infected cells.
+		int extinctCount;
+
+		/// Cell updates per second over all of the runs, burn in included.
+		double updatesPerSecond;
+	};
+
+	/**
+	 *\struct Comparison
+	 *\brief Struct holding both samples at a point and the tests between them.
+	 */
+	struct Comparison
+	{
+		/// Point the engines were compared at.
+		Point point;
+
+		/// Runs of the exact engine.
+		Sample reference;
+
+		/// Runs of the candidate engine.
+		Sample candidate;
+
+		/// p-value of Welch's t-test on the order parameters.
+		double orderPValue;
+
+		/// p-value of Welch's t-test on the susceptibilities.
+		double susceptibilityPValue;
+
+		/// p-value of Fisher's exact test on the extinctions.
+		double extinctionPValue;
+
+		/// Whether every p-value is above the corrected threshold.
+		bool passed;
+	};
+
+private:
+	/// Member variable holding the parameters every run starts from.
+	SIRSInputParameters m_baseParameters;
+
+	/// Member variable for the number of runs of each engine at each point.
+	int m_runCount;
+
+	/// Member variable for the chance of any false failure over the whole matrix.
+	double m_significance;
+
+	/**
+	 *\brief Makes the runs of one engine at one point.
+	 *\param parameters SIRSInputParameters reference for the runs, engine included.
+	 *\param firstReplica replica index of the first run, the others follow it.
+	 *\return Sample of the runs.
+	 */
+	Sample sample(const SIRSInputParameters &parameters, int firstReplica) const;
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param baseParameters SIRSInputParameters reference, its engine is the candidate and its probabilities, immune fraction and size are replaced at each point.
+	 *\param runCount integer value representing the number of runs of each engine at each point, at least 2.
+	 *\param significance floating point value representing the chance of any false failure over the whole matrix.
+	 */
+	EngineComparison(const SIRSInputParameters &baseParameters, int runCount = 8, double significance = 0.01);
+
+	/**
+	 *\brief The fixed matrix, an endemic, an oscillating and a near threshold point and two with immunity, each on two lattice sizes.
+	 *\return vector of Points.
+	 */
+	static std::vector<Point> standardMatrix();
+
+	/**
+	 *\brief Runs both engines at every point and tests them against each other.
+	 *\param points constant vector of Points to compare at.
+	 *\return vector of Comparisons in the order of the points.
+	 *
+	 * Throws std::invalid_argument if the candidate cannot simulate the base parameters.
+	 */
+	std::vector<Comparison> compare(const std::vector<Point> &points) const;
+
+	/**
+	 *\brief Calculates the p-value below which a test fails.
+	 *\param pointCount integer value representing the number of points compared.
+	 *\return Floating point value representing the significance divided by the number of tests.
+	 */
+	double threshold(int pointCount) const;
+
+	/**
+	 *\brief Outputs a line per point with both engines' averages, the p-values, throughputs and verdict.
+	 *\param out std::ostream reference that is being streamed to.
+	 *\param comparisons constant vector of Comparisons to output.
+	 */
+	static void writeComparisons(std::ostream &out, const std::vector<Comparison> &comparisons);
+
+	/**
+	 *\brief Outputs a summary of the comparisons in the same style as SIRSResults.
+	 *\param out std::ostream reference that is being streamed to.
+	 *\param comparisons constant vector of Comparisons to summarise.
+	 */
+	void writeSummary(std::ostream &out, const std::vector<Comparison> &comparisons) const;
+};
+
+#endif /* EngineComparison_hpp */
@@ -0,0 +1,164 @@
+#include "FourierTransform.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	const double pi = 3.14159265358979323846;
+
+	bool isPowerOfTwo(int n)
+	{
+		return n > 0 && 0 == (n & (n - 1));
+	}
+}
+
+FourierTransform::FourierTransform(int size) : m_size{size}, m_paddedSize{1}
+{
+	// Bluestein needs a circular convolution of length at least 2n - 1.
+	int minimumSize = isPowerOfTwo(size) ? size : 2 * size - 1;
+	while(m_paddedSize < minimumSize)
+	{
+		m_paddedSize *= 2;
+	}
+
+	m_twiddles.reserve(m_paddedSize / 2);
+	for(int k = 0; k < m_paddedSize / 2; ++k)
+	{
+		m_twiddles.push_back(std::polar(1.0, -2.0 * pi * k / m_paddedSize));
+	}
+
+	if(isPowerOfTwo(size))
+	{
+		return;
+	}
+
+	// k^2 is reduced modulo 2n before converting to an angle so large k do not lose precision.
+	m_chirp.reserve(size);
+	for(long long k = 0; k < size; ++k)
+	{
+		long long phase = (k * k) % (2LL * size);
+		m_chirp.push_back(std::polar(1.0, -pi * phase / size));
+	}
+
+	m_filter.assign(m_paddedSize, 0.0);
+	m_filter[0] = std::conj(m_chirp[0]);
+	for(int k = 1; k < size; ++k)
+	{
+		m_filter[k] = m_filter[m_paddedSize - k] = std::conj(m_chirp[k]);
+	}
+	radix2(m_filter.data());
+
+	m_work.resize(m_paddedSize);
+}
+
+int FourierTransform::getSize() const
+{
+	return m_size;
+}
+
+void FourierTransform::radix2(std::complex<double> *data) const
+{
+	const int n = m_paddedSize;
+
+	// Bit reversal permutation.
+	for(int i = 1, j = 0; i < n; ++i)
+	{
+		int bit = n >> 1;
+		for(; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+
+		if(i < j)
+		{
+			std::swap(data[i], data[j]);
+		}
+	}
+
+	// Butterflies, the twiddle stride halves as the blocks double in length.
+	for(int length = 2; length <= n; length *= 2)
+	{
+		int half   = length / 2;
+		int stride = n / length;
+		for(int start = 0; start < n; start += length)
+		{
+			for(int k = 0; k < half; ++k)
+			{
+				std::complex<double> odd = data[start + k + half] * m_twiddles[k * stride];
+				data[start + k + half] = data[start + k] - odd;
+				data[start + k] += odd;
+			}
+		}
+	}
+}
+
+void FourierTransform::transform(std::complex<double> *data, bool inverse)
+{
+	// The inverse is the conjugate of the forward transform of the conjugate.
+	if(inverse)
+	{
+		std::transform(data, data + m_size, data, [](const std::complex<double> &z) { return std::conj(z); });
+	}
+
+	if(m_chirp.empty())
+	{
+		radix2(data);
+	}
+	else
+	{
+		std::fill(m_work.begin(), m_work.end(), 0.0);
+		for(int k = 0; k < m_size; ++k)
+		{
+			m_work[k] = data[k] * m_chirp[k];
+		}
+
+		// Convolve with the filter through the power of two transform, the backward transform is
+		// done with the conjugate trick so only a forward radix-2 is needed.
+		radix2(m_work.data());
+		for(int k = 0; k < m_paddedSize; ++k)
+		{
+			m_work[k] = std::conj(m_work[k] * m_filter[k]);
+		}
+		radix2(m_work.data());
+
+		for(int k = 0; k < m_size; ++k)
+		{
+			data[k] = std::conj(m_work[k]) * (1.0 / m_paddedSize) * m_chirp[k];
+		}
+	}
+
+	if(inverse)
+	{
+		const double scale = 1.0 / m_size;
+		std::transform(data, data + m_size, data, [scale](const std::complex<double> &z) { return std::conj(z) * scale; });
+	}
+}
+
+void transform2D(std::vector<std::complex<double> > &data, FourierTransform &rowTransform, FourierTransform &colTransform, bool inverse)
+{
+	const int cols = rowTransform.getSize();
+	const int rows = colTransform.getSize();
+
+	for(int row = 0; row < rows; ++row)
+	{
+		rowTransform.transform(&data[row * cols], inverse);
+	}
+
+	// Columns are gathered into a contiguous buffer, transformed and scattered back.
+	std::vector<std::complex<double> > column(rows);
+	for(int col = 0; col < cols; ++col)
+	{
+		for(int row = 0; row < rows; ++row)
+		{
+			column[row] = data[col + row * cols];
+		}
+
+		colTransform.transform(column.data(), inverse);
+
+		for(int row = 0; row < rows; ++row)
+		{
+			data[col + row * cols] = column[row];
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef FourierTransform_hpp
+#define FourierTransform_hpp
+
+#include <complex>
+#include <vector>
+
+/**
+ *\file
+ *\class FourierTransform
+ *\brief Class for O(n log n) discrete Fourier transforms of any length.
+ *
+ * Powers of two use an iterative radix-2 transform, any other length is turned into a power of two
+ * circular convolution with Bluestein's algorithm. Everything that only depends on the length is
+ * worked out in the constructor so repeated transforms of the same length are cheap.
+ */
+class FourierTransform
+{
+private:
+	/// Member variable for the length of the transform.
+	int m_size;
+
+	/// Member variable for the length of the power of two transform that does the work.
+	int m_paddedSize;
+
+	/// Member variable holding exp(-2 pi i k / m_paddedSize) for k < m_paddedSize/2.
+	std::vector<std::complex<double> > m_twiddles;
+
+	/// Member variable holding the Bluestein chirp exp(-pi i k^2 / m_size), empty for powers of two.
+	std::vector<std::complex<double> > m_chirp;
+
+	/// Member variable holding the forward transform of the conjugate chirp filter, empty for powers of two.
+	std::vector<std::complex<double> > m_filter;
+
+	/// Member variable holding scratch space for the Bluestein convolution.
+	std::vector<std::complex<double> > m_work;
+
+	/**
+	 *\brief In-place forward radix-2 transform of length m_paddedSize.
+	 *\param data pointer to m_paddedSize complex values.
+	 */
+	void radix2(std::complex<double> *data) const;
+
+public:
+	/**
+	 *\brief Constructor that prepares transforms of a given length.
+	 *\param size integer value representing the length of the transform.
+	 */
+	FourierTransform(int size = 1);
+
+	/**
+	 *\brief Getter for the length of the transform.
+	 *\return Integer value representing the length of the transform.
+	 */
+	int getSize() const;
+
+	/**
+	 *\brief In-place transform X_k = sum_j x_j exp(-+2 pi i j k / n).
+	 *\param data pointer to getSize() complex values.
+	 *\param inverse Boolean value, if true the sign of the exponent is positive and the result is divided by n.
+	 */
+	void transform(std::complex<double> *data, bool inverse = false);
+};
+
+/**
+ *\brief In-place two dimensional transform of row-major data.
+ *\param data vector of rows*cols complex values, element (row,col) is at col + row * cols.
+ *\param rowTransform FourierTransform reference of length cols used along the rows.
+ *\param colTransform FourierTransform reference of length rows used along the columns.
+ *\param inverse Boolean value, if true the inverse transform is applied.
+ */
+void transform2D(std::vector<std::complex<double> > &data, FourierTransform &rowTransform, FourierTransform &colTransform, bool inverse = false);
+
+#endif /* FourierTransform_hpp */
@@ -0,0 +1,320 @@
+#include "FrameRenderer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	/**
+	 *\brief Calculates the CRC-32 PNG chunks end with.
+	 *\param data pointer to the bytes.
+	 *\param size number of bytes.
+	 *\return 32 bit CRC.
+	 */
+	std::uint32_t crc32(const unsigned char *data, std::size_t size)
+	{
+		static const std::array<std::uint32_t, 256> table = []()
+		{
+			std::array<std::uint32_t, 256> entries;
+			for(std::uint32_t n = 0; n < 256; ++n)
+			{
+				std::uint32_t c = n;
+				for(int bit = 0; bit < 8; ++bit)
+				{
+					c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				}
+				entries[n] = c;
+			}
+			return entries;
+		}();
+
+		std::uint32_t crc = 0xffffffffu;
+		for(std::size_t n = 0; n < size; ++n)
+		{
+			crc = table[(crc ^ data[n]) & 0xff] ^ (crc >> 8);
+		}
+
+		return crc ^ 0xffffffffu;
+	}
+
+	/**
+	 *\brief Calculates the Adler-32 checksum a zlib stream ends with.
+	 *\param data constant vector of the uncompressed bytes.
+	 *\return 32 bit checksum.
+	 */
+	std::uint32_t adler32(const std::vector<unsigned char> &data)
+	{
+		const std::uint32_t modulus = 65521;
+		std::uint32_t a = 1;
+		std::uint32_t b = 0;
+
+		// 5552 bytes is the most that can be summed before b could overflow.
+		for(std::size_t begin = 0; begin < data.size(); begin += 5552)
+		{
+			std::size_t end = std::min(data.size(), begin + 5552);
+			for(std::size_t n = begin; n < end; ++n)
+			{
+				a += data[n];
+				b += a;
+			}
+			a %= modulus;
+			b %= modulus;
+		}
+
+		return (b << 16) | a;
+	}
+
+	/**
+	 *\brief Appends a 32 bit value most significant byte first.
+	 *\param out vector of bytes to append to.
+	 *\param value 32 bit value.
+	 */
+	void appendBigEndian(std::vector<unsigned char> &out, std::uint32_t value)
+	{
+		out.push_back(value >> 24);
+		out.push_back(value >> 16);
+		out.push_back(value >> 8);
+		out.push_back(value);
+	}
+
+	/**
+	 *\brief Appends a PNG chunk, its length, type, data and CRC.
+	 *\param out vector of bytes to append to.
+	 *\param type four character chunk type.
+	 *\param data constant vector of the chunk data.
+	 */
+	void appendChunk(std::vector<unsigned char> &out, const char *type, const std::vector<unsigned char> &data)
+	{
+		appendBigEndian(out, data.size());
+
+		std::size_t typeBegin = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+
+		appendBigEndian(out, crc32(out.data() + typeBegin, out.size() - typeBegin));
+	}
+
+	/**
+	 *\brief Reads a colour given as a name or as #rrggbb.
+	 *\param name string describing the colour.
+	 *\param colour FrameRenderer::Colour reference set if the colour is understood.
+	 *\return bool true if the colour is understood.
+	 */
+	bool parseColour(const std::string &name, FrameRenderer::Colour &colour)
+	{
+		// The names gnuplot palettes are most often written with.
+		static const std::pair<const char*, FrameRenderer::Colour> names[] =
+		{
+			{"red",    {{255, 0, 0}}},
+			{"green",  {{0, 255, 0}}},
+			{"blue",   {{0, 0, 255}}},
+			{"black",  {{0, 0, 0}}},
+			{"white",  {{255, 255, 255}}},
+			{"grey",   {{190, 190, 190}}},
+			{"gray",   {{190, 190, 190}}},
+			{"yellow", {{255, 255, 0}}},
+			{"cyan",   {{0, 255, 255}}},
+			{"magenta",{{255, 0, 255}}},
+			{"orange", {{255, 165, 0}}},
+		};
+
+		for(const auto &entry : names)
+		{
+			if(name == entry.first)
+			{
+				colour = entry.second;
+				return true;
+			}
+		}
+
+		if(7 != name.size() || '#' != name[0] || std::string::npos != name.find_first_not_of("0123456789abcdefABCDEF", 1))
+		{
+			return false;
+		}
+
+		for(int component = 0; component < 3; ++component)
+		{
+			colour[component] = std::stoi(name.substr(1 + 2 * component, 2), nullptr, 16);
+		}
+
+		return true;
+	}
+}
+
+FrameRenderer::FrameRenderer(
+	const std::string &directory,
+	Format format,
+	int maxSide,
+	const Palette &palette
+	) : m_directory(directory),
+		m_format{format},
+		m_maxSide{std::max(0, maxSide)},
+		m_palette(palette)
+{
+
+}
+
+FrameRenderer::Format FrameRenderer::parseFormat(const std::string &name)
+{
+	if("ppm" == name)
+	{
+		return PPMFormat;
+	}
+
+	if("png" == name)
+	{
+		return PNGFormat;
+	}
+
+	// Let the caller decide how to report an unknown format.
+	return MAXFORMAT;
+}
+
+FrameRenderer::Palette FrameRenderer::defaultPalette()
+{
+	return Palette{{{{255, 0, 0}}, {{0, 255, 0}}, {{0, 0, 255}}, {{0, 0, 255}}}};
+}
+
+bool FrameRenderer::parsePalette(const std::string &description, Palette &palette)
+{
+	std::string names = description;
+	std::replace(names.begin(), names.end(), ',', ' ');
+
+	std::istringstream stream(names);
+	Palette parsed;
+	int state = 0;
+	std::string name;
+	while(stream >> name)
+	{
+		if(state >= SIRSArray::MAXSTATE || !parseColour(name, parsed[state]))
+		{
+			return false;
+		}
+		++state;
+	}
+
+	if(SIRSArray::MAXSTATE != state)
+	{
+		return false;
+	}
+
+	palette = parsed;
+	return true;
+}
+
+std::vector<unsigned char> FrameRenderer::encodePPM(const std::vector<unsigned char> &states, int width, int height) const
+{
+	std::string header = "P6\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n255\n";
+
+	std::vector<unsigned char> file(header.begin(), header.end());
+	file.reserve(header.size() + 3 * states.size());
+	for(unsigned char state : states)
+	{
+		file.insert(file.end(), m_palette[state].begin(), m_palette[state].end());
+	}
+
+	return file;
+}
+
+std::vector<unsigned char> FrameRenderer::encodePNG(const std::vector<unsigned char> &states, int width, int height) const
+{
+	// Each row is a filter byte of 0, no filter, then four pixels to a byte, the first in the top bits.
+	const int rowBytes = (width + 3) / 4;
+	std::vector<unsigned char> raw(static_cast<std::size_t>(1 + rowBytes) * height, 0);
+	for(int row = 0; row < height; ++row)
+	{
+		unsigned char *out = &raw[static_cast<std::size_t>(1 + rowBytes) * row + 1];
+		const unsigned char *in = &states[static_cast<std::size_t>(width) * row];
+		for(int col = 0; col < width; ++col)
+		{
+			out[col / 4] |= in[col] << (6 - 2 * (col % 4));
+		}
+	}
+
+	std::vector<unsigned char> file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+	// Two bit depth, colour type 3 is indexed, then default compression, filtering and no interlace.
+	std::vector<unsigned char> header;
+	appendBigEndian(header, width);
+	appendBigEndian(header, height);
+	header.insert(header.end(), {2, 3, 0, 0, 0});
+	appendChunk(file, "IHDR", header);
+
+	std::vector<unsigned char> palette;
+	for(const auto &colour : m_palette)
+	{
+		palette.insert(palette.end(), colour.begin(), colour.end());
+	}
+	appendChunk(file, "PLTE", palette);
+
+	// A zlib stream of stored deflate blocks, each at most 65535 bytes with its length and complement.
+	std::vector<unsigned char> stream = {0x78, 0x01};
+	stream.reserve(raw.size() + 5 * (raw.size() / 65535 + 1) + 6);
+	std::size_t offset = 0;
+	do
+	{
+		std::size_t length = std::min<std::size_t>(65535, raw.size() - offset);
+		bool last = (offset + length == raw.size());
+
+		stream.push_back(last ? 1 : 0);
+		stream.push_back(length & 0xff);
+		stream.push_back(length >> 8);
+		stream.push_back(~length & 0xff);
+		stream.push_back((~length >> 8) & 0xff);
+		stream.insert(stream.end(), raw.begin() + offset, raw.begin() + offset + length);
+
+		offset += length;
+	}
+	while(offset < raw.size());
+	appendBigEndian(stream, adler32(raw));
+	appendChunk(file, "IDAT", stream);
+
+	appendChunk(file, "IEND", std::vector<unsigned char>());
+
+	return file;
+}
+
+std::vector<unsigned char> FrameRenderer::encode(const SIRSArray &lattice) const
+{
+	const SIRSArray::StateVector &board = lattice.getBoardData();
+	const int rows = lattice.getRows();
+	const int cols = lattice.getCols();
+
+	// Sample every stride-th cell so neither side of the frame is longer than m_maxSide.
+	const int stride = (m_maxSide > 0) ? std::max(1, (std::max(rows, cols) + m_maxSide - 1) / m_maxSide) : 1;
+	const int width  = (cols + stride - 1) / stride;
+	const int height = (rows + stride - 1) / stride;
+
+	std::vector<unsigned char> states;
+	states.reserve(static_cast<std::size_t>(width) * height);
+	for(int row = 0; row < rows; row += stride)
+	{
+		for(int col = 0; col < cols; col += stride)
+		{
+			states.push_back(board[col + row * cols]);
+		}
+	}
+
+	return (PPMFormat == m_format) ? encodePPM(states, width, height) : encodePNG(states, width, height);
+}
+
+bool FrameRenderer::render(int sweep, const SIRSArray &lattice) const
+{
+	std::vector<unsigned char> file = encode(lattice);
+
+	std::ofstream out(frameName(sweep), std::ios::out | std::ios::binary);
+	out.write(reinterpret_cast<const char*>(file.data()), file.size());
+
+	return static_cast<bool>(out);
+}
+
+std::string FrameRenderer::frameName(int sweep) const
+{
+	// Zero padded so the frames sort in order for a movie encoder.
+	char number[16];
+	std::snprintf(number, sizeof(number), "%08d", sweep);
+
+	return m_directory + "/Frame" + number + (PPMFormat == m_format ? ".ppm" : ".png");
+}
@@ -0,0 +1,127 @@
+#ifndef FrameRenderer_hpp
+#define FrameRenderer_hpp
+
+#include "SIRSArray.hpp"
+#include <array>
+#include <string>
+#include <vector>
+
+/**
+ *\file
+ *\class FrameRenderer
+ *\brief Class for rendering the lattice to a numbered sequence of image files.
+ *
+ * Each cell is one pixel coloured by its state. Lattices wider or taller than the largest side are
+ * downsampled the same way as the telemetry image, by taking every stride-th cell along both axes.
+ *
+ * PPM frames are plain RGB. PNG frames are indexed with two bits per pixel, since there are only four
+ * states, and stored in uncompressed deflate blocks so no compression library is needed, a frame
+ * is still a twelfth of the size of the same frame as PPM. Rendering only reads the lattice and the
+ * renderer, so any number of threads can render frames at once.
+ */
+class FrameRenderer
+{
+public:
+	/**
+	 * \enum Format
+	 * \brief Enumeration of the image formats frames can be written in.
+	 */
+	enum Format
+	{
+		PPMFormat, ///< Binary portable pixmap, P6.
+		PNGFormat, ///< Indexed colour PNG.
+		MAXFORMAT,
+	};
+
+	/// Red, green and blue components of a colour.
+	using Colour = std::array<unsigned char, 3>;
+
+	/// Colour of each state.
+	using Palette = std::array<Colour, SIRSArray::MAXSTATE>;
+
+private:
+	/// Member variable for the directory frames are written to.
+	std::string m_directory;
+
+	/// Member variable for the format frames are written in.
+	Format m_format;
+
+	/// Member variable for the largest side of a frame in pixels, 0 for one pixel per cell.
+	int m_maxSide;
+
+	/// Member variable holding the colour of each state.
+	Palette m_palette;
+
+	/**
+	 *\brief Encodes sampled states as a binary PPM.
+	 *\param states constant vector of the state of each pixel, row by row.
+	 *\param width integer value representing the number of pixels in a row.
+	 *\param height integer value representing the number of rows.
+	 *\return vector of the bytes of the file.
+	 */
+	std::vector<unsigned char> encodePPM(const std::vector<unsigned char> &states, int width, int height) const;
+
+	/**
+	 *\brief Encodes sampled states as a PNG with a palette of the state colours.
+	 *\param states constant vector of the state of each pixel, row by row.
+	 *\param width integer value representing the number of pixels in a row.
+	 *\param height integer value representing the number of rows.
+	 *\return vector of the bytes of the file.
+	 */
+	std::vector<unsigned char> encodePNG(const std::vector<unsigned char> &states, int width, int height) const;
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param directory string for the directory frames are written to, it must exist.
+	 *\param format Format frames are written in.
+	 *\param maxSide integer value representing the largest side of a frame in pixels, 0 for one pixel per cell.
+	 *\param palette Palette of the state colours.
+	 */
+	FrameRenderer(const std::string &directory, Format format = PNGFormat, int maxSide = 0, const Palette &palette = defaultPalette());
+
+	/**
+	 *\brief Converts the name of a format given on the command line into its enumeration value.
+	 *\param name string that is ppm or png.
+	 *\return Format value, MAXFORMAT if the name is not recognised.
+	 */
+	static Format parseFormat(const std::string &name);
+
+	/**
+	 *\brief The colours animate.gp uses, red, green and blue for susceptible, infected and recovered.
+	 *\return Palette where immune cells are blue too, as animate.gp clamps them to the top of its range.
+	 */
+	static Palette defaultPalette();
+
+	/**
+	 *\brief Reads a palette of one colour per state.
+	 *\param description string of four colours separated by commas or spaces, each a name such as red or a hex value such as #ff8000.
+	 *\param palette Palette reference that is set if every colour is understood.
+	 *\return bool true if the description was understood.
+	 */
+	static bool parsePalette(const std::string &description, Palette &palette);
+
+	/**
+	 *\brief Encodes the lattice in the renderer's format.
+	 *\param lattice constant SIRSArray reference to render.
+	 *\return vector of the bytes of the file.
+	 */
+	std::vector<unsigned char> encode(const SIRSArray &lattice) const;
+
+	/**
+	 *\brief Encodes the lattice and writes it to the frame file for a sweep.
+	 *\param sweep integer value representing the sweep, which numbers the file.
+	 *\param lattice constant SIRSArray reference to render.
+	 *\return bool true if the file was written.
+	 */
+	bool render(int sweep, const SIRSArray &lattice) const;
+
+	/**
+	 *\brief Name of the file the frame of a sweep is written to.
+	 *\param sweep integer value representing the sweep.
+	 *\return string path of the file.
+	 */
+	std::string frameName(int sweep) const;
+};
+
+#endif /* FrameRenderer_hpp */
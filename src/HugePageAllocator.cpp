@@ -0,0 +1,139 @@
+#include "HugePageAllocator.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <sys/mman.h>
+
+namespace
+{
+	/// How buffers allocated from now on are backed.
+	std::atomic<int> currentMode(TransparentHugePages);
+
+	/**
+	 *\brief Rounds a size up to a whole number of huge pages.
+	 *\param bytes number of bytes.
+	 *\return number of bytes to map.
+	 */
+	std::size_t mappedSize(std::size_t bytes)
+	{
+		return (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+	}
+
+	/**
+	 *\brief Maps memory aligned to a huge page by mapping an extra huge page and trimming the ends.
+	 *\param bytes number of bytes to map, a multiple of hugePageSize.
+	 *\return pointer to the memory, nullptr on failure.
+	 */
+	void* mapAligned(std::size_t bytes)
+	{
+		void *mapping = mmap(nullptr, bytes + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(MAP_FAILED == mapping)
+		{
+			return nullptr;
+		}
+
+		std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(mapping);
+		std::uintptr_t aligned = (begin + hugePageSize - 1) / hugePageSize * hugePageSize;
+		if(aligned > begin)
+		{
+			munmap(mapping, aligned - begin);
+		}
+
+		std::size_t tail = begin + bytes + hugePageSize - (aligned + bytes);
+		if(tail > 0)
+		{
+			munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+		}
+
+		return reinterpret_cast<void*>(aligned);
+	}
+}
+
+HugePageMode parseHugePageMode(const std::string &name)
+{
+	if("off" == name)
+	{
+		return NoHugePages;
+	}
+
+	if("transparent" == name)
+	{
+		return TransparentHugePages;
+	}
+
+	if("explicit" == name)
+	{
+		return ExplicitHugePages;
+	}
+
+	// Let the caller decide how to report an unknown mode.
+	return MAXHUGEPAGEMODE;
+}
+
+void setHugePageMode(HugePageMode mode)
+{
+	currentMode.store(mode, std::memory_order_relaxed);
+}
+
+HugePageMode getHugePageMode()
+{
+	return static_cast<HugePageMode>(currentMode.load(std::memory_order_relaxed));
+}
+
+void* allocatePages(std::size_t bytes)
+{
+	if(bytes < hugePageSize)
+	{
+		void *pointer = std::calloc(bytes ? bytes : 1, 1);
+		if(nullptr == pointer)
+		{
+			throw std::bad_alloc();
+		}
+		return pointer;
+	}
+
+	const std::size_t size = mappedSize(bytes);
+	const HugePageMode mode = getHugePageMode();
+
+#ifdef MAP_HUGETLB
+	if(ExplicitHugePages == mode)
+	{
+		void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if(MAP_FAILED != mapping)
+		{
+			return mapping;
+		}
+	}
+#endif
+
+	void *mapping = mapAligned(size);
+	if(nullptr == mapping)
+	{
+		throw std::bad_alloc();
+	}
+
+#ifdef MADV_HUGEPAGE
+	// Only a hint, kernels without transparent huge pages simply ignore it.
+	if(NoHugePages != mode)
+	{
+		madvise(mapping, size, MADV_HUGEPAGE);
+	}
+#endif
+
+	return mapping;
+}
+
+void deallocatePages(void *pointer, std::size_t bytes)
+{
+	if(nullptr == pointer)
+	{
+		return;
+	}
+
+	if(bytes < hugePageSize)
+	{
+		std::free(pointer);
+		return;
+	}
+
+	munmap(pointer, mappedSize(bytes));
+}
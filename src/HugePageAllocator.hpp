@@ -0,0 +1,163 @@
+#ifndef HugePageAllocator_hpp
+#define HugePageAllocator_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+ *\file
+ *\brief Allocation of large buffers straight from the kernel, backed by huge pages where available.
+ *
+ * A sweep touches cells at random all over the lattice, so once the board is larger than the
+ * TLB can cover with 4 KiB pages nearly every update misses the TLB. Buffers of at least
+ * hugePageSize bytes are therefore mapped with mmap, rounded to whole huge pages and aligned to
+ * them, and either marked for transparent huge pages with madvise or, in Explicit mode, mapped
+ * from the reserved huge page pool with MAP_HUGETLB, falling back to transparent huge pages if
+ * the pool is empty. Smaller buffers come from calloc.
+ *
+ * Memory from either source is already zero, so value-initialising an element only writes it if
+ * it is not zero already, which it can only be when a container reuses memory it shrank. Reading
+ * an untouched page maps the shared zero page, so the pages of a new buffer are only placed in
+ * memory when they are first written, which puts each page on the NUMA node of the thread that
+ * writes it: filling a buffer inside parallelFor spreads it over the nodes of the threads that go
+ * on to use it.
+ */
+
+/**
+ * \enum HugePageMode
+ * \brief Enumeration of the ways large buffers can be backed.
+ */
+enum HugePageMode
+{
+	NoHugePages,          ///< Ordinary pages.
+	TransparentHugePages, ///< Pages the kernel may promote to huge pages, madvise(MADV_HUGEPAGE).
+	ExplicitHugePages,    ///< Pages from the reserved pool, MAP_HUGETLB, else transparent huge pages.
+	MAXHUGEPAGEMODE,
+};
+
+/// Size of a huge page on x86-64 and the smallest buffer that is mapped rather than taken from calloc.
+constexpr std::size_t hugePageSize = std::size_t(2) << 20;
+
+/**
+ *\brief Converts the name of a mode given on the command line into its enumeration value.
+ *\param name string that is off, transparent or explicit.
+ *\return HugePageMode value, MAXHUGEPAGEMODE if the name is not recognised.
+ */
+HugePageMode parseHugePageMode(const std::string &name);
+
+/**
+ *\brief Setter for how buffers allocated from now on are backed, transparent huge pages by default.
+ *\param mode HugePageMode value.
+ */
+void setHugePageMode(HugePageMode mode);
+
+/**
+ *\brief Getter for how buffers are backed.
+ *\return HugePageMode value.
+ */
+HugePageMode getHugePageMode();
+
+/**
+ *\brief Allocates zeroed memory, mapping it if it is large.
+ *\param bytes number of bytes to allocate.
+ *\return pointer to the memory, throws std::bad_alloc on failure.
+ */
+void* allocatePages(std::size_t bytes);
+
+/**
+ *\brief Releases memory from allocatePages.
+ *\param pointer pointer returned by allocatePages.
+ *\param bytes number of bytes that were asked for.
+ */
+void deallocatePages(void *pointer, std::size_t bytes);
+
+/**
+ *\class HugePageAllocator
+ *\brief Standard library allocator that takes its memory from allocatePages.
+ *
+ * Only for trivial types whose all-zero bit pattern is their value-initialised value, such as the
+ * cell states, indices and counts. A vector of n value-initialised elements then costs a mapping
+ * and a read of the zero page until it is written.
+ */
+template<class T>
+class HugePageAllocator
+{
+	static_assert(std::is_trivial<T>::value, "HugePageAllocator relies on zeroed memory being a valid T");
+
+public:
+	/// Type of the elements allocated.
+	using value_type = T;
+
+	/**
+	 *\brief Default constructor.
+	 */
+	HugePageAllocator() = default;
+
+	/**
+	 *\brief Converting constructor so containers can rebind the allocator.
+	 */
+	template<class U>
+	HugePageAllocator(const HugePageAllocator<U>&)
+	{
+
+	}
+
+	/**
+	 *\brief Allocates space for n elements.
+	 *\param n number of elements.
+	 *\return pointer to zeroed memory for the elements.
+	 */
+	T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(allocatePages(n * sizeof(T)));
+	}
+
+	/**
+	 *\brief Releases space for n elements.
+	 *\param pointer pointer returned by allocate.
+	 *\param n number of elements it was allocated for.
+	 */
+	void deallocate(T *pointer, std::size_t n)
+	{
+		deallocatePages(pointer, n * sizeof(T));
+	}
+
+	/**
+	 *\brief Value-initialises an element, writing it only if the memory is not already zero.
+	 */
+	template<class U>
+	void construct(U *pointer)
+	{
+		if(!(*pointer == U()))
+		{
+			*pointer = U();
+		}
+	}
+
+	/**
+	 *\brief Constructs an element from arguments.
+	 */
+	template<class U, class... Args>
+	void construct(U *pointer, Args&&... args)
+	{
+		::new(static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+	}
+};
+
+template<class T, class U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&)
+{
+	return true;
+}
+
+template<class T, class U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&)
+{
+	return false;
+}
+
+#endif /* HugePageAllocator_hpp */
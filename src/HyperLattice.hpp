@@ -0,0 +1,455 @@
+#ifndef HyperLattice_hpp
+#define HyperLattice_hpp
+
+#include "SIRSArray.hpp" // For the State enumeration and the initial conditions shared with the 2D lattice.
+#include <array>
+#include <vector>
+#include <random>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+/// Largest number of dimensions a HyperLattice can be created with at runtime.
+constexpr int maxLatticeDimensions = 4;
+
+/**
+ *\file
+ *\class HyperLatticeBase
+ *\brief Dimension independent part of a periodic hypercubic lattice of SIRS cells.
+ *
+ * This holds the cells and the probabilities, only the sweep depends on the dimension so a
+ * simulation can pick the dimension at runtime and pay for one virtual call per sweep.
+ */
+class HyperLatticeBase
+{
+protected:
+    /// Member variable that holds the state of every cell, the last axis varies fastest.
+    SIRSArray::StateVector m_stateData;
+
+    /// Member variable for the probability of going from susceptible to infected.
+    double m_probSI;
+
+    /// Member variable for the probability of going from infected to recovered.
+    double m_probIR;
+
+    /// Member variable for the probability of going from recovered to susceptible.
+    double m_probRS;
+
+    /// Member variable for whether the lattice can hold immune cells, the sweep only checks for them if so.
+    bool m_immunity;
+
+    /**
+     *\brief Constructor for the cells of a lattice.
+     *\param size integer value representing the total number of cells.
+     *\param probSI probability of going from susceptible to infected if the cell has an infected neighbour.
+     *\param probIR probability of infected cell going from infected to recovered.
+     *\param probRS probability of recovered cell becoming susceptible again.
+     */
+    HyperLatticeBase(int size, double probSI, double probIR, double probRS);
+
+public:
+    /**
+     *\brief Virtual destructor so lattices can be owned through a base pointer.
+     */
+    virtual ~HyperLatticeBase();
+
+    /**
+     *\brief Creates a lattice with the dimension given by the number of axis sizes.
+     *\param sizes vector of integer values representing the number of cells along each axis.
+     *\param probSI probability of going from susceptible to infected if the cell has an infected neighbour.
+     *\param probIR probability of infected cell going from infected to recovered.
+     *\param probRS probability of recovered cell becoming susceptible again.
+     *\return unique_ptr to the lattice with every cell susceptible.
+     *
+     * Throws std::invalid_argument if there are more than maxLatticeDimensions axes or an axis is empty.
+     */
+    static std::unique_ptr<HyperLatticeBase> create(const std::vector<int> &sizes, double probSI, double probIR, double probRS);
+
+    /**
+     *\brief Fills the lattice with the same initial conditions as SIRSArray::initialise.
+     *\param seed 64 bit seed the cells are generated from.
+     *\param immuneFraction floating point value representing the fraction of cells that are immune.
+     *\param threadCount Integer value representing the number of threads used to fill the lattice.
+     */
+    void initialise(std::uint64_t seed, double immuneFraction, int threadCount = 1);
+
+    /**
+     *\brief Changes the number of immune cells, see SIRSArray::changeImmuneFraction.
+     *\param immuneFraction floating point value representing the new fraction of immune cells.
+     *\param generator RandomStream reference for random number generation.
+     */
+    void setImmuneFraction(double immuneFraction, RandomStream &generator);
+
+    /**
+     *\brief Setter for all three transition probabilities.
+     *\param probSI probability of going from susceptible to infected if the cell has an infected neighbour.
+     *\param probIR probability of infected cell going from infected to recovered.
+     *\param probRS probability of recovered cell becoming susceptible again.
+     */
+    void setProbabilities(double probSI, double probIR, double probRS);
+
+    /**
+     *\brief Getter for the number of dimensions.
+     *\return Integer value representing the number of axes.
+     */
+    virtual int getDimensions() const = 0;
+
+    /**
+     *\brief Getter for the total number of cells.
+     *\return Integer value representing the number of cells.
+     */
+    int getSize() const;
+
+    /**
+     *\brief Getter for the state of every cell.
+     *\return constant reference to the vector holding the cells, the last axis varies fastest.
+     */
+    const SIRSArray::StateVector& getStateData() const;
+
+    /**
+     *\brief Performs one sweep, getSize() updates of randomly chosen cells.
+     *\param generator RandomStream for random number generation.
+     */
+    virtual void sweep(RandomStream &generator) = 0;
+
+    /**
+     *\brief calculates the total number of cells in a given state.
+     *\param state value representing the state of interest.
+     *\return Integer value representing the total number of cells in the state of interest.
+     */
+    int stateCount(SIRSArray::State state) const;
+
+    /**
+     *\brief calculates the fraction of cells in a given state.
+     *\param state value representing the state of interest.
+     *\return Floating point value representing the fraction of cells in the state of interest.
+     */
+    double stateFraction(SIRSArray::State state) const;
+};
+
+/**
+ *\class HyperLattice
+ *\brief Periodic hypercubic lattice of SIRS cells in D dimensions with nearest neighbour contacts.
+ *
+ * A cell at coordinates x has the 2D neighbours x +- e_a along each axis a, the loop over them has
+ * a compile time trip count. Random cells are chosen by drawing one coordinate per axis, exactly as
+ * SIRSArray draws a row and a column, so the neighbours are found by adding an offset looked up
+ * from the coordinate along each axis rather than by a division or modulo. For D = 2 the cells are
+ * laid out like SIRSArray with a von Neumann neighbourhood of radius 1.
+ */
+template<int D>
+class HyperLattice : public HyperLatticeBase
+{
+    static_assert(D >= 1, "A lattice needs at least one dimension");
+
+private:
+    /// Member variable holding the number of cells along each axis.
+    std::array<int, D> m_sizes;
+
+    /// Member variable holding the distance in m_stateData between neighbours along each axis.
+    std::array<int, D> m_strides;
+
+    /// Member variable holding, for each axis and coordinate, the offset to the next cell along the axis.
+    std::array<std::vector<int>, D> m_upOffsets;
+
+    /// Member variable holding, for each axis and coordinate, the offset to the previous cell along the axis.
+    std::array<std::vector<int>, D> m_downOffsets;
+
+    /**
+     *\brief Calculates the total number of cells.
+     *\param sizes array of the number of cells along each axis.
+     *\return Integer value representing the product of the sizes.
+     *
+     * Throws std::invalid_argument if the product does not fit in an int.
+     */
+    static int product(const std::array<int, D> &sizes);
+
+public:
+    /**
+     *\brief Constructor for a lattice with every cell susceptible.
+     *\param sizes array of the number of cells along each axis, each at least 1.
+     *\param probSI probability of going from susceptible to infected if the cell has an infected neighbour.
+     *\param probIR probability of infected cell going from infected to recovered.
+     *\param probRS probability of recovered cell becoming susceptible again.
+     */
+    HyperLattice(const std::array<int, D> &sizes, double probSI = 1.0, double probIR = 1.0, double probRS = 1.0);
+
+    int getDimensions() const override;
+
+    /**
+     *\brief Getter for the number of cells along each axis.
+     *\return constant reference to the array of sizes.
+     */
+    const std::array<int, D>& getSizes() const;
+
+    /**
+     *\brief Determines whether a cell has an infected nearest neighbour.
+     *\param index integer value representing the position of the cell in getStateData().
+     *\param coordinates array holding the coordinates of the same cell.
+     *\return Boolean value representing whether the cell has an infected neighbour.
+     */
+    bool hasInfectedNeighbour(int index, const std::array<int, D> &coordinates) const;
+
+    /**
+     *\brief Updates the state of a single cell based on its state, its neighbours and the probabilities.
+     *\param coordinates array holding the coordinates of the cell.
+     *\param generator RandomStream for random number generation.
+     *\return the new updated state of the cell.
+     *
+     * Features is a combination of the SIRSArray::Feature flags, without SIRSArray::ImmunityFeature the
+     * lattice must not contain any Immune cells.
+     */
+    template<unsigned Features>
+    SIRSArray::State updateCell(const std::array<int, D> &coordinates, RandomStream &generator);
+
+    /**
+     *\brief Performs one sweep with the kernel specialised for a set of features.
+     *\param generator RandomStream for random number generation.
+     */
+    template<unsigned Features>
+    void sweep(RandomStream &generator);
+
+    void sweep(RandomStream &generator) override;
+};
+
+inline HyperLatticeBase::HyperLatticeBase(
+    int size,
+    double probSI,
+    double probIR,
+    double probRS
+    ) : m_stateData(size, SIRSArray::Susceptible),
+        m_probSI{probSI},
+        m_probIR{probIR},
+        m_probRS{probRS},
+        m_immunity{false}
+{
+
+}
+
+inline HyperLatticeBase::~HyperLatticeBase()
+{
+
+}
+
+inline void HyperLatticeBase::initialise(std::uint64_t seed, double immuneFraction, int threadCount)
+{
+    SIRSArray::initialiseStates(m_stateData, seed, immuneFraction, threadCount);
+    m_immunity = (immuneFraction != 0);
+}
+
+inline void HyperLatticeBase::setImmuneFraction(double immuneFraction, RandomStream &generator)
+{
+    SIRSArray::changeImmuneFraction(m_stateData, immuneFraction, generator);
+    m_immunity = m_immunity || (immuneFraction != 0);
+}
+
+inline void HyperLatticeBase::setProbabilities(double probSI, double probIR, double probRS)
+{
+    m_probSI = probSI;
+    m_probIR = probIR;
+    m_probRS = probRS;
+}
+
+inline int HyperLatticeBase::getSize() const
+{
+    return m_stateData.size();
+}
+
+inline const SIRSArray::StateVector& HyperLatticeBase::getStateData() const
+{
+    return m_stateData;
+}
+
+inline int HyperLatticeBase::stateCount(SIRSArray::State state) const
+{
+    return std::count(m_stateData.begin(), m_stateData.end(), state);
+}
+
+inline double HyperLatticeBase::stateFraction(SIRSArray::State state) const
+{
+    return static_cast<double>(stateCount(state)) / getSize();
+}
+
+template<int D>
+int HyperLattice<D>::product(const std::array<int, D> &sizes)
+{
+    // Checking after every axis keeps the 64 bit product from overflowing too.
+    std::uint64_t size = 1;
+    for(int axis = 0; axis < D; ++axis)
+    {
+        size *= static_cast<std::uint64_t>(sizes[axis]);
+        if(size > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+        {
+            throw std::invalid_argument("The lattice has more cells than can be indexed, at most " +
+                std::to_string(std::numeric_limits<int>::max()) + " are allowed");
+        }
+    }
+
+    return static_cast<int>(size);
+}
+
+template<int D>
+HyperLattice<D>::HyperLattice(
+    const std::array<int, D> &sizes,
+    double probSI,
+    double probIR,
+    double probRS
+    ) : HyperLatticeBase(product(sizes), probSI, probIR, probRS),
+        m_sizes(sizes)
+{
+    int stride = 1;
+    for(int axis = D - 1; axis >= 0; --axis)
+    {
+        m_strides[axis] = stride;
+        stride *= m_sizes[axis];
+
+        // Moving off either end of an axis wraps round to the other end.
+        const int period = m_sizes[axis];
+        m_upOffsets[axis].assign(period, m_strides[axis]);
+        m_downOffsets[axis].assign(period, -m_strides[axis]);
+        m_upOffsets[axis][period - 1] = -(period - 1) * m_strides[axis];
+        m_downOffsets[axis][0]        =  (period - 1) * m_strides[axis];
+    }
+}
+
+template<int D>
+int HyperLattice<D>::getDimensions() const
+{
+    return D;
+}
+
+template<int D>
+const std::array<int, D>& HyperLattice<D>::getSizes() const
+{
+    return m_sizes;
+}
+
+template<int D>
+bool HyperLattice<D>::hasInfectedNeighbour(int index, const std::array<int, D> &coordinates) const
+{
+    const SIRSArray::State *cell = &m_stateData[index];
+    for(int axis = 0; axis < D; ++axis)
+    {
+        if(SIRSArray::Infected == cell[m_upOffsets[axis][coordinates[axis]]]
+        || SIRSArray::Infected == cell[m_downOffsets[axis][coordinates[axis]]])
+        {
+            return true;
+        }
+    }
+
+    // Otherwise there are no infected neighbours.
+    return false;
+}
+
+template<int D>
+template<unsigned Features>
+SIRSArray::State HyperLattice<D>::updateCell(const std::array<int, D> &coordinates, RandomStream &generator)
+{
+    int index = 0;
+    for(int axis = 0; axis < D; ++axis)
+    {
+        index += coordinates[axis] * m_strides[axis];
+    }
+
+    SIRSArray::State &cell = m_stateData[index];
+
+    // Immune cells never change, only kernels that were asked for it check.
+    if((Features & SIRSArray::ImmunityFeature) && SIRSArray::Immune == cell)
+    {
+        return cell;
+    }
+
+    if(SIRSArray::Susceptible == cell)
+    {
+        if(hasInfectedNeighbour(index, coordinates) && generator.uniform() < m_probSI)
+        {
+            cell = SIRSArray::Infected;
+        }
+    }
+    else if(SIRSArray::Infected == cell)
+    {
+        if(generator.uniform() < m_probIR)
+        {
+            cell = SIRSArray::Recovered;
+        }
+    }
+    else if(generator.uniform() < m_probRS)
+    {
+        cell = SIRSArray::Susceptible;
+    }
+
+    return cell;
+}
+
+template<int D>
+template<unsigned Features>
+void HyperLattice<D>::sweep(RandomStream &generator)
+{
+    std::array<std::uniform_int_distribution<int>, D> coordinateDistributions;
+    for(int axis = 0; axis < D; ++axis)
+    {
+        coordinateDistributions[axis] = std::uniform_int_distribution<int>(0, m_sizes[axis] - 1);
+    }
+
+    std::array<int, D> coordinates;
+    const int size = getSize();
+    for(int i = 0; i < size; ++i)
+    {
+        for(int axis = 0; axis < D; ++axis)
+        {
+            coordinates[axis] = coordinateDistributions[axis](generator);
+        }
+        updateCell<Features>(coordinates, generator);
+    }
+}
+
+template<int D>
+void HyperLattice<D>::sweep(RandomStream &generator)
+{
+    if(m_immunity)
+    {
+        sweep<SIRSArray::ImmunityFeature>(generator);
+    }
+    else
+    {
+        sweep<0>(generator);
+    }
+}
+
+namespace HyperLatticeDetail
+{
+    /**
+     *\brief Copies a vector of sizes into an array and creates the lattice.
+     */
+    template<int D>
+    std::unique_ptr<HyperLatticeBase> create(const std::vector<int> &sizes, double probSI, double probIR, double probRS)
+    {
+        std::array<int, D> axisSizes;
+        std::copy(sizes.begin(), sizes.end(), axisSizes.begin());
+        return std::unique_ptr<HyperLatticeBase>(new HyperLattice<D>(axisSizes, probSI, probIR, probRS));
+    }
+}
+
+inline std::unique_ptr<HyperLatticeBase> HyperLatticeBase::create(const std::vector<int> &sizes, double probSI, double probIR, double probRS)
+{
+    if(std::any_of(sizes.begin(), sizes.end(), [](int size) { return size < 1; }))
+    {
+        throw std::invalid_argument("Every axis of the lattice needs at least one cell");
+    }
+
+    // Every dimension needs its own instantiation.
+    switch(sizes.size())
+    {
+        case 1 : return HyperLatticeDetail::create<1>(sizes, probSI, probIR, probRS);
+        case 2 : return HyperLatticeDetail::create<2>(sizes, probSI, probIR, probRS);
+        case 3 : return HyperLatticeDetail::create<3>(sizes, probSI, probIR, probRS);
+        case 4 : return HyperLatticeDetail::create<4>(sizes, probSI, probIR, probRS);
+        default: throw std::invalid_argument("Unsupported number of dimensions: " + std::to_string(sizes.size()) +
+            ", between 1 and " + std::to_string(maxLatticeDimensions) + " are available");
+    }
+}
+
+#endif /* HyperLattice_hpp */
@@ -0,0 +1,181 @@
+#include "MeasurementPipeline.hpp"
+#include <algorithm>
+#include <utility>
+
+MeasurementPipeline::MeasurementPipeline(
+	int threadCount,
+	int snapshotCount
+	) : m_submissionCount{0},
+		m_threadCount{std::max(0, threadCount)},
+		m_queuedCount{0},
+		m_committedCount{0},
+		m_stopping{false}
+{
+	if(0 == m_threadCount)
+	{
+		return;
+	}
+
+	// Two snapshots per thread lets one be copied while the other is analysed.
+	m_snapshots.resize(snapshotCount > 0 ? snapshotCount : 2 * m_threadCount);
+	for(int slot = 0; slot < static_cast<int>(m_snapshots.size()); ++slot)
+	{
+		m_freeSlots.push_back(slot);
+	}
+
+	for(int worker = 0; worker < m_threadCount; ++worker)
+	{
+		m_workers.emplace_back(&MeasurementPipeline::work, this, worker);
+	}
+}
+
+MeasurementPipeline::~MeasurementPipeline()
+{
+	finish();
+}
+
+void MeasurementPipeline::addAnalysis(Analysis analysis, int stride)
+{
+	m_analyses.push_back(analysis);
+	m_strides.push_back(std::max(1, stride));
+}
+
+void MeasurementPipeline::submit(int sweep, const SIRSArray &lattice)
+{
+	const long long submission = m_submissionCount++;
+
+	std::vector<int> analyses;
+	for(int analysis = 0; analysis < static_cast<int>(m_analyses.size()); ++analysis)
+	{
+		if(0 == submission % m_strides[analysis])
+		{
+			analyses.push_back(analysis);
+		}
+	}
+
+	if(analyses.empty())
+	{
+		return;
+	}
+
+	if(m_workers.empty())
+	{
+		for(int analysis : analyses)
+		{
+			m_analyses[analysis](sweep, lattice, 0)();
+		}
+		return;
+	}
+
+	int slot;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_slotFreed.wait(lock, [this]{ return !m_freeSlots.empty(); });
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	// Nothing else touches a free snapshot, assigning reuses its memory once it has the lattice's size.
+	m_snapshots[slot] = lattice;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(Job{m_queuedCount++, sweep, slot, std::move(analyses)});
+	}
+	m_jobQueued.notify_one();
+}
+
+void MeasurementPipeline::work(int worker)
+{
+	for(;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobQueued.wait(lock, [this]{ return m_stopping || !m_jobs.empty(); });
+			if(m_jobs.empty())
+			{
+				return;
+			}
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		std::vector<Commit> commits;
+		for(int analysis : job.analyses)
+		{
+			commits.push_back(m_analyses[analysis](job.sweep, m_snapshots[job.slot], worker));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_freeSlots.push_back(job.slot);
+			m_finished.emplace(job.sequence, std::move(commits));
+		}
+		m_slotFreed.notify_one();
+
+		commitInOrder();
+	}
+}
+
+void MeasurementPipeline::commitInOrder()
+{
+	std::lock_guard<std::mutex> commitLock(m_commitMutex);
+
+	for(;;)
+	{
+		std::vector<Commit> commits;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto next = m_finished.find(m_committedCount);
+			if(m_finished.end() == next)
+			{
+				return;
+			}
+
+			commits = std::move(next->second);
+			m_finished.erase(next);
+		}
+
+		// Only the thread holding the commit lock gets here, so the commits run in sequence order.
+		for(const auto &commit : commits)
+		{
+			commit();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_committedCount;
+		}
+		m_committed.notify_all();
+	}
+}
+
+void MeasurementPipeline::finish()
+{
+	if(m_workers.empty())
+	{
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_committed.wait(lock, [this]{ return m_committedCount == m_queuedCount; });
+		m_stopping = true;
+	}
+	m_jobQueued.notify_all();
+
+	for(auto &worker : m_workers)
+	{
+		worker.join();
+	}
+
+	// Anything submitted from now on is analysed inline.
+	m_workers.clear();
+}
+
+int MeasurementPipeline::getThreadCount() const
+{
+	return m_threadCount;
+}
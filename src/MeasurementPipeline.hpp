@@ -0,0 +1,163 @@
+#ifndef MeasurementPipeline_hpp
+#define MeasurementPipeline_hpp
+
+#include "SIRSArray.hpp"
+#include <functional>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ *\file
+ *\class MeasurementPipeline
+ *\brief Class that analyses snapshots of the lattice on a pool of threads while the sweeps carry on.
+ *
+ * On each measurement sweep the lattice is copied into one of a ring of snapshots, which reuse their
+ * memory so the copy is a straight memory copy, and queued for the analysis threads. The simulation
+ * only waits if every snapshot is still queued or being analysed.
+ *
+ * Each analysis is split in two. The expensive part runs on whichever thread picks up the snapshot
+ * and returns a Commit, the cheap part that adds the result to the totals or writes it out. Commits
+ * are run one at a time in the order the snapshots were submitted, so accumulators need no locking
+ * and the output is the same as measuring inline whatever the number of threads.
+ *
+ * With no threads every analysis and its commit run inline in submit, on the lattice itself.
+ */
+class MeasurementPipeline
+{
+public:
+	/// Work that has to be done in sweep order with the result of an analysis.
+	using Commit = std::function<void()>;
+
+	/// Analysis of a snapshot, the worker index lets each thread keep scratch space of its own, the
+	/// snapshot is reused once the analysis returns so the Commit must not refer to it.
+	using Analysis = std::function<Commit(int sweep, const SIRSArray &snapshot, int worker)>;
+
+private:
+	/**
+	 *\struct Job
+	 *\brief Struct describing a snapshot waiting to be analysed.
+	 */
+	struct Job
+	{
+		/// Position of the snapshot in the order of submission.
+		long long sequence;
+
+		/// Sweep the snapshot was taken on.
+		int sweep;
+
+		/// Index of the snapshot in the ring.
+		int slot;
+
+		/// Indices of the analyses due on this snapshot.
+		std::vector<int> analyses;
+	};
+
+	/// Member variable holding the analyses in the order they were added.
+	std::vector<Analysis> m_analyses;
+
+	/// Member variable holding how many submissions apart each analysis runs.
+	std::vector<int> m_strides;
+
+	/// Member variable counting the calls to submit.
+	long long m_submissionCount;
+
+	/// Member variable for the number of analysis threads, 0 to analyse inline.
+	int m_threadCount;
+
+	/// Member variable holding the ring of snapshots.
+	std::vector<SIRSArray> m_snapshots;
+
+	/// Member variable holding the indices of the snapshots that are free to be written.
+	std::vector<int> m_freeSlots;
+
+	/// Member variable holding the snapshots waiting for a thread.
+	std::deque<Job> m_jobs;
+
+	/// Member variable holding the commits of analysed snapshots that are waiting for earlier ones.
+	std::map<long long, std::vector<Commit> > m_finished;
+
+	/// Member variable counting the snapshots queued.
+	long long m_queuedCount;
+
+	/// Member variable counting the snapshots whose commits have run.
+	long long m_committedCount;
+
+	/// Member variable set once no more snapshots will be queued.
+	bool m_stopping;
+
+	/// Member variable holding the analysis threads.
+	std::vector<std::thread> m_workers;
+
+	/// Member variable guarding the queue, the free snapshots and the finished commits.
+	std::mutex m_mutex;
+
+	/// Member variable held while commits are run so they run one at a time.
+	std::mutex m_commitMutex;
+
+	/// Member variable signalled when a job is queued or the pipeline stops.
+	std::condition_variable m_jobQueued;
+
+	/// Member variable signalled when a snapshot is free again.
+	std::condition_variable m_slotFreed;
+
+	/// Member variable signalled when commits have run.
+	std::condition_variable m_committed;
+
+	/**
+	 *\brief Loop run by each analysis thread until the pipeline stops and the queue is empty.
+	 *\param worker integer index of the thread.
+	 */
+	void work(int worker);
+
+	/**
+	 *\brief Runs the commits of every finished snapshot that is next in order.
+	 */
+	void commitInOrder();
+
+public:
+	/**
+	 *\brief Constructor that starts the analysis threads.
+	 *\param threadCount integer value representing the number of analysis threads, 0 to analyse inline.
+	 *\param snapshotCount integer value representing the number of snapshots, 0 for two per thread.
+	 */
+	MeasurementPipeline(int threadCount, int snapshotCount = 0);
+
+	MeasurementPipeline(const MeasurementPipeline&) = delete;
+	MeasurementPipeline& operator=(const MeasurementPipeline&) = delete;
+
+	/**
+	 *\brief Destructor that waits for the snapshots already submitted.
+	 */
+	~MeasurementPipeline();
+
+	/**
+	 *\brief Adds an analysis, must be called before the first submit.
+	 *\param analysis Analysis to run.
+	 *\param stride integer value, the analysis runs on the first and every stride-th submission after it.
+	 */
+	void addAnalysis(Analysis analysis, int stride = 1);
+
+	/**
+	 *\brief Hands the lattice to the analyses due on this submission.
+	 *\param sweep integer value representing the sweep the lattice is from.
+	 *\param lattice constant SIRSArray reference, copied before the call returns.
+	 */
+	void submit(int sweep, const SIRSArray &lattice);
+
+	/**
+	 *\brief Waits until every submitted snapshot has been analysed and committed, then stops the threads.
+	 */
+	void finish();
+
+	/**
+	 *\brief Getter for the number of analysis threads.
+	 *\return Integer value representing the number of threads, 0 if analyses run inline.
+	 */
+	int getThreadCount() const;
+};
+
+#endif /* MeasurementPipeline_hpp */
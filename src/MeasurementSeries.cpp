@@ -0,0 +1,283 @@
+#include "MeasurementSeries.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <iomanip>
+
+namespace
+{
+	/**
+	 *\brief Running mean and sum of squared deviations, Welford's method.
+	 */
+	class RunningSpread
+	{
+	public:
+		int count = 0;
+		double mean = 0;
+		double squaredDeviations = 0;
+
+		void add(double value)
+		{
+			++count;
+			double delta = value - mean;
+			mean += delta / count;
+			squaredDeviations += delta * (value - mean);
+		}
+	};
+}
+
+MeasurementSeries::MeasurementSeries() :
+	m_columnNames{"Susceptible", "Infected", "Recovered", "Immune"},
+	m_columns(SIRSArray::MAXSTATE)
+{
+
+}
+
+int MeasurementSeries::addObservable(const std::string &name, Observable observable)
+{
+	m_columnNames.push_back(name);
+	m_columns.emplace_back();
+	m_columns.back().reserve(m_columns.front().capacity());
+	m_observables.push_back(observable);
+
+	return m_columns.size() - 1;
+}
+
+void MeasurementSeries::addEstimator(const std::string &name, Estimator estimator)
+{
+	m_estimatorNames.push_back(name);
+	m_estimators.push_back(estimator);
+}
+
+int MeasurementSeries::findColumn(const std::string &name) const
+{
+	for(std::size_t column = 0; column < m_columnNames.size(); ++column)
+	{
+		if(name == m_columnNames[column])
+		{
+			return column;
+		}
+	}
+
+	return -1;
+}
+
+void MeasurementSeries::reserve(int size)
+{
+	m_sweeps.reserve(size);
+	for(auto &column : m_columns)
+	{
+		column.reserve(size);
+	}
+}
+
+void MeasurementSeries::clear()
+{
+	m_sweeps.clear();
+	for(auto &column : m_columns)
+	{
+		column.clear();
+	}
+}
+
+MeasurementSeries::StateCounts MeasurementSeries::record(int sweep, const SIRSArray::StateVector &cells)
+{
+	// One scan of the cells gives every state count.
+	StateCounts counts = {};
+	for(const auto &state : cells)
+	{
+		++counts[state];
+	}
+
+	m_sweeps.push_back(sweep);
+	for(int state = 0; state < SIRSArray::MAXSTATE; ++state)
+	{
+		m_columns[state].push_back(counts[state]);
+	}
+
+	for(std::size_t n = 0; n < m_observables.size(); ++n)
+	{
+		m_columns[SIRSArray::MAXSTATE + n].push_back(m_observables[n](counts, cells));
+	}
+
+	return counts;
+}
+
+int MeasurementSeries::getSize() const
+{
+	return m_sweeps.size();
+}
+
+int MeasurementSeries::getColumnCount() const
+{
+	return m_columns.size();
+}
+
+const std::string& MeasurementSeries::getColumnName(int column) const
+{
+	return m_columnNames[column];
+}
+
+const std::vector<double>& MeasurementSeries::getColumn(int column) const
+{
+	return m_columns[column];
+}
+
+DataArray MeasurementSeries::columnData(int column) const
+{
+	DataArray data;
+	data.reserve(getSize());
+	for(const auto &value : m_columns[column])
+	{
+		data.push_back(value);
+	}
+
+	return data;
+}
+
+std::vector<MeasurementSeries::Estimate> MeasurementSeries::analyse(RandomStream &stream, int iterations) const
+{
+	const int sampleCount    = getSize();
+	const int columnCount    = getColumnCount();
+	const int estimatorCount = m_estimators.size();
+
+	std::vector<Estimate> estimates(estimatorCount);
+	for(int k = 0; k < estimatorCount; ++k)
+	{
+		estimates[k] = Estimate{m_estimatorNames[k], std::numeric_limits<double>::quiet_NaN(), 0.0, 0.0};
+	}
+
+	if(0 == sampleCount)
+	{
+		return estimates;
+	}
+
+	// Sums of every column and its square, each column is contiguous.
+	std::vector<double> sums(columnCount, 0.0);
+	std::vector<double> squareSums(columnCount, 0.0);
+	for(int c = 0; c < columnCount; ++c)
+	{
+		for(const auto &value : m_columns[c])
+		{
+			sums[c] += value;
+			squareSums[c] += value * value;
+		}
+	}
+
+	std::vector<double> means(columnCount);
+	std::vector<double> squareMeans(columnCount);
+	for(int c = 0; c < columnCount; ++c)
+	{
+		means[c] = sums[c] / sampleCount;
+		squareMeans[c] = squareSums[c] / sampleCount;
+	}
+
+	for(int k = 0; k < estimatorCount; ++k)
+	{
+		estimates[k].value = m_estimators[k](means.data(), squareMeans.data());
+	}
+
+	// Jackknife: the moments without sample i follow from the full sums, so every estimator is
+	// evaluated on every leave-one-out sample in a single pass.
+	if(sampleCount > 1)
+	{
+		std::vector<RunningSpread> spreads(estimatorCount);
+		for(int i = 0; i < sampleCount; ++i)
+		{
+			for(int c = 0; c < columnCount; ++c)
+			{
+				const double value = m_columns[c][i];
+				means[c] = (sums[c] - value) / (sampleCount - 1);
+				squareMeans[c] = (squareSums[c] - value * value) / (sampleCount - 1);
+			}
+
+			for(int k = 0; k < estimatorCount; ++k)
+			{
+				spreads[k].add(m_estimators[k](means.data(), squareMeans.data()));
+			}
+		}
+
+		// Same normalisation as jackKnife, sqrt(N * variance of the leave-one-out values).
+		for(int k = 0; k < estimatorCount; ++k)
+		{
+			estimates[k].jackKnifeError = std::sqrt(spreads[k].squaredDeviations);
+		}
+	}
+
+	// Bootstrap: each resample is drawn once and accumulated into every column together.
+	if(iterations > 0)
+	{
+		std::uniform_int_distribution<int> sampleDistribution(0, sampleCount - 1);
+		std::vector<RunningSpread> spreads(estimatorCount);
+		for(int iteration = 0; iteration < iterations; ++iteration)
+		{
+			std::fill(sums.begin(), sums.end(), 0.0);
+			std::fill(squareSums.begin(), squareSums.end(), 0.0);
+			for(int j = 0; j < sampleCount; ++j)
+			{
+				const int i = sampleDistribution(stream);
+				for(int c = 0; c < columnCount; ++c)
+				{
+					const double value = m_columns[c][i];
+					sums[c] += value;
+					squareSums[c] += value * value;
+				}
+			}
+
+			for(int c = 0; c < columnCount; ++c)
+			{
+				means[c] = sums[c] / sampleCount;
+				squareMeans[c] = squareSums[c] / sampleCount;
+			}
+
+			for(int k = 0; k < estimatorCount; ++k)
+			{
+				spreads[k].add(m_estimators[k](means.data(), squareMeans.data()));
+			}
+		}
+
+		for(int k = 0; k < estimatorCount; ++k)
+		{
+			estimates[k].bootstrapError = std::sqrt(spreads[k].squaredDeviations / iterations);
+		}
+	}
+
+	return estimates;
+}
+
+void MeasurementSeries::writeColumns(std::ostream &out) const
+{
+	out << "# sweep";
+	for(const auto &name : m_columnNames)
+	{
+		out << ' ' << name;
+	}
+	out << '\n';
+
+	for(int i = 0; i < getSize(); ++i)
+	{
+		out << m_sweeps[i];
+		for(const auto &column : m_columns)
+		{
+			out << ' ' << column[i];
+		}
+		out << '\n';
+	}
+}
+
+void MeasurementSeries::writeEstimates(std::ostream &out, const std::vector<Estimate> &estimates)
+{
+	int outputColumnWidth = 30;
+	out << "Observables..." << '\n';
+	for(const auto &estimate : estimates)
+	{
+		out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << estimate.name + ": " <<
+		std::right << estimate.value << " +/- " << estimate.jackKnifeError;
+		if(estimate.bootstrapError > 0)
+		{
+			out << " (bootstrap +/- " << estimate.bootstrapError << ")";
+		}
+		out << '\n';
+	}
+}
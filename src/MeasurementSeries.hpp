@@ -0,0 +1,187 @@
+#ifndef MeasurementSeries_hpp
+#define MeasurementSeries_hpp
+
+#include "SIRSArray.hpp"
+#include "DataArray.hpp"
+#include "RandomStream.hpp"
+#include <array>
+#include <vector>
+#include <string>
+#include <functional>
+#include <iostream>
+#include <cstdint>
+
+/**
+ *\file
+ *\class MeasurementSeries
+ *\brief Class that records every observable of a run in one pass per measurement and analyses them together.
+ *
+ * Each measurement counts the cells in each state with a single scan of the cells, then evaluates any
+ * user observables from those counts (and the cells, if they need them). Every observable has its own
+ * column, stored as a struct of arrays so the analysis streams through contiguous memory.
+ *
+ * Derived quantities are written as estimators, functions of the mean and square mean of every column.
+ * The jackknife then needs no resampled copies of the data: the leave-one-out means are
+ * (sum - x_i)/(N-1), so one pass over the measurements evaluates every estimator on every
+ * leave-one-out sample. The bootstrap draws each resample once and accumulates every column at the
+ * same time. Both therefore cost O(N) per estimator, against the O(N^2) of calling jackKnife on
+ * an IDataFunctor.
+ */
+class MeasurementSeries
+{
+public:
+	/// Number of cells in each state, indexed by SIRSArray::State.
+	using StateCounts = std::array<std::int64_t, SIRSArray::MAXSTATE>;
+
+	/// Observable recorded on each measurement from the state counts and the cells.
+	using Observable = std::function<double(const StateCounts &counts, const SIRSArray::StateVector &cells)>;
+
+	/// Derived quantity computed from the mean and square mean of every column, indexed by column.
+	using Estimator = std::function<double(const double *means, const double *squareMeans)>;
+
+	/**
+	 *\class Estimate
+	 *\brief Class holding the value of an estimator and its errors.
+	 */
+	class Estimate
+	{
+	public:
+		/// Name the estimator was added with.
+		std::string name;
+		/// Value of the estimator on the whole series.
+		double value;
+		/// Jackknife error of the estimator.
+		double jackKnifeError;
+		/// Bootstrap error of the estimator, 0 if no resamples were asked for.
+		double bootstrapError;
+	};
+
+private:
+	/// Member variable holding the name of each column, the first MAXSTATE are the state counts.
+	std::vector<std::string> m_columnNames;
+
+	/// Member variable holding the measurements of each column.
+	std::vector<std::vector<double> > m_columns;
+
+	/// Member variable holding the sweep each measurement was made on.
+	std::vector<int> m_sweeps;
+
+	/// Member variable holding the user observables, column MAXSTATE + n holds observable n.
+	std::vector<Observable> m_observables;
+
+	/// Member variable holding the name of each estimator.
+	std::vector<std::string> m_estimatorNames;
+
+	/// Member variable holding the estimators in the order they were added.
+	std::vector<Estimator> m_estimators;
+
+public:
+	/**
+	 *\brief Constructor for a series with the Susceptible, Infected, Recovered and Immune count columns.
+	 */
+	MeasurementSeries();
+
+	/**
+	 *\brief Adds a column recorded on every measurement.
+	 *\param name string holding the name of the column.
+	 *\param observable Observable evaluated on every measurement.
+	 *\return Integer value representing the index of the new column.
+	 *
+	 * Observables should be added before the first measurement so every column has the same length.
+	 */
+	int addObservable(const std::string &name, Observable observable);
+
+	/**
+	 *\brief Adds a derived quantity that analyse reports.
+	 *\param name string holding the name of the quantity.
+	 *\param estimator Estimator computing the quantity from the column moments.
+	 */
+	void addEstimator(const std::string &name, Estimator estimator);
+
+	/**
+	 *\brief Finds a column by name.
+	 *\param name string holding the name of the column.
+	 *\return Integer value representing the index of the column, -1 if there is none.
+	 */
+	int findColumn(const std::string &name) const;
+
+	/**
+	 *\brief Reserves space for a number of measurements in every column.
+	 *\param size integer value representing the number of measurements.
+	 */
+	void reserve(int size);
+
+	/**
+	 *\brief Removes every measurement, the observables and estimators are kept.
+	 */
+	void clear();
+
+	/**
+	 *\brief Records one measurement of every column.
+	 *\param sweep integer value representing the sweep the measurement is made on.
+	 *\param cells constant reference to the vector holding the state of every cell.
+	 *\return StateCounts holding the number of cells in each state.
+	 */
+	StateCounts record(int sweep, const SIRSArray::StateVector &cells);
+
+	/**
+	 *\brief Getter for the number of measurements recorded.
+	 *\return Integer value representing the number of measurements.
+	 */
+	int getSize() const;
+
+	/**
+	 *\brief Getter for the number of columns.
+	 *\return Integer value representing the number of columns.
+	 */
+	int getColumnCount() const;
+
+	/**
+	 *\brief Getter for the name of a column.
+	 *\param column integer value representing the index of the column.
+	 *\return constant string reference holding the name.
+	 */
+	const std::string& getColumnName(int column) const;
+
+	/**
+	 *\brief Getter for the measurements of a column.
+	 *\param column integer value representing the index of the column.
+	 *\return constant reference to the vector of measurements.
+	 */
+	const std::vector<double>& getColumn(int column) const;
+
+	/**
+	 *\brief Copies a column into a DataArray, e.g. for its blocking analysis.
+	 *\param column integer value representing the index of the column.
+	 *\return DataArray holding the measurements of the column.
+	 */
+	DataArray columnData(int column) const;
+
+	/**
+	 *\brief Evaluates every estimator with its jackknife and bootstrap errors.
+	 *\param stream RandomStream reference for the bootstrap resamples.
+	 *\param iterations integer value representing the number of bootstrap resamples, 0 for none.
+	 *\return vector of Estimate, one per estimator in the order they were added.
+	 *
+	 * The jackknife error follows jackKnife, sqrt(N) times the spread of the leave-one-out values,
+	 * with the spread accumulated by Welford's method so it cannot come out negative.
+	 */
+	std::vector<Estimate> analyse(RandomStream &stream, int iterations = 100) const;
+
+	/**
+	 *\brief Writes the sweep and every column of every measurement, one measurement per line.
+	 *\param out std::ostream reference to write to.
+	 *
+	 * The first line is a comment naming the columns.
+	 */
+	void writeColumns(std::ostream &out) const;
+
+	/**
+	 *\brief Writes estimates in the same layout as the results.
+	 *\param out std::ostream reference to write to.
+	 *\param estimates vector of Estimate returned by analyse.
+	 */
+	static void writeEstimates(std::ostream &out, const std::vector<Estimate> &estimates);
+};
+
+#endif /* MeasurementSeries_hpp */
@@ -0,0 +1,17 @@
+#include "Neighbourhood.hpp"
+
+NeighbourhoodType parseNeighbourhood(const std::string &name)
+{
+	if("von-neumann" == name)
+	{
+		return VonNeumannNeighbourhood;
+	}
+
+	if("moore" == name)
+	{
+		return MooreNeighbourhood;
+	}
+
+	// Let the caller decide how to report an unknown neighbourhood.
+	return MAXNEIGHBOURHOOD;
+}
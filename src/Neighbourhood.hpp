@@ -0,0 +1,82 @@
+#ifndef Neighbourhood_hpp
+#define Neighbourhood_hpp
+
+#include <string>
+
+/**
+ *\file
+ *\brief Compile-time stencils describing which cells count as neighbours in the SIRS model.
+ *
+ * Each stencil exposes its radius and a constexpr predicate saying whether the offset (dr,dc)
+ * belongs to it. The update kernels in SIRSArray are templated on these types so the loops over
+ * the offsets are fully unrolled and the predicate is folded away by the compiler.
+ */
+
+/**
+ *\enum NeighbourhoodType
+ *\brief Enumeration of the neighbourhood shapes that can be selected at runtime.
+ */
+enum NeighbourhoodType
+{
+    VonNeumannNeighbourhood,
+    MooreNeighbourhood,
+    MAXNEIGHBOURHOOD,
+};
+
+/// Largest neighbourhood radius that has a compiled update kernel.
+constexpr int maxNeighbourhoodRadius = 3;
+
+/**
+ *\class VonNeumann
+ *\brief Diamond shaped stencil, all cells with |dr| + |dc| <= R excluding the centre.
+ *
+ * With R = 1 this is the N,E,S,W neighbourhood used by the original SIRS model.
+ */
+template<int R>
+struct VonNeumann
+{
+    /// Largest offset along either axis.
+    static constexpr int radius = R;
+
+    /**
+     *\brief Determines whether an offset belongs to the stencil.
+     *\param dr row offset from the centre cell.
+     *\param dc column offset from the centre cell.
+     *\return Boolean value representing whether the offset is part of the neighbourhood.
+     */
+    static constexpr bool contains(int dr, int dc)
+    {
+        return !(0 == dr && 0 == dc) && (dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc) <= R;
+    }
+};
+
+/**
+ *\class Moore
+ *\brief Square stencil, all cells with max(|dr|,|dc|) <= R excluding the centre.
+ */
+template<int R>
+struct Moore
+{
+    /// Largest offset along either axis.
+    static constexpr int radius = R;
+
+    /**
+     *\brief Determines whether an offset belongs to the stencil.
+     *\param dr row offset from the centre cell.
+     *\param dc column offset from the centre cell.
+     *\return Boolean value representing whether the offset is part of the neighbourhood.
+     */
+    static constexpr bool contains(int dr, int dc)
+    {
+        return !(0 == dr && 0 == dc) && dr >= -R && dr <= R && dc >= -R && dc <= R;
+    }
+};
+
+/**
+ *\brief Converts the name of a neighbourhood given on the command line into its enumeration value.
+ *\param name string that is either "von-neumann" or "moore".
+ *\return NeighbourhoodType value, MAXNEIGHBOURHOOD if the name is not recognised.
+ */
+NeighbourhoodType parseNeighbourhood(const std::string &name);
+
+#endif /* Neighbourhood_hpp */
@@ -0,0 +1,165 @@
+#include "ParameterChain.hpp"
+#include "Simulation.hpp"
+#include <algorithm>
+#include <cmath>
+
+ParameterChain::ParameterChain(
+	const SIRSInputParameters &baseParameters,
+	RandomStream &generator,
+	int window,
+	int maxSweeps,
+	double tolerance
+	) : m_baseParameters(baseParameters),
+		m_generator(generator),
+		m_window{window},
+		m_maxSweeps{maxSweeps},
+		m_tolerance{tolerance}
+{
+
+}
+
+std::vector<std::pair<double, double> > ParameterChain::probabilityPath(int count)
+{
+	std::vector<std::pair<double, double> > path;
+	for(int i = 0; i <= count; ++i)
+	{
+		for(int n = 0; n <= count; ++n)
+		{
+			// Run p3 back down on every other column so consecutive points are always neighbours.
+			int j = (0 == i % 2) ? n : count - n;
+			path.push_back(std::make_pair(static_cast<double>(i)/count, static_cast<double>(j)/count));
+		}
+	}
+
+	return path;
+}
+
+std::vector<std::pair<double, double> > ParameterChain::immunityPath(double low, double high, int count)
+{
+	std::vector<std::pair<double, double> > path;
+	for(int i = 0; i <= count; ++i)
+	{
+		path.push_back(std::make_pair(low + (high - low) * i / count, 0.0));
+	}
+
+	return path;
+}
+
+std::vector<ParameterChain::ChainPoint> ParameterChain::follow(Axes axes, const std::vector<std::pair<double, double> > &path)
+{
+	std::vector<ChainPoint> points;
+	if(path.empty())
+	{
+		return points;
+	}
+
+	SIRSInputParameters parameters = m_baseParameters;
+	if(ProbabilityAxes == axes)
+	{
+		parameters.probSI = path.front().first;
+		parameters.probRS = path.front().second;
+	}
+	else
+	{
+		parameters.immuneFraction = path.front().first;
+	}
+
+	Simulation simulation(parameters, m_generator);
+	const SIRSArray::StateVector &cells = simulation.getStateData();
+
+	for(std::size_t n = 0; n < path.size(); ++n)
+	{
+		if(n > 0)
+		{
+			if(ProbabilityAxes == axes)
+			{
+				simulation.setProbabilities(path[n].first, parameters.probIR, path[n].second);
+			}
+			else
+			{
+				simulation.setImmuneFraction(path[n].first);
+			}
+		}
+
+		// Once the infection has died out no amount of sweeping brings it back, so start again from a
+		// random lattice and give it the full burn period, cut short only if it dies out again.
+		bool coldStart = (0 == n) || (cells.end() == std::find(cells.begin(), cells.end(), SIRSArray::Infected));
+		if(coldStart && n > 0)
+		{
+			simulation.randomise();
+		}
+
+		int burnSweeps = coldStart ?
+			simulation.equilibrate(m_window, parameters.burnPeriod, 0.0) :
+			simulation.equilibrate(m_window, m_maxSweeps, m_tolerance);
+
+		points.push_back(ChainPoint{path[n].first, path[n].second, burnSweeps, coldStart, simulation.run(0)});
+	}
+
+	return points;
+}
+
+ParameterChain::Hysteresis ParameterChain::compare(const std::vector<ChainPoint> &forward, const std::vector<ChainPoint> &backward)
+{
+	Hysteresis hysteresis{0.0, 0.0, 0};
+
+	const std::size_t count = std::min(forward.size(), backward.size());
+	for(std::size_t n = 0; n < count; ++n)
+	{
+		// The backward path visits the same points in the opposite order.
+		const SIRSResults &ahead  = forward[n].results;
+		const SIRSResults &behind = backward[backward.size() - 1 - n].results;
+
+		double difference = std::abs(ahead.orderParameter - behind.orderParameter);
+		double error = std::sqrt(ahead.orderParameterError * ahead.orderParameterError + behind.orderParameterError * behind.orderParameterError);
+		double deviation = (error > 0) ? difference / error : 0.0;
+
+		hysteresis.maxDifference = std::max(hysteresis.maxDifference, difference);
+		hysteresis.maxDeviation = std::max(hysteresis.maxDeviation, deviation);
+		if(deviation > 3)
+		{
+			++hysteresis.significantCount;
+		}
+	}
+
+	return hysteresis;
+}
+
+std::vector<AdaptiveScan::ScanPoint> ParameterChain::toScanPoints(const std::vector<ChainPoint> &points)
+{
+	std::vector<AdaptiveScan::ScanPoint> scanPoints;
+	for(const auto &point : points)
+	{
+		scanPoints.push_back(AdaptiveScan::ScanPoint{point.x, point.y, point.results});
+	}
+
+	std::sort(scanPoints.begin(), scanPoints.end(), [](const AdaptiveScan::ScanPoint &a, const AdaptiveScan::ScanPoint &b)
+	{
+		return (a.x < b.x) || (a.x == b.x && a.y < b.y);
+	});
+
+	return scanPoints;
+}
+
+void ParameterChain::writePath(std::ostream &out, const std::vector<ChainPoint> &points)
+{
+	for(const auto &point : points)
+	{
+		out << point.x << ' ' << point.y << ' ' << point.burnSweeps << ' ' << point.coldStart << ' ' <<
+		point.results.orderParameter << ' ' << point.results.orderParameterError << '\n';
+	}
+}
+
+void ParameterChain::writeHysteresis(std::ostream &out, const std::vector<ChainPoint> &forward, const std::vector<ChainPoint> &backward)
+{
+	const std::size_t count = std::min(forward.size(), backward.size());
+	for(std::size_t n = 0; n < count; ++n)
+	{
+		const ChainPoint &ahead  = forward[n];
+		const ChainPoint &behind = backward[backward.size() - 1 - n];
+
+		out << ahead.x << ' ' << ahead.y << ' ' <<
+		ahead.results.orderParameter << ' ' << ahead.results.orderParameterError << ' ' <<
+		behind.results.orderParameter << ' ' << behind.results.orderParameterError << '\n';
+	}
+}
@@ -0,0 +1,163 @@
+#ifndef ParameterChain_hpp
+#define ParameterChain_hpp
+
+#include "SIRSInputParameters.hpp"
+#include "SIRSResults.hpp"
+#include "AdaptiveScan.hpp"
+#include "RandomStream.hpp"
+#include <random>
+#include <vector>
+#include <utility>
+#include <iostream>
+
+/**
+ *\file
+ *\class ParameterChain
+ *\brief Class for scanning the phase diagram along a path with one lattice that is never thrown away.
+ *
+ * Neighbouring points of a scan have nearby steady states, so rather than building a fresh random
+ * lattice and burning it in at every point, the chain changes the probabilities or the immune fraction
+ * of the lattice it already has and re-equilibrates with Simulation::equilibrate, which stops as soon
+ * as the infected fraction stops drifting. Only the first point, and any point reached after the
+ * infection has died out, start from a random lattice with the full burn period.
+ *
+ * Following the same path in both directions shows whether the steady state depends on where the
+ * lattice came from, which is also the check that the short re-equilibration is long enough.
+ */
+class ParameterChain
+{
+public:
+	/**
+	 * \enum Axes
+	 * \brief Enumeration of the parameters a path moves through.
+	 */
+	enum Axes
+	{
+		ProbabilityAxes, ///< x is p1 and y is p3.
+		ImmunityAxis,    ///< x is the immune fraction, y is unused.
+	};
+
+	/**
+	 *\class ChainPoint
+	 *\brief Class holding a point of the path, how it was equilibrated and its results.
+	 */
+	class ChainPoint
+	{
+	public:
+		/// First coordinate, p1 or the immune fraction.
+		double x;
+		/// Second coordinate, p3 or unused for the immunity axis.
+		double y;
+		/// Number of sweeps made before measuring.
+		int burnSweeps;
+		/// Whether the lattice was randomised before this point.
+		bool coldStart;
+		/// Results at this point.
+		SIRSResults results;
+	};
+
+	/**
+	 *\class Hysteresis
+	 *\brief Class summarising the differences between a path followed in both directions.
+	 */
+	class Hysteresis
+	{
+	public:
+		/// Largest difference between the order parameters in units of their combined error.
+		double maxDeviation;
+		/// Largest absolute difference between the order parameters.
+		double maxDifference;
+		/// Number of points whose order parameters differ by more than three combined errors.
+		int significantCount;
+	};
+
+private:
+	/// Member variable holding the parameters that are not being changed along the path.
+	SIRSInputParameters m_baseParameters;
+
+	/// Member variable for the generator shared by every simulation of the chain.
+	RandomStream &m_generator;
+
+	/// Member variable for the number of sweeps averaged over in each re-equilibration window.
+	int m_window;
+
+	/// Member variable for the most sweeps a re-equilibration can make.
+	int m_maxSweeps;
+
+	/// Member variable for the drift in infected fraction between windows that counts as equilibrated.
+	double m_tolerance;
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param baseParameters SIRSInputParameters reference for all parameters that are not changed, its burn period is used for cold starts.
+	 *\param generator RandomStream reference for random number generation, must outlive the chain.
+	 *\param window integer value representing the number of sweeps in each re-equilibration window.
+	 *\param maxSweeps integer value representing the most sweeps a re-equilibration can make.
+	 *\param tolerance floating point value representing the drift in infected fraction that counts as equilibrated.
+	 */
+	ParameterChain(
+		const SIRSInputParameters &baseParameters,
+		RandomStream &generator,
+		int window = 100,
+		int maxSweeps = 2000,
+		double tolerance = 0.002);
+
+	/**
+	 *\brief Builds a path through the p1-p3 plane that only ever steps to a neighbouring grid point.
+	 *\param count integer value representing the number of intervals along each axis of [0,1]x[0,1].
+	 *\return vector of (p1,p3) pairs, p3 runs up and down alternately for each p1.
+	 */
+	static std::vector<std::pair<double, double> > probabilityPath(int count);
+
+	/**
+	 *\brief Builds a path of evenly spaced immune fractions.
+	 *\param low floating point value representing the first immune fraction.
+	 *\param high floating point value representing the last immune fraction.
+	 *\param count integer value representing the number of intervals between them.
+	 *\return vector of (immune fraction, 0) pairs.
+	 */
+	static std::vector<std::pair<double, double> > immunityPath(double low, double high, int count);
+
+	/**
+	 *\brief Follows a path with a single simulation.
+	 *\param axes Axes the path coordinates refer to.
+	 *\param path vector of coordinate pairs in the order they are visited.
+	 *\return vector of ChainPoint instances in the order they were visited.
+	 *
+	 * Throws std::invalid_argument if the base parameters do not describe a valid simulation.
+	 */
+	std::vector<ChainPoint> follow(Axes axes, const std::vector<std::pair<double, double> > &path);
+
+	/**
+	 *\brief Compares the results of a path with those of the same path followed backwards.
+	 *\param forward vector of ChainPoint instances from the path.
+	 *\param backward vector of ChainPoint instances from the reversed path.
+	 *\return Hysteresis instance summarising the differences.
+	 */
+	static Hysteresis compare(const std::vector<ChainPoint> &forward, const std::vector<ChainPoint> &backward);
+
+	/**
+	 *\brief Converts chain points to scan points sorted by x then y so they can be written like a scan.
+	 *\param points vector of ChainPoint instances.
+	 *\return vector of AdaptiveScan::ScanPoint instances.
+	 */
+	static std::vector<AdaptiveScan::ScanPoint> toScanPoints(const std::vector<ChainPoint> &points);
+
+	/**
+	 *\brief Outputs the points in the order they were visited, lines of "x y burn-sweeps cold order error".
+	 *\param out std::ostream reference to write to.
+	 *\param points vector of ChainPoint instances.
+	 */
+	static void writePath(std::ostream &out, const std::vector<ChainPoint> &points);
+
+	/**
+	 *\brief Outputs both directions of a path side by side, lines of "x y forward error backward error".
+	 *\param out std::ostream reference to write to.
+	 *\param forward vector of ChainPoint instances from the path.
+	 *\param backward vector of ChainPoint instances from the reversed path.
+	 */
+	static void writeHysteresis(std::ostream &out, const std::vector<ChainPoint> &forward, const std::vector<ChainPoint> &backward);
+};
+
+#endif /* ParameterChain_hpp */
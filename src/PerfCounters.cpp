@@ -0,0 +1,219 @@
+#include "PerfCounters.hpp"
+#include <iomanip>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace
+{
+	/// Names of the phases as they appear in the report.
+	const char *phaseNames[PerfCounters::MAXPHASE] = {"Burn", "Sweep", "Analysis"};
+
+	/// Names of the events as they appear in the report.
+	const char *eventNames[PerfCounters::MAXEVENT] = {"Cycles", "Instructions", "Cache-Misses", "Branch-Misses", "TLB-Misses"};
+
+	/**
+	 *\brief Opens a counter for the calling thread and any threads it starts afterwards.
+	 *\param type perf_event type of the event.
+	 *\param config perf_event config of the event.
+	 *\return file descriptor of the counter, -1 with errno set on failure.
+	 */
+	int openCounter(std::uint32_t type, std::uint64_t config)
+	{
+		perf_event_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = type;
+		attributes.config = config;
+		attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attributes.inherit = 1;
+
+		// User space only, which is all the update loop is and all most paranoid settings allow.
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+
+		return syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+	}
+}
+
+PerfCounters::PerfCounters() : m_updates{0, 0, 0}, m_phase{MAXPHASE}
+{
+	const std::uint32_t types[MAXEVENT] =
+	{
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HW_CACHE,
+	};
+
+	const std::uint64_t configs[MAXEVENT] =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+		PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+	};
+
+	int error = 0;
+	for(int event = 0; event < MAXEVENT; ++event)
+	{
+		m_descriptors[event] = openCounter(types[event], configs[event]);
+		if(m_descriptors[event] < 0)
+		{
+			error = errno;
+		}
+
+		m_lastCounts[event] = 0;
+		for(int phase = 0; phase < MAXPHASE; ++phase)
+		{
+			m_counts[phase][event] = 0;
+		}
+	}
+
+	if(!isAvailable())
+	{
+		m_unavailableReason = std::string("perf_event_open, ") + std::strerror(error);
+	}
+}
+
+PerfCounters::~PerfCounters()
+{
+	for(int event = 0; event < MAXEVENT; ++event)
+	{
+		if(m_descriptors[event] >= 0)
+		{
+			close(m_descriptors[event]);
+		}
+	}
+}
+
+void PerfCounters::accumulate()
+{
+	for(int event = 0; event < MAXEVENT; ++event)
+	{
+		if(m_descriptors[event] < 0)
+		{
+			continue;
+		}
+
+		// Value, time enabled and time running.
+		std::uint64_t values[3];
+		if(sizeof(values) != read(m_descriptors[event], values, sizeof(values)))
+		{
+			continue;
+		}
+
+		// Scale up a multiplexed counter to the whole time it was enabled.
+		double count = (values[2] > 0) ? static_cast<double>(values[0]) * values[1] / values[2] : 0.0;
+		if(MAXPHASE != m_phase)
+		{
+			m_counts[m_phase][event] += count - m_lastCounts[event];
+		}
+		m_lastCounts[event] = count;
+	}
+}
+
+void PerfCounters::enter(Phase phase)
+{
+	if(phase == m_phase || !isAvailable())
+	{
+		return;
+	}
+
+	accumulate();
+	m_phase = phase;
+}
+
+void PerfCounters::leave()
+{
+	enter(MAXPHASE);
+}
+
+void PerfCounters::addUpdates(Phase phase, long long updates)
+{
+	m_updates[phase] += updates;
+}
+
+bool PerfCounters::isAvailable() const
+{
+	for(int event = 0; event < MAXEVENT; ++event)
+	{
+		if(m_descriptors[event] >= 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool PerfCounters::isCounting(Event event) const
+{
+	return m_descriptors[event] >= 0;
+}
+
+double PerfCounters::getCount(Phase phase, Event event) const
+{
+	return m_counts[phase][event];
+}
+
+long long PerfCounters::getUpdates(Phase phase) const
+{
+	return m_updates[phase];
+}
+
+std::ostream& operator<<(std::ostream &out, const PerfCounters &counters)
+{
+	int outputColumnWidth = 30;
+	out << "Counters..." << '\n';
+
+	if(!counters.isAvailable())
+	{
+		out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Unavailable: " <<
+		std::right << counters.m_unavailableReason << '\n';
+		return out;
+	}
+
+	for(int phase = 0; phase < PerfCounters::MAXPHASE; ++phase)
+	{
+		// The analysis makes no updates of its own, it is charged to the updates it measured.
+		long long updates = counters.m_updates[PerfCounters::AnalysisPhase == phase ? PerfCounters::SweepPhase : phase];
+		if(0 == updates)
+		{
+			continue;
+		}
+
+		if(PerfCounters::AnalysisPhase != phase)
+		{
+			out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << std::string(phaseNames[phase]) + "-Updates: " <<
+			std::right << updates << '\n';
+		}
+		else
+		{
+			out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Analysis-Covers: " <<
+			std::right << "measurements, sweep callback and statistics, per sweep update" << '\n';
+		}
+
+		for(int event = 0; event < PerfCounters::MAXEVENT; ++event)
+		{
+			if(counters.m_descriptors[event] >= 0)
+			{
+				out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << std::string(phaseNames[phase]) + "-" + eventNames[event] + "/Update: " <<
+				std::right << counters.m_counts[phase][event] / updates << '\n';
+			}
+		}
+
+		if(counters.isCounting(PerfCounters::Cycles) && counters.isCounting(PerfCounters::Instructions) && counters.m_counts[phase][PerfCounters::Cycles] > 0)
+		{
+			out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << std::string(phaseNames[phase]) + "-Instructions/Cycle: " <<
+			std::right << counters.m_counts[phase][PerfCounters::Instructions] / counters.m_counts[phase][PerfCounters::Cycles] << '\n';
+		}
+	}
+
+	return out;
+}
@@ -0,0 +1,148 @@
+#ifndef PerfCounters_hpp
+#define PerfCounters_hpp
+
+#include <iostream>
+#include <string>
+
+/**
+ *\file
+ *\class PerfCounters
+ *\brief Class for counting hardware events in each phase of a run with Linux perf_event counters.
+ *
+ * One counter is opened for each event on the calling thread with inherit set, so threads started
+ * after the counters are opened, such as those of parallelFor and the analysis threads, are counted
+ * with it. The counters run for the whole life of the object and are read whenever the phase
+ * changes, the difference since the last read is added to the phase that was running. Events the
+ * kernel multiplexes are scaled up by the fraction of the time they were counting.
+ *
+ * Counters are often unavailable, in containers, virtual machines without a virtual PMU or when
+ * perf_event_paranoid forbids them. Any event that cannot be opened is left out of the report and
+ * if none can be opened the report says why instead, the run itself is unaffected.
+ */
+class PerfCounters
+{
+public:
+	/**
+	 * \enum Phase
+	 * \brief Enumeration of the phases events are attributed to.
+	 */
+	enum Phase
+	{
+		BurnPhase,     ///< Sweeps before the first measurement.
+		SweepPhase,    ///< Sweeps after the first measurement.
+		AnalysisPhase, ///< Measurements, callbacks and the statistics at the end.
+		MAXPHASE,
+	};
+
+	/**
+	 * \enum Event
+	 * \brief Enumeration of the hardware events counted.
+	 */
+	enum Event
+	{
+		Cycles,       ///< CPU cycles.
+		Instructions, ///< Instructions retired.
+		CacheMisses,  ///< Last level cache misses.
+		BranchMisses, ///< Mispredicted branches.
+		TLBMisses,    ///< Data TLB read misses.
+		MAXEVENT,
+	};
+
+private:
+	/// Member variable holding the file descriptor of each event, -1 if it could not be opened.
+	int m_descriptors[MAXEVENT];
+
+	/// Member variable holding the scaled count of each event at the last read.
+	double m_lastCounts[MAXEVENT];
+
+	/// Member variable holding the count of each event in each phase.
+	double m_counts[MAXPHASE][MAXEVENT];
+
+	/// Member variable holding the number of cell updates made in each phase.
+	long long m_updates[MAXPHASE];
+
+	/// Member variable for the phase that is running, MAXPHASE if none is.
+	Phase m_phase;
+
+	/// Member variable holding why no counter could be opened, empty if any could.
+	std::string m_unavailableReason;
+
+	/**
+	 *\brief Reads every open counter and adds the counts since the last read to the running phase.
+	 */
+	void accumulate();
+
+public:
+	/**
+	 *\brief Constructor that opens and starts the counters, no phase is running until enter is called.
+	 */
+	PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/**
+	 *\brief Destructor that closes the counters.
+	 */
+	~PerfCounters();
+
+	/**
+	 *\brief Attributes the events from now on to a phase, does nothing if the phase is already running.
+	 *\param phase Phase to enter.
+	 */
+	void enter(Phase phase);
+
+	/**
+	 *\brief Stops attributing events to any phase.
+	 */
+	void leave();
+
+	/**
+	 *\brief Adds to the number of cell updates made in a phase.
+	 *\param phase Phase the updates were made in.
+	 *\param updates number of cell updates.
+	 */
+	void addUpdates(Phase phase, long long updates);
+
+	/**
+	 *\brief Checks whether any counter could be opened.
+	 *\return bool true if at least one event is being counted.
+	 */
+	bool isAvailable() const;
+
+	/**
+	 *\brief Checks whether a single event is being counted.
+	 *\param event Event to check.
+	 *\return bool true if the counter for the event is open.
+	 */
+	bool isCounting(Event event) const;
+
+	/**
+	 *\brief Getter for the count of an event in a phase.
+	 *\param phase Phase to get the count for.
+	 *\param event Event to get the count for.
+	 *\return Floating point value, scaled if the counter was multiplexed.
+	 */
+	double getCount(Phase phase, Event event) const;
+
+	/**
+	 *\brief Getter for the number of cell updates made in a phase.
+	 *\param phase Phase to get the updates for.
+	 *\return number of cell updates.
+	 */
+	long long getUpdates(Phase phase) const;
+
+	/**
+	 *\brief operator<< overload for outputting the events per update of each phase.
+	 *\param out std::ostream reference that is being streamed to.
+	 *\param counters constant PerfCounters reference to be output.
+	 *\return std::ostream reference so the operator can be chained.
+	 *
+	 * Burn and sweep events are per update made in that phase. Analysis events cover the measurements,
+	 * the sweep callback and the statistics at the end, and are given per update of the sweep phase since
+	 * the analysis makes none of its own. The instructions per cycle of each phase are given too.
+	 */
+	friend std::ostream& operator<<(std::ostream &out, const PerfCounters &counters);
+};
+
+#endif /* PerfCounters_hpp */
@@ -0,0 +1,90 @@
+#ifndef Philox_hpp
+#define Philox_hpp
+
+#include <array>
+#include <cstdint>
+
+/**
+ *\file
+ *\brief Counter-based pseudo random number generation with the Philox4x32-10 bijection.
+ *
+ * Philox (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11) maps a 128 bit counter
+ * and a 64 bit key to 128 random bits. Since the output is a pure function of (counter, key) any thread
+ * can generate the numbers for any part of a computation without communicating, and the result does
+ * not depend on how the work was split between threads.
+ */
+
+/// Four 32 bit words, used for both the counter and the output of philox4x32.
+using PhiloxBlock = std::array<std::uint32_t, 4>;
+
+/**
+ *\brief Applies the ten round Philox4x32 bijection to a counter.
+ *\param counter PhiloxBlock holding the 128 bit counter.
+ *\param key 64 bit key, usually the seed.
+ *\return PhiloxBlock holding 128 random bits.
+ */
+inline PhiloxBlock philox4x32(PhiloxBlock counter, std::uint64_t key)
+{
+	std::uint32_t key0 = static_cast<std::uint32_t>(key);
+	std::uint32_t key1 = static_cast<std::uint32_t>(key >> 32);
+
+	for(int round = 0; round < 10; ++round)
+	{
+		std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+		std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+
+		counter = PhiloxBlock
+		{{
+			static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key0,
+			static_cast<std::uint32_t>(product1),
+			static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key1,
+			static_cast<std::uint32_t>(product0),
+		}};
+
+		key0 += 0x9E3779B9u;
+		key1 += 0xBB67AE85u;
+	}
+
+	return counter;
+}
+
+/**
+ *\brief Builds a counter from a 64 bit index and a 64 bit domain tag.
+ *\param index 64 bit value placed in the low words.
+ *\param domain 64 bit value placed in the high words, used to separate independent uses of one key.
+ *\return PhiloxBlock holding the counter.
+ */
+inline PhiloxBlock philoxCounter(std::uint64_t index, std::uint64_t domain)
+{
+	return PhiloxBlock
+	{{
+		static_cast<std::uint32_t>(index),
+		static_cast<std::uint32_t>(index >> 32),
+		static_cast<std::uint32_t>(domain),
+		static_cast<std::uint32_t>(domain >> 32),
+	}};
+}
+
+/**
+ *\brief Maps 32 random bits to an integer in [0,range) by multiplication rather than modulo.
+ *\param bits 32 bit random value.
+ *\param range 32 bit exclusive upper bound.
+ *\return 32 bit value in [0,range).
+ */
+inline std::uint32_t philoxBounded(std::uint32_t bits, std::uint32_t range)
+{
+	return static_cast<std::uint32_t>((static_cast<std::uint64_t>(bits) * range) >> 32);
+}
+
+/**
+ *\brief Maps 64 random bits to an integer in [0,range) by multiplication rather than modulo.
+ *\param bits 64 bit random value.
+ *\param range 64 bit exclusive upper bound.
+ *\return 64 bit value in [0,range).
+ */
+inline std::uint64_t philoxBounded(std::uint64_t bits, std::uint64_t range)
+{
+	return static_cast<std::uint64_t>((static_cast<unsigned __int128>(bits) * range) >> 64);
+}
+
+#endif /* Philox_hpp */
@@ -0,0 +1,55 @@
+#include "RandomStream.hpp"
+
+constexpr std::uint64_t RandomStream::replicaLimit;
+
+RandomStream::RandomStream(
+	std::uint64_t seed,
+	std::uint64_t streamId
+	) : m_seed{seed},
+		m_streamId{streamId},
+		m_position{0},
+		m_buffered{0},
+		m_hasBuffered{false}
+{
+
+}
+
+std::uint64_t RandomStream::makeStreamId(Purpose purpose, std::uint64_t replica, std::uint64_t index)
+{
+	return (static_cast<std::uint64_t>(purpose) << 56) |
+		   ((replica & (replicaLimit - 1)) << 40) |
+		   (index & 0xFFFFFFFFFFu);
+}
+
+RandomStream RandomStream::split(std::uint64_t streamId) const
+{
+	return RandomStream(m_seed, streamId);
+}
+
+void RandomStream::jump(std::uint64_t blocks)
+{
+	m_position += blocks;
+	m_hasBuffered = false;
+}
+
+void RandomStream::discard(unsigned long long count)
+{
+	// Use up the buffered half first so the remaining count is a whole number of blocks plus at most one.
+	if(count > 0 && m_hasBuffered)
+	{
+		m_hasBuffered = false;
+		--count;
+	}
+
+	m_position += count / 2;
+	if(count % 2)
+	{
+		(*this)();
+	}
+}
+
+double RandomStream::uniform()
+{
+	// Use the top 53 bits so every representable value is equally likely.
+	return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,149 @@
+#ifndef RandomStream_hpp
+#define RandomStream_hpp
+
+#include "Philox.hpp"
+#include <cstdint>
+#include <limits>
+
+/**
+ *\file
+ *\class RandomStream
+ *\brief Seedable, splittable stream of random numbers built on the Philox counter-based generator.
+ *
+ * A stream is identified by a seed, used as the Philox key, and a 64 bit stream id, used as the high half
+ * of the counter. The low half of the counter is the position in the stream, so every (stream id,
+ * position) pair is a distinct input to a bijection and two streams with different ids can never produce
+ * overlapping sequences for the same seed. Jumping ahead is just moving the position.
+ *
+ * Stream ids are built with makeStreamId from the purpose of the stream, the replica it belongs to and an
+ * index such as a thread, tile or step, so that every consumer in a run gets its own id. The class meets
+ * the UniformRandomBitGenerator requirements and can be used with the standard distributions.
+ */
+class RandomStream
+{
+public:
+	/// Type of the numbers produced by operator().
+	using result_type = std::uint64_t;
+
+	/**
+	 * \enum Purpose
+	 * \brief Enumeration of the different consumers of random numbers, stored in the top byte of a stream id.
+	 */
+	enum Purpose
+	{
+		MainPurpose,
+		TauLeapPurpose,
+		BootstrapPurpose,
+		ReplicaPurpose,
+		SitePurpose,
+		MAXPURPOSE,
+	};
+
+	/// Number of replicas whose streams are distinct, the replica is stored in 16 bits of a stream id.
+	static constexpr std::uint64_t replicaLimit = 0x10000;
+
+private:
+	/// Member variable for the seed, used as the Philox key.
+	std::uint64_t m_seed;
+
+	/// Member variable for the stream id, the high half of the Philox counter.
+	std::uint64_t m_streamId;
+
+	/// Member variable for the index of the next Philox block, the low half of the Philox counter.
+	std::uint64_t m_position;
+
+	/// Member variable holding the second half of the current block if it has not been used yet.
+	std::uint64_t m_buffered;
+
+	/// Member variable for whether m_buffered holds an unused number.
+	bool m_hasBuffered;
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param seed 64 bit seed of the run.
+	 *\param streamId 64 bit id of the stream, see makeStreamId.
+	 */
+	RandomStream(std::uint64_t seed = 0, std::uint64_t streamId = 0);
+
+	/**
+	 *\brief Builds a stream id from its parts.
+	 *\param purpose Purpose of the stream, stored in the top 8 bits.
+	 *\param replica integer value for the replica the stream belongs to, below replicaLimit, stored in the next 16 bits.
+	 *\param index integer value such as a thread, tile or step, stored in the low 40 bits.
+	 *\return 64 bit stream id, distinct for distinct in range arguments.
+	 */
+	static std::uint64_t makeStreamId(Purpose purpose, std::uint64_t replica, std::uint64_t index);
+
+	/**
+	 *\brief Creates a stream that shares the seed but has a different id.
+	 *\param streamId 64 bit id of the new stream.
+	 *\return RandomStream positioned at the start of the new stream.
+	 */
+	RandomStream split(std::uint64_t streamId) const;
+
+	/**
+	 *\brief Moves the stream forward by a number of Philox blocks, each of which holds two numbers.
+	 *\param blocks 64 bit number of blocks to skip.
+	 *
+	 * Any unused half of the current block is discarded so that the position after a jump only depends
+	 * on the number of blocks, which lets threads start at fixed offsets into a shared stream.
+	 */
+	void jump(std::uint64_t blocks);
+
+	/**
+	 *\brief Moves the stream forward by a number of outputs, as required of a random number engine.
+	 *\param count 64 bit number of outputs to skip.
+	 */
+	void discard(unsigned long long count);
+
+	/**
+	 *\brief Produces the next random number.
+	 *\return 64 random bits.
+	 *
+	 * Defined in the header since the exact update kernels call it for every draw.
+	 */
+	result_type operator()();
+
+	/**
+	 *\brief Produces a uniformly distributed floating point number.
+	 *\return floating point value in [0,1) with 53 random bits.
+	 */
+	double uniform();
+
+	/**
+	 *\brief Smallest value operator() can return.
+	 *\return 0.
+	 */
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	/**
+	 *\brief Largest value operator() can return.
+	 *\return 2^64 - 1.
+	 */
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+};
+
+inline RandomStream::result_type RandomStream::operator()()
+{
+	if(m_hasBuffered)
+	{
+		m_hasBuffered = false;
+		return m_buffered;
+	}
+
+	PhiloxBlock bits = philox4x32(philoxCounter(m_position++, m_streamId), m_seed);
+
+	m_buffered = (static_cast<std::uint64_t>(bits[3]) << 32) | bits[2];
+	m_hasBuffered = true;
+
+	return (static_cast<std::uint64_t>(bits[1]) << 32) | bits[0];
+}
+
+#endif /* RandomStream_hpp */
@@ -0,0 +1,270 @@
+#include "RegionMap.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+constexpr int RegionMap::maxRegions;
+
+namespace
+{
+	/// First eight bytes of every map file.
+	const char mapMagic[8] = {'S', 'I', 'R', 'S', 'M', 'A', 'P', '1'};
+
+	/**
+	 *\brief Reads a little-endian unsigned 32 bit value.
+	 */
+	bool readUint32(std::istream &in, std::uint32_t &value)
+	{
+		unsigned char bytes[4];
+		if(!in.read(reinterpret_cast<char*>(bytes), 4))
+		{
+			return false;
+		}
+
+		value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+		return true;
+	}
+
+	/**
+	 *\brief Writes a little-endian unsigned 32 bit value.
+	 */
+	void writeUint32(std::ostream &out, std::uint32_t value)
+	{
+		unsigned char bytes[4] = {
+			static_cast<unsigned char>(value),
+			static_cast<unsigned char>(value >> 8),
+			static_cast<unsigned char>(value >> 16),
+			static_cast<unsigned char>(value >> 24)};
+		out.write(reinterpret_cast<const char*>(bytes), 4);
+	}
+
+	/**
+	 *\brief Reads a little-endian IEEE double.
+	 */
+	bool readDouble(std::istream &in, double &value)
+	{
+		std::uint32_t low, high;
+		if(!readUint32(in, low) || !readUint32(in, high))
+		{
+			return false;
+		}
+
+		std::uint64_t bits = (static_cast<std::uint64_t>(high) << 32) | low;
+		std::memcpy(&value, &bits, sizeof(value));
+		return true;
+	}
+
+	/**
+	 *\brief Writes a little-endian IEEE double.
+	 */
+	void writeDouble(std::ostream &out, double value)
+	{
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		writeUint32(out, static_cast<std::uint32_t>(bits));
+		writeUint32(out, static_cast<std::uint32_t>(bits >> 32));
+	}
+}
+
+RegionMap::RegionMap(
+	int rows,
+	int cols,
+	const std::vector<Probabilities> &table
+	) : m_rowCount{rows},
+		m_colCount{cols},
+		m_table(table),
+		m_regionData(rows * cols, 0)
+{
+	if(m_table.empty() || static_cast<int>(m_table.size()) > maxRegions)
+	{
+		throw std::invalid_argument("A region map needs between 1 and " + std::to_string(maxRegions) + " regions");
+	}
+
+	// The kernels compare against these directly, written this way round NaN is rejected too.
+	auto isProbability = [](double probability)
+	{
+		return probability >= 0.0 && probability <= 1.0;
+	};
+
+	for(std::size_t region = 0; region < m_table.size(); ++region)
+	{
+		const Probabilities &probabilities = m_table[region];
+		if(!isProbability(probabilities.probSI) || !isProbability(probabilities.probIR) || !isProbability(probabilities.probRS))
+		{
+			throw std::invalid_argument("The probabilities of region " + std::to_string(region) + " must be between 0 and 1");
+		}
+	}
+}
+
+RegionMap RegionMap::load(const std::string &fileName)
+{
+	std::ifstream in(fileName, std::ios::in | std::ios::binary);
+	if(!in)
+	{
+		throw std::invalid_argument("Cannot read region map: " + fileName);
+	}
+
+	char magic[sizeof(mapMagic)];
+	std::uint32_t rows, cols, regionCount;
+	if(!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), mapMagic)
+	|| !readUint32(in, rows) || !readUint32(in, cols) || !readUint32(in, regionCount))
+	{
+		throw std::invalid_argument("Not a region map: " + fileName);
+	}
+
+	if(static_cast<std::uint64_t>(rows) * cols > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+	{
+		throw std::invalid_argument("Region map " + fileName + " is too large");
+	}
+
+	if(0 == regionCount || regionCount > static_cast<std::uint32_t>(maxRegions))
+	{
+		throw std::invalid_argument("Region map " + fileName + " has " + std::to_string(regionCount) + " regions");
+	}
+
+	std::vector<Probabilities> table(regionCount);
+	for(auto &region : table)
+	{
+		if(!readDouble(in, region.probSI) || !readDouble(in, region.probIR) || !readDouble(in, region.probRS))
+		{
+			throw std::invalid_argument("Region map " + fileName + " is truncated");
+		}
+	}
+
+	RegionMap map(rows, cols, table);
+	if(!in.read(reinterpret_cast<char*>(map.m_regionData.data()), map.m_regionData.size()))
+	{
+		throw std::invalid_argument("Region map " + fileName + " is truncated");
+	}
+
+	if(std::any_of(map.m_regionData.begin(), map.m_regionData.end(), [regionCount](std::uint8_t region) { return region >= regionCount; }))
+	{
+		throw std::invalid_argument("Region map " + fileName + " uses a region that is not in its table");
+	}
+
+	return map;
+}
+
+void RegionMap::save(const std::string &fileName) const
+{
+	std::ofstream out(fileName, std::ios::out | std::ios::binary);
+
+	out.write(mapMagic, sizeof(mapMagic));
+	writeUint32(out, m_rowCount);
+	writeUint32(out, m_colCount);
+	writeUint32(out, m_table.size());
+	for(const auto &region : m_table)
+	{
+		writeDouble(out, region.probSI);
+		writeDouble(out, region.probIR);
+		writeDouble(out, region.probRS);
+	}
+	out.write(reinterpret_cast<const char*>(m_regionData.data()), m_regionData.size());
+
+	if(!out)
+	{
+		throw std::invalid_argument("Cannot write region map: " + fileName);
+	}
+}
+
+RegionMap RegionMap::readText(std::istream &in)
+{
+	// Drop comments so what is left is just whitespace separated values.
+	std::string values;
+	std::string line;
+	while(std::getline(in, line))
+	{
+		values += line.substr(0, line.find('#')) + '\n';
+	}
+	std::istringstream stream(values);
+
+	int rows, cols, regionCount;
+	if(!(stream >> rows >> cols >> regionCount) || rows <= 0 || cols <= 0)
+	{
+		throw std::invalid_argument("A text region map must start with its rows, columns and number of regions");
+	}
+
+	if(regionCount <= 0 || regionCount > maxRegions)
+	{
+		throw std::invalid_argument("A text region map has " + std::to_string(regionCount) + " regions");
+	}
+
+	std::vector<Probabilities> table(regionCount);
+	for(auto &region : table)
+	{
+		if(!(stream >> region.probSI >> region.probIR >> region.probRS))
+		{
+			throw std::invalid_argument("A text region map needs p_1, p_2 and p_3 for each of its regions");
+		}
+	}
+
+	RegionMap map(rows, cols, table);
+	for(int row = 0; row < rows; ++row)
+	{
+		for(int col = 0; col < cols; ++col)
+		{
+			int region;
+			if(!(stream >> region) || region < 0 || region >= regionCount)
+			{
+				throw std::invalid_argument("A text region map needs a region in its table for cell " +
+					std::to_string(row) + "," + std::to_string(col));
+			}
+			map.setRegion(row, col, region);
+		}
+	}
+
+	return map;
+}
+
+void RegionMap::writeText(std::ostream &out) const
+{
+	out << "# rows cols regions" << '\n';
+	out << m_rowCount << ' ' << m_colCount << ' ' << m_table.size() << '\n';
+
+	// Enough digits for any probability typed by hand to come back unchanged.
+	const std::streamsize precision = out.precision(std::numeric_limits<double>::digits10);
+	out << "# p_1 p_2 p_3 of each region" << '\n';
+	for(const auto &region : m_table)
+	{
+		out << region.probSI << ' ' << region.probIR << ' ' << region.probRS << '\n';
+	}
+	out.precision(precision);
+
+	out << "# region of each cell, row by row" << '\n';
+	for(int row = 0; row < m_rowCount; ++row)
+	{
+		for(int col = 0; col < m_colCount; ++col)
+		{
+			out << (col > 0 ? " " : "") << static_cast<int>(m_regionData[col + row * m_colCount]);
+		}
+		out << '\n';
+	}
+}
+
+void RegionMap::setRegion(int row, int col, int region)
+{
+	m_regionData[col + row * m_colCount] = static_cast<std::uint8_t>(region);
+}
+
+int RegionMap::getRows() const
+{
+	return m_rowCount;
+}
+
+int RegionMap::getCols() const
+{
+	return m_colCount;
+}
+
+const std::vector<RegionMap::Probabilities>& RegionMap::getTable() const
+{
+	return m_table;
+}
+
+const std::vector<std::uint8_t>& RegionMap::getRegionData() const
+{
+	return m_regionData;
+}
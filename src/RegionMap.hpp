@@ -0,0 +1,141 @@
+#ifndef RegionMap_hpp
+#define RegionMap_hpp
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+/**
+ *\file
+ *\class RegionMap
+ *\brief Class assigning every cell of a lattice to one of up to 256 regions with their own probabilities.
+ *
+ * Each cell stores a single byte region id and the three transition probabilities of each region
+ * live in a small table, so the update kernels read one extra byte per cell and a table that stays
+ * in L1 rather than three doubles per cell.
+ *
+ * Maps are stored in a binary file laid out as
+ *
+ *     char     magic[8]              "SIRSMAP1"
+ *     uint32   rows, cols, regionCount
+ *     double   probSI, probIR, probRS   regionCount times
+ *     uint8    region id                rows*cols times, row by row
+ *
+ * with every value in little-endian byte order. Maps are written by hand as text, see readText, and
+ * converted with sirs-regionmap.
+ */
+class RegionMap
+{
+public:
+	/**
+	 *\class Probabilities
+	 *\brief Class holding the transition probabilities of one region.
+	 */
+	class Probabilities
+	{
+	public:
+		/// Probability of going from susceptible to infected upon contact.
+		double probSI;
+		/// Probability of going from infected to recovered.
+		double probIR;
+		/// Probability of going from recovered to susceptible.
+		double probRS;
+	};
+
+	/// Largest number of regions a single byte id can address.
+	static constexpr int maxRegions = 256;
+
+private:
+	/// Member variable for the number of rows of the map.
+	int m_rowCount;
+
+	/// Member variable for the number of columns of the map.
+	int m_colCount;
+
+	/// Member variable holding the probabilities of each region.
+	std::vector<Probabilities> m_table;
+
+	/// Member variable holding the region of each cell, cell (row,col) is at col + row * cols.
+	std::vector<std::uint8_t> m_regionData;
+
+public:
+	/**
+	 *\brief Constructor for a map with every cell in region 0.
+	 *\param rows integer value representing the number of rows.
+	 *\param cols integer value representing the number of columns.
+	 *\param table vector of the probabilities of each region, between 1 and maxRegions entries.
+	 *
+	 * Throws std::invalid_argument if the table is empty or too large, or a probability is not in [0,1].
+	 */
+	RegionMap(int rows, int cols, const std::vector<Probabilities> &table);
+
+	/**
+	 *\brief Reads a map from a binary map file.
+	 *\param fileName string holding the path of the file.
+	 *\return RegionMap instance read from the file.
+	 *
+	 * Throws std::invalid_argument if the file cannot be read, is not a map, refers to a region that is
+	 * not in its table or has a probability that is not in [0,1].
+	 */
+	static RegionMap load(const std::string &fileName);
+
+	/**
+	 *\brief Writes the map to a binary map file.
+	 *\param fileName string holding the path of the file.
+	 *
+	 * Throws std::invalid_argument if the file cannot be written.
+	 */
+	void save(const std::string &fileName) const;
+
+	/**
+	 *\brief Reads a map written as text, the way maps are meant to be authored.
+	 *\param in std::istream reference to read from.
+	 *\return RegionMap instance read from the text.
+	 *
+	 * The text is the rows, columns and number of regions, then p_1, p_2 and p_3 of each region, then
+	 * the region of every cell row by row, all separated by whitespace. Anything after a # on a line
+	 * is a comment. Throws std::invalid_argument if anything is missing or out of range.
+	 */
+	static RegionMap readText(std::istream &in);
+
+	/**
+	 *\brief Writes the map as text in the layout readText reads, with comments naming each part.
+	 *\param out std::ostream reference to write to.
+	 */
+	void writeText(std::ostream &out) const;
+
+	/**
+	 *\brief Setter for the region of a cell.
+	 *\param row row of the cell, in the range [0,getRows()).
+	 *\param col column of the cell, in the range [0,getCols()).
+	 *\param region integer value representing the region, must be less than the size of the table.
+	 */
+	void setRegion(int row, int col, int region);
+
+	/**
+	 *\brief Getter for the number of rows.
+	 *\return Integer value representing the number of rows.
+	 */
+	int getRows() const;
+
+	/**
+	 *\brief Getter for the number of columns.
+	 *\return Integer value representing the number of columns.
+	 */
+	int getCols() const;
+
+	/**
+	 *\brief Getter for the probabilities of every region.
+	 *\return constant reference to the vector indexed by region id.
+	 */
+	const std::vector<Probabilities>& getTable() const;
+
+	/**
+	 *\brief Getter for the region of every cell.
+	 *\return constant reference to the vector holding the region id of every cell row by row.
+	 */
+	const std::vector<std::uint8_t>& getRegionData() const;
+};
+
+#endif /* RegionMap_hpp */
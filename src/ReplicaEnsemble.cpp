@@ -0,0 +1,134 @@
+#include "ReplicaEnsemble.hpp"
+#include "parallelFor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+ReplicaEnsemble::ReplicaEnsemble(
+	const SIRSInputParameters &parameters,
+	int replicaCount
+	) : m_parameters(parameters),
+		m_replicaResults(std::max(1, replicaCount)),
+		m_orderParameterData(std::max(1, replicaCount)),
+		m_concurrentReplicas{std::max(1, std::min(replicaCount, parameters.threadCount))}
+{
+	// Every replica must have main, site, tau-leap and bootstrap streams of its own for the replicas to be independent.
+	if(replicaCount < 1 || static_cast<std::uint64_t>(replicaCount) > RandomStream::replicaLimit)
+	{
+		throw std::invalid_argument("Replica count must be between 1 and " + std::to_string(RandomStream::replicaLimit));
+	}
+
+	// The share below is at least 1 whatever was asked for, so check the count itself first.
+	if(parameters.threadCount < 1)
+	{
+		throw std::invalid_argument("Thread count must be at least 1 but got " + std::to_string(parameters.threadCount));
+	}
+
+	// Each replica gets an equal share of whatever threads the concurrent replicas leave.
+	m_parameters.threadCount = std::max(1, parameters.threadCount / m_concurrentReplicas);
+
+	// Build the first replica only to check the parameters, it is freed again straight away.
+	Simulation(m_parameters, 0);
+}
+
+int ReplicaEnsemble::getReplicaCount() const
+{
+	return m_replicaResults.size();
+}
+
+const SIRSResults& ReplicaEnsemble::getReplicaResults(int replica) const
+{
+	return m_replicaResults[replica];
+}
+
+SIRSResults ReplicaEnsemble::run()
+{
+	const int replicaCount = getReplicaCount();
+
+	// Each thread runs a contiguous block of replicas, every replica writes only its own results. A replica
+	// is only built when its thread reaches it and freed once it has run, so at most m_concurrentReplicas
+	// lattices exist at once.
+	parallelFor(0, replicaCount, m_concurrentReplicas, [this](int replicaBegin, int replicaEnd, int)
+	{
+		for(int replica = replicaBegin; replica < replicaEnd; ++replica)
+		{
+			Simulation simulation(m_parameters, replica);
+			m_replicaResults[replica] = simulation.run();
+			m_orderParameterData[replica] = simulation.getOrderParameterData();
+		}
+	});
+
+	double orderSum = 0;
+	double susceptibilitySum = 0;
+	double squaredErrorSum = 0;
+	double effectiveSampleSize = 0;
+	for(const auto &results : m_replicaResults)
+	{
+		orderSum += results.orderParameter;
+		susceptibilitySum += results.susceptibility;
+		squaredErrorSum += results.orderParameterError * results.orderParameterError;
+		effectiveSampleSize += results.effectiveSampleSize;
+	}
+
+	const double orderParameter = orderSum / replicaCount;
+	const double susceptibility = susceptibilitySum / replicaCount;
+
+	double orderSpread = 0;
+	double susceptibilitySpread = 0;
+	for(const auto &results : m_replicaResults)
+	{
+		orderSpread += (results.orderParameter - orderParameter) * (results.orderParameter - orderParameter);
+		susceptibilitySpread += (results.susceptibility - susceptibility) * (results.susceptibility - susceptibility);
+	}
+
+	// Standard errors of the means of independent replicas.
+	const double betweenReplicaError = (replicaCount > 1) ? std::sqrt(orderSpread / (replicaCount - 1) / replicaCount) : m_replicaResults.front().orderParameterError;
+	const double susceptibilityError = (replicaCount > 1) ? std::sqrt(susceptibilitySpread / (replicaCount - 1) / replicaCount) : m_replicaResults.front().susceptibilityError;
+	const double withinReplicaError  = std::sqrt(squaredErrorSum) / replicaCount;
+
+	return SIRSResults
+	{
+		orderParameter,
+		betweenReplicaError,
+		susceptibility,
+		susceptibilityError,
+		effectiveSampleSize,
+		replicaCount,
+		betweenReplicaError,
+		withinReplicaError,
+		m_replicaResults.front().population,
+	};
+}
+
+void ReplicaEnsemble::writeReplicas(std::ostream &out) const
+{
+	for(int replica = 0; replica < getReplicaCount(); ++replica)
+	{
+		const SIRSResults &results = m_replicaResults[replica];
+		out << replica << ' ' << results.orderParameter << ' ' << results.orderParameterError << ' ' <<
+		results.susceptibility << ' ' << results.susceptibilityError << '\n';
+	}
+}
+
+void ReplicaEnsemble::writeOrderParameters(std::ostream &out) const
+{
+	const int interval = m_parameters.measurementInterval;
+	const int firstSweep = ((m_parameters.burnPeriod + interval - 1) / interval) * interval;
+
+	int length = m_orderParameterData.front().getSize();
+	for(const auto &data : m_orderParameterData)
+	{
+		length = std::min(length, data.getSize());
+	}
+
+	for(int n = 0; n < length; ++n)
+	{
+		out << firstSweep + n * interval;
+		for(const auto &data : m_orderParameterData)
+		{
+			out << ' ' << data[n];
+		}
+		out << '\n';
+	}
+}
@@ -0,0 +1,86 @@
+#ifndef ReplicaEnsemble_hpp
+#define ReplicaEnsemble_hpp
+
+#include "Simulation.hpp"
+#include "SIRSInputParameters.hpp"
+#include "SIRSResults.hpp"
+#include "DataArray.hpp"
+#include <vector>
+#include <iostream>
+
+/**
+ *\file
+ *\class ReplicaEnsemble
+ *\brief Class that runs independent replicas of a simulation on separate threads and combines their results.
+ *
+ * Replica r is a Simulation created with replica index r, so its lattice, sweeps and resampling all
+ * come from Philox streams whose ids differ in the replica. Their counter ranges are disjoint, so no two
+ * replicas share a random number however long they run, and the ensemble is reproducible from the seed
+ * whatever the thread count. The threads are shared out between the replicas, any left over go to the tau-leap
+ * engine and lattice filling of each replica.
+ *
+ * The combined order parameter is the average over replicas. Its error is taken from the spread of
+ * the replica averages, which needs no assumption about the autocorrelation time, and the error
+ * obtained by combining the blocked errors of each replica is reported alongside as a check on the
+ * blocking.
+ */
+class ReplicaEnsemble
+{
+private:
+	/// Member variable holding the parameters shared by every replica, with each replica's share of the threads.
+	SIRSInputParameters m_parameters;
+
+	/// Member variable holding the results of each replica once they have run.
+	std::vector<SIRSResults> m_replicaResults;
+
+	/// Member variable holding the order parameter series of each replica once they have run.
+	std::vector<DataArray> m_orderParameterData;
+
+	/// Member variable for the number of replicas run at the same time.
+	int m_concurrentReplicas;
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param parameters SIRSInputParameters reference describing each replica, threadCount is shared between them.
+	 *\param replicaCount integer value representing the number of replicas, from 1 to RandomStream::replicaLimit.
+	 *
+	 * The replicas themselves are only built by run, each when its thread reaches it. Throws
+	 * std::invalid_argument if the parameters do not describe a valid simulation or there are more
+	 * replicas than have distinct streams.
+	 */
+	ReplicaEnsemble(const SIRSInputParameters &parameters, int replicaCount);
+
+	/**
+	 *\brief Getter for the number of replicas.
+	 *\return Integer value representing the number of replicas.
+	 */
+	int getReplicaCount() const;
+
+	/**
+	 *\brief Getter for the results of a replica.
+	 *\param replica integer value representing the index of the replica.
+	 *\return constant SIRSResults reference, only meaningful after run.
+	 */
+	const SIRSResults& getReplicaResults(int replica) const;
+
+	/**
+	 *\brief Runs every replica and combines their results.
+	 *\return SIRSResults instance holding the ensemble averages with between and within replica errors.
+	 */
+	SIRSResults run();
+
+	/**
+	 *\brief Outputs the results of each replica, lines of "replica order error susceptibility error".
+	 *\param out std::ostream reference to write to.
+	 */
+	void writeReplicas(std::ostream &out) const;
+
+	/**
+	 *\brief Outputs the order parameter series of every replica side by side, lines of "sweep count0 count1 ...".
+	 *\param out std::ostream reference to write to.
+	 */
+	void writeOrderParameters(std::ostream &out) const;
+};
+
+#endif /* ReplicaEnsemble_hpp */
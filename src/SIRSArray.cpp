@@ -1,6 +1,21 @@
 #include "SIRSArray.hpp"
+#include "Philox.hpp"
+#include "parallelFor.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
 
 constexpr int SIRSArray::stateSymbols[];
+constexpr unsigned SIRSArray::featureBits;
+constexpr int SIRSArray::maxNeighbourCount;
+constexpr int SIRSArray::prefetchDistance;
+
+namespace
+{
+    /// Philox counter domains so the different random choices made from one seed never share counters.
+    const std::uint64_t stateDomain  = 0;
+    const std::uint64_t immuneDomain = 1;
+}
 
 SIRSArray::State& SIRSArray::operator()(int row, int col)
 {
@@ -8,6 +23,9 @@ SIRSArray::State& SIRSArray::operator()(int row, int col)
     row = (row + m_rowCount) % m_rowCount;
     col = (col + m_colCount) % m_colCount;
 
+    // The caller may change the cell.
+    m_neighbourCountsStale = true;
+
     // Return 1D index of 1D array corresponding to the 2D index.
     return m_boardData[col + row * m_colCount];
 }
@@ -36,73 +54,152 @@ SIRSArray::SIRSArray(
 		m_probSI{probSI},
 		m_probIR{probIR},
 		m_probRS{probRS},
-		m_boardData(rows*cols, state)
+		m_boardData(rows*cols, state),
+		m_neighbourCountsStale{true},
+		m_batchSize{0}
 {
-
+    updateContactProbabilities();
 }
 
 SIRSArray::SIRSArray(
-	std::default_random_engine &generator,
+	RandomStream &generator,
 	int rows, 
 	int cols, 
 	double probSI, 
 	double probIR, 
 	double probRS,
-	double immuneFraction
+	double immuneFraction,
+	int threadCount
 	) : m_rowCount{rows},
 		m_colCount{cols},
+		m_boardData(rows*cols),
 		m_probSI{probSI},
 		m_probIR{probIR},
-		m_probRS{probRS}
+		m_probRS{probRS},
+		m_neighbourCountsStale{true},
+		m_batchSize{0}
+{
+    updateContactProbabilities();
+
+    // Everything else comes from a single seed so the lattice can be rebuilt with initialise.
+    std::uniform_int_distribution<std::uint64_t> seedDistribution;
+    initialise(seedDistribution(generator), immuneFraction, threadCount);
+}
+
+SIRSArray::State SIRSArray::initialState(std::uint64_t seed, std::uint64_t index)
 {
-    //TODO: This can probably be made more efficient.
+    // Each Philox block provides the states of four consecutive cells.
+    PhiloxBlock bits = philox4x32(philoxCounter(index / 4, stateDomain), seed);
+    return static_cast<SIRSArray::State>(philoxBounded(bits[index % 4], 3u));
+}
 
-    // Reserve the correct amount of space in the board data.
-    m_boardData.reserve(rows * cols);
+void SIRSArray::initialise(std::uint64_t seed, double immuneFraction, int threadCount)
+{
+    initialiseStates(m_boardData, seed, immuneFraction, threadCount);
+    m_neighbourCountsStale = true;
+}
 
-    // Create a distribution to sample from the states, we -2 since we are ignoring the immune cells 
-    // and the parameter is a closed interval.
-    static std::uniform_int_distribution<int> distribution(0,static_cast<int>(SIRSArray::MAXSTATE)-2);
-    for(int i = 0; i < rows*cols; ++i)
+void SIRSArray::initialiseStates(StateVector &states, std::uint64_t seed, double immuneFraction, int threadCount)
+{
+    const std::uint64_t size = states.size();
+    const std::uint64_t immuneCount = std::llround(immuneFraction * size);
+
+    // If most cells are immune it is quicker to choose the ones that are not.
+    const bool chooseNonImmune = immuneCount > size / 2;
+
+    // Fill the lattice in tiles of whole Philox blocks so every thread produces the same numbers
+    // for a cell as a serial fill would.
+    const std::uint64_t blockCount = (size + 3) / 4;
+    parallelFor<std::uint64_t>(0, blockCount, threadCount, [&](std::uint64_t blockBegin, std::uint64_t blockEnd, int)
     {
-        m_boardData.push_back(static_cast<SIRSArray::State>(distribution(generator)));
+        const std::uint64_t cellBegin = 4 * blockBegin;
+        const std::uint64_t cellEnd   = std::min(4 * blockEnd, size);
+
+        if(chooseNonImmune)
+        {
+            std::fill(states.begin() + cellBegin, states.begin() + cellEnd, SIRSArray::Immune);
+            return;
+        }
+
+        for(std::uint64_t block = blockBegin; block < blockEnd; ++block)
+        {
+            PhiloxBlock bits = philox4x32(philoxCounter(block, stateDomain), seed);
+            for(std::uint64_t cell = 4 * block; cell < std::min(4 * block + 4, cellEnd); ++cell)
+            {
+                states[cell] = static_cast<SIRSArray::State>(philoxBounded(bits[cell % 4], 3u));
+            }
+        }
+    });
+
+    // Floyd's algorithm: for j = size-k,...,size-1 pick t uniformly in [0,j] and take t, or j if t has
+    // already been taken. This gives a uniformly random subset of exactly k cells and uses the board
+    // itself to remember which cells have been taken.
+    const std::uint64_t pickCount = chooseNonImmune ? size - immuneCount : immuneCount;
+    auto taken = [&](std::uint64_t index)
+    {
+        return chooseNonImmune ? (SIRSArray::Immune != states[index]) : (SIRSArray::Immune == states[index]);
+    };
+
+    for(std::uint64_t j = size - pickCount; j < size; ++j)
+    {
+        PhiloxBlock bits = philox4x32(philoxCounter(j, immuneDomain), seed);
+        std::uint64_t t = philoxBounded((static_cast<std::uint64_t>(bits[1]) << 32) | bits[0], j + 1);
+        std::uint64_t pick = taken(t) ? j : t;
+
+        states[pick] = chooseNonImmune ? initialState(seed, pick) : SIRSArray::Immune;
     }
+}
 
-    // Calculate the actual number of immune cells that will be in the lattice.
-    int totalImmuneCells = round((immuneFraction) * (m_rowCount * m_colCount));
+void SIRSArray::changeImmuneFraction(StateVector &states, double immuneFraction, RandomStream &generator)
+{
+    const std::int64_t targetCount = std::llround(immuneFraction * states.size());
+    const std::int64_t immuneCount = std::count(states.begin(), states.end(), SIRSArray::Immune);
+    if(targetCount == immuneCount)
+    {
+        return;
+    }
 
-    // Set the specified fraction of the cells completely immune to infection.
-    if(immuneFraction != 0)
+    // Candidates are the cells that can change, a partial Fisher-Yates shuffle picks the ones that do.
+    const bool adding = targetCount > immuneCount;
+    std::vector<std::uint32_t> candidates;
+    candidates.reserve(adding ? states.size() - immuneCount : immuneCount);
+    for(std::uint32_t cell = 0; cell < states.size(); ++cell)
     {
-    	// Create a distribution so immune cells are chosen randomly.
-    	std::uniform_int_distribution<int> immuneDistribution(0,m_rowCount*m_colCount - 1);
-    	
-    	int counter = 0;
-
-    	while(counter < totalImmuneCells)
-    	{
-    		int index = immuneDistribution(generator);
-    		if(m_boardData[index] != SIRSArray::Immune)
-    		{
-    			m_boardData[index] = SIRSArray::Immune;
-    			++counter;
-    		}
-
-    	}
+        if((SIRSArray::Immune == states[cell]) != adding)
+        {
+            candidates.push_back(cell);
+        }
     }
 
+    const std::size_t changeCount = std::min<std::size_t>(std::llabs(targetCount - immuneCount), candidates.size());
+    for(std::size_t pick = 0; pick < changeCount; ++pick)
+    {
+        std::uniform_int_distribution<std::size_t> candidateDistribution(pick, candidates.size() - 1);
+        std::swap(candidates[pick], candidates[candidateDistribution(generator)]);
+        states[candidates[pick]] = adding ? SIRSArray::Immune : SIRSArray::Susceptible;
+    }
 }
 
-void SIRSArray::randomise(std::default_random_engine &generator)
+void SIRSArray::setImmuneFraction(double immuneFraction, RandomStream &generator)
 {
-    // Create a uniform distribution for the states on the board.
-    static std::uniform_int_distribution<int> distribution(0,static_cast<int>(SIRSArray::MAXSTATE)-1);
+    changeImmuneFraction(m_boardData, immuneFraction, generator);
+    m_neighbourCountsStale = true;
+}
+
+void SIRSArray::randomise(RandomStream &generator)
+{
+    std::uniform_int_distribution<std::uint64_t> seedDistribution;
+    const std::uint64_t seed = seedDistribution(generator);
 
-    for(auto &cell : m_boardData)
+    for(std::uint64_t cell = 0; cell < m_boardData.size(); ++cell)
     {
-        cell = static_cast<SIRSArray::State>(distribution(generator));
+        if(SIRSArray::Immune != m_boardData[cell])
+        {
+            m_boardData[cell] = initialState(seed, cell);
+        }
     }
 
+    m_neighbourCountsStale = true;
 }
 
 
@@ -121,6 +218,11 @@ int SIRSArray::getSize() const
     return m_colCount * m_rowCount;
 }
 
+const SIRSArray::StateVector& SIRSArray::getBoardData() const
+{
+    return m_boardData;
+}
+
 bool SIRSArray::hasInfectedNeighbour(int row, int col) const
 {
 	// Make checks using overloaded () operator so that we take into account periodic
@@ -140,23 +242,19 @@ bool SIRSArray::hasInfectedNeighbour(int row, int col) const
 }
 
 
-SIRSArray::State SIRSArray::updateCell(int row, int col, std::default_random_engine& generator)
+SIRSArray::State SIRSArray::updateCell(int row, int col, RandomStream& generator)
 {
-	// Uniform random number generation for stochastically updating states. Since the distribution
-	// is always the same we make its static.
-	static std::uniform_real_distribution<double> distribution(0.0,1.0);
-
 	switch((*this)(row,col))
 	{
 		case State::Susceptible :   if(hasInfectedNeighbour(row,col))	
 									{
-									(*this)(row,col) = (distribution(generator) < m_probSI) ? State::Infected : State::Susceptible;
+									(*this)(row,col) = (generator.uniform() < m_probSI) ? State::Infected : State::Susceptible;
 									}
 									break;
-		case State::Infected : (*this)(row,col) = (distribution(generator) < m_probIR) ? State::Recovered : State::Infected;
+		case State::Infected : (*this)(row,col) = (generator.uniform() < m_probIR) ? State::Recovered : State::Infected;
 								break;
 
-		case State::Recovered : (*this)(row,col) = (distribution(generator) < m_probRS) ? State::Susceptible : State::Recovered;
+		case State::Recovered : (*this)(row,col) = (generator.uniform() < m_probRS) ? State::Susceptible : State::Recovered;
 								break;
 		case State::Immune: break;
 
@@ -186,6 +284,16 @@ double SIRSArray::getProbRS() const
 void SIRSArray::setProbSI(double prob)
 {
 	m_probSI = prob;
+	updateContactProbabilities();
+}
+
+void SIRSArray::updateContactProbabilities()
+{
+	// Each infected neighbour independently fails to infect with probability 1 - probSI.
+	for(int count = 0; count <= maxNeighbourCount; ++count)
+	{
+		m_contactProbability[count] = 1.0 - std::pow(1.0 - m_probSI, count);
+	}
 }
 
 void SIRSArray::setProbIR(double prob)
@@ -198,9 +306,37 @@ void SIRSArray::setProbRS(double prob)
 	m_probRS = prob;
 }
 
+void SIRSArray::setRegions(const RegionMap &regions)
+{
+	if(regions.getRows() != m_rowCount || regions.getCols() != m_colCount)
+	{
+		throw std::invalid_argument("The region map is " + std::to_string(regions.getRows()) + "x" + std::to_string(regions.getCols()) +
+			" but the lattice is " + std::to_string(m_rowCount) + "x" + std::to_string(m_colCount));
+	}
+
+	m_regionData.assign(regions.getRegionData().begin(), regions.getRegionData().end());
+	m_regionTable = regions.getTable();
+}
+
+bool SIRSArray::hasRegions() const
+{
+	return !m_regionTable.empty();
+}
 
+void SIRSArray::setBatching(int batchSize, const RandomStream &siteStream)
+{
+	m_batchSize = std::max(0, batchSize);
+	m_siteStream = siteStream;
+}
 
-SIRSArray::State SIRSArray::update(std::default_random_engine& generator)
+int SIRSArray::getBatchSize() const
+{
+	return m_batchSize;
+}
+
+
+
+SIRSArray::State SIRSArray::update(RandomStream& generator)
 {
 	// Create a uniform distribution for the rows and columns remembering to subtract 1 for the closed limits.
 	std::uniform_int_distribution<int> rowDistribution(0,m_rowCount-1);
@@ -211,6 +347,35 @@ SIRSArray::State SIRSArray::update(std::default_random_engine& generator)
 
 }
 
+SIRSArray::SweepFunction SIRSArray::selectSweep(NeighbourhoodType type, int radius, unsigned features)
+{
+	// Every combination of stencil and radius needs its own instantiation, the features are then
+	// resolved by FeatureDispatch.
+	switch(type)
+	{
+		case VonNeumannNeighbourhood :
+			switch(radius)
+			{
+				case 1 : return FeatureDispatch<VonNeumann<1>, 0, 0>::select(features);
+				case 2 : return FeatureDispatch<VonNeumann<2>, 0, 0>::select(features);
+				case 3 : return FeatureDispatch<VonNeumann<3>, 0, 0>::select(features);
+				default: return nullptr;
+			}
+
+		case MooreNeighbourhood :
+			switch(radius)
+			{
+				case 1 : return FeatureDispatch<Moore<1>, 0, 0>::select(features);
+				case 2 : return FeatureDispatch<Moore<2>, 0, 0>::select(features);
+				case 3 : return FeatureDispatch<Moore<3>, 0, 0>::select(features);
+				default: return nullptr;
+			}
+
+		default:
+			return nullptr;
+	}
+}
+
 int SIRSArray::stateCount(SIRSArray::State state) const
 {
 	double total = 0;
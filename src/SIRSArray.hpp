@@ -6,6 +6,13 @@
 #include <iostream> // For outputting board.
 #include <utility> // For std::pair.
 #include <cmath> // For round.
+#include <cstdint> // For the 64 bit seeds.
+#include <array> // For the per-contact infection probabilities.
+#include <algorithm> // For std::min.
+#include "Neighbourhood.hpp" // For the stencils the update kernels are templated on.
+#include "RegionMap.hpp" // For spatially varying probabilities.
+#include "HugePageAllocator.hpp" // For the storage of the cells.
+#include "RandomStream.hpp" // For the streams the update kernels draw from.
 
 /**
  * \file
@@ -14,12 +21,15 @@
  */
 class SIRSArray
 {
+    /// The tau-leaping engine works directly on the board data to update every cell at once.
+    friend class TauLeapEngine;
+
 public:
     /** 
      * \enum State
      * \brief Enumeration type to hold the state of the cell, dead or alive.
      */
-    enum State
+    enum State : unsigned char
     {
         Susceptible,
         Infected,
@@ -28,10 +38,73 @@ public:
         MAXSTATE,
     };
 
+    /// Vector of cell states, one byte per cell backed by huge pages when it is large.
+    using StateVector = std::vector<State, HugePageAllocator<State> >;
+
     /// Look-up table for alive/dead cells symbols for printing.
     static constexpr int stateSymbols[MAXSTATE] = {0,1,2,3};
 
+    /**
+     * \enum Feature
+     * \brief Bit flags for optional parts of the model that the update kernels are specialised on.
+     *
+     * A kernel compiled without a feature contains no code for it, e.g. a lattice with no immune
+     * cells never checks for the Immune state in its hot loop.
+     *
+     * NeighbourCountFeature keeps the number of infected neighbours of every cell up to date as cells
+     * become and stop being infected, so a susceptible cell reads one byte instead of its whole
+     * neighbourhood. It changes nothing about the dynamics. ContactFeature replaces the rule that a
+     * cell with any infected neighbour is infected with probability probSI by independent contacts,
+     * each of k infected neighbours infects with probability probSI, 1 - (1 - probSI)^k in all.
+     */
+    enum Feature
+    {
+        ImmunityFeature       = 1 << 0,
+        RegionFeature         = 1 << 1,
+        NeighbourCountFeature = 1 << 2,
+        ContactFeature        = 1 << 3,
+    };
+
+    /// Number of bits used by the Feature flags.
+    static constexpr unsigned featureBits = 4;
+
+    /// Most neighbours any compiled stencil has, a Moore neighbourhood of the largest radius.
+    static constexpr int maxNeighbourCount = (2 * maxNeighbourhoodRadius + 1) * (2 * maxNeighbourhoodRadius + 1) - 1;
+
+    /// Number of updates ahead of the current one whose cells a batched sweep prefetches.
+    static constexpr int prefetchDistance = 8;
+
+    /// Pointer to one of the specialised sweep kernels, selected once with selectSweep.
+    using SweepFunction = void (SIRSArray::*)(RandomStream&);
+
 private:
+    /**
+     *\brief Helper for selectSweep that turns the runtime feature flags into a compile-time constant.
+     *
+     * Recurses over each of the featureBits bits adding it to Built if it is set in the runtime flags.
+     */
+    template<class Stencil, unsigned Built, unsigned Bit>
+    struct FeatureDispatch;
+
+    /**
+     *\brief Wraps an index that is at most one period outside [0,period) back into range.
+     *\param index Integer value that may be up to one period either side of the lattice.
+     *\param period Integer value representing the length of the lattice along this axis.
+     *\return Integer value representing the wrapped index.
+     *
+     * This is used instead of the modulo in operator() on the hot path since it compiles to a
+     * couple of conditional moves rather than a division.
+     */
+    static int wrapIndex(int index, int period);
+
+    /**
+     *\brief Computes the random initial state of a cell, see initialise.
+     *\param seed 64 bit seed the lattice is generated from.
+     *\param index 64 bit index of the cell in m_boardData.
+     *\return State value that is susceptible, infected or recovered with equal probability.
+     */
+    static State initialState(std::uint64_t seed, std::uint64_t index);
+
     /// Member variable that holds number of rows in lattice.
     int m_rowCount;
 
@@ -39,7 +112,7 @@ private:
     int m_colCount;
 
     /// Member variable that holds the actual data in the lattice.
-    std::vector<State> m_boardData;
+    StateVector m_boardData;
 
     /// Member variable for the probability of going from susceptible to infected.
     double m_probSI;
@@ -50,10 +123,64 @@ private:
     /// Member variable for the probability of going from recovered to susceptible.
     double m_probRS;
 
+    /// Member variable holding the region of each cell, empty unless a region map has been set.
+    std::vector<std::uint8_t, HugePageAllocator<std::uint8_t> > m_regionData;
+
+    /// Member variable holding the probabilities of each region, empty unless a region map has been set.
+    std::vector<RegionMap::Probabilities> m_regionTable;
+
+    /// Member variable holding the number of infected neighbours of each cell, kept by kernels built with NeighbourCountFeature.
+    std::vector<std::uint8_t, HugePageAllocator<std::uint8_t> > m_infectedNeighbours;
+
+    /// Member variable set when the cells have changed without the neighbour counts being kept up to date.
+    bool m_neighbourCountsStale;
+
+    /// Member variable holding 1 - (1 - probSI)^k for k infected neighbours, used by kernels built with ContactFeature.
+    std::array<double, maxNeighbourCount + 1> m_contactProbability;
+
+    /// Member variable for the number of sites a sweep draws before updating them, 0 to draw each as it is updated.
+    int m_batchSize;
+
+    /// Member variable holding the stream batched sweeps draw their sites from.
+    RandomStream m_siteStream;
+
+    /**
+     *\brief Works out m_contactProbability from the lattice wide probability of infection.
+     */
+    void updateContactProbabilities();
+
+    /**
+     *\brief Adds to the infected neighbour count of every cell in the stencil around a cell.
+     *\param row row of the cell, must be in the range [0,getRows()).
+     *\param col column of the cell, must be in the range [0,getCols()).
+     *\param change +1 when the cell has become infected, -1 when it has stopped being infected.
+     */
+    template<class Stencil>
+    void addToNeighbourCounts(int row, int col, int change);
+
+    /**
+     *\brief Counts the infected neighbours of every cell from scratch.
+     */
+    template<class Stencil>
+    void rebuildNeighbourCounts();
+
+    /**
+     *\brief Asks for everything updating a cell reads or writes to be brought into the cache.
+     *\param index index of the cell in m_boardData.
+     *
+     * The rows of the stencil are prefetched at the cell's column, with byte sized cells the columns
+     * either side of it are almost always on the same cache line.
+     */
+    template<class Stencil, unsigned Features>
+    void prefetchCell(int index) const;
+
 public:
     /**
      *\brief operator overload for getting the state at a site.
      *
+     * Writing through the reference is not seen by the neighbour counts, so they are rebuilt the
+     * next time a kernel that keeps them runs.
+     *
      * This method is implemented since the states are stored internally as a 1D vector, hence 
      * they need to be indexed in a special way in order to get the site that would correspond to 
      * the (i,j) site in matrix notation. This function allows the caller to treat the lattice as a 
@@ -101,24 +228,75 @@ public:
      *\param probSI probability of going from susceptible to infected state if cell is in contact with infected cell.
      *\param probIR probability of infected site going from infected to recovered.
      *\param probRS probability of recovered site becoming susceptible again.
-     *\param generator std::default_random_engine reference for generating random numbers.
+     *\param generator RandomStream reference for generating random numbers.
      *\param immuneFraction floating point instance representing the fraction of the population who are completely immune to the infection.
+     *\param threadCount Integer value representing the number of threads used to fill the lattice.
+     *
+     * A single seed is drawn from the generator and the lattice is then filled by initialise.
      */
     SIRSArray(
-        std::default_random_engine &generator,
+        RandomStream &generator,
     	int rows = 50, 
     	int cols = 50, 
     	double probSI = 1.0, 
     	double probIR = 1.0, 
     	double probRS = 1.0,
-    	double immuneFraction = 0.0
+    	double immuneFraction = 0.0,
+    	int threadCount = 1
     	);
 
     /**
-     *\brief Randomises the cells in the board with equal probability of being in each state.
+     *\brief Fills the lattice with an even mix of susceptible, infected and recovered cells plus exactly
+     * round(immuneFraction * size) immune cells at uniformly random sites.
+     *\param seed 64 bit seed the lattice is generated from.
+     *\param immuneFraction floating point value representing the fraction of cells that are immune.
+     *\param threadCount Integer value representing the number of threads used to fill the lattice.
+     *
+     * The state of each cell comes from a counter-based generator keyed by the seed and indexed by the
+     * cell, so the threads fill their tiles independently and the lattice is bit for bit the same for a
+     * given seed whatever the number of threads. Immune sites are chosen with Floyd's algorithm, which
+     * takes min(k, size - k) steps rather than slowing down as the immune fraction approaches one.
+     */
+    void initialise(std::uint64_t seed, double immuneFraction, int threadCount = 1);
+
+    /**
+     *\brief Fills any vector of cells the same way initialise fills the lattice.
+     *\param states vector of cells to fill, its size is left unchanged.
+     *\param seed 64 bit seed the cells are generated from.
+     *\param immuneFraction floating point value representing the fraction of cells that are immune.
+     *\param threadCount Integer value representing the number of threads used to fill the cells.
+     *
+     * This lets the other geometries share the initial conditions of the lattice, the cells are only
+     * ever addressed by their index in the vector.
+     */
+    static void initialiseStates(StateVector &states, std::uint64_t seed, double immuneFraction, int threadCount = 1);
+
+    /**
+     *\brief Changes the number of immune cells to round(immuneFraction * size) without touching the rest.
+     *\param states vector reference holding the state of every cell.
+     *\param immuneFraction floating point value representing the new fraction of immune cells.
+     *\param generator RandomStream reference for random number generation.
+     *
+     * Extra immune cells are taken uniformly at random from the cells that are not immune, and when the
+     * fraction falls uniformly random immune cells become susceptible. Every other cell keeps its state,
+     * so an equilibrated lattice only needs a short re-equilibration at the new immune fraction.
+     */
+    static void changeImmuneFraction(StateVector &states, double immuneFraction, RandomStream &generator);
+
+    /**
+     *\brief Changes the number of immune cells in the board, see changeImmuneFraction.
+     *\param immuneFraction floating point value representing the new fraction of immune cells.
+     *\param generator RandomStream reference for random number generation.
+     */
+    void setImmuneFraction(double immuneFraction, RandomStream &generator);
+
+    /**
+     *\brief Randomises the cells in the board with equal probability of being susceptible, infected or recovered.
      *\param std::deafult_random_engine reference for random number generation.
+     *
+     * Immune cells are left where they are so the immune fraction does not change.
      */
-    void randomise(std::default_random_engine &generator);
+    void randomise(RandomStream &generator);
 
     /**
      *\brief Getter for the number of rows.
@@ -138,6 +316,15 @@ public:
      */
     int getSize() const;
 
+    /**
+     *\brief Getter for the underlying cell data, stored row by row.
+     *\return constant reference to the vector holding the state of every cell, cell (row,col) is at col + row * getCols().
+     *
+     * This is meant for measurements that scan the whole lattice and want to avoid the periodic
+     * indexing of operator().
+     */
+    const StateVector& getBoardData() const;
+
     /**
      *\brief Getter for the probability of going from susceptible to infected upon contact between two cells.
      *\return Floating point value representing the probability of going from susceptible to infected upon contact.
@@ -174,6 +361,40 @@ public:
      */
     void setProbRS(double prob);
 
+    /**
+     *\brief Gives every cell the probabilities of its region instead of the lattice wide ones.
+     *\param regions RegionMap reference with the same number of rows and columns as the lattice.
+     *
+     * Only kernels built with RegionFeature use the regions, the lattice wide probabilities are then
+     * ignored. Throws std::invalid_argument if the map is the wrong size.
+     */
+    void setRegions(const RegionMap &regions);
+
+    /**
+     *\brief Determines whether a region map has been set.
+     *\return Boolean value representing whether the cells have per region probabilities.
+     */
+    bool hasRegions() const;
+
+    /**
+     *\brief Makes sweeps draw their sites in batches from a stream of their own.
+     *\param batchSize integer value representing the number of sites drawn at a time, 0 to go back to drawing
+     * each site from the update generator as it is updated.
+     *\param siteStream RandomStream the sites are drawn from.
+     *
+     * The random numbers of the updates no longer share a generator with the sites, so the sites can
+     * be drawn ahead and their cells prefetched while earlier cells are updated. Any batch size of 1
+     * or more gives the same sequence of states for the same streams, but not the sequence of a
+     * lattice without batching, which draws different random numbers.
+     */
+    void setBatching(int batchSize, const RandomStream &siteStream);
+
+    /**
+     *\brief Getter for the number of sites drawn at a time.
+     *\return Integer value, 0 if each site is drawn as it is updated.
+     */
+    int getBatchSize() const;
+
 
     /**
      *\brief Determines whether cell has an infected neighbour.
@@ -185,22 +406,80 @@ public:
      */
     bool hasInfectedNeighbour(int row, int col) const;
 
+    /**
+     *\brief Determines whether cell has an infected neighbour within an arbitrary stencil.
+     *\param row row of cell in question, must be in the range [0,getRows()).
+     *\param col column of cell in question, must be in the range [0,getCols()).
+     *\return Boolean value representing whether the cell has an infected neighbour
+     *
+     * Stencil is one of the types in Neighbourhood.hpp, the loop over its offsets is unrolled at
+     * compile time. The stencil radius must be smaller than both lattice dimensions.
+     */
+    template<class Stencil>
+    bool hasInfectedNeighbour(int row, int col) const;
+
+    /**
+     *\brief Counts the infected neighbours of a cell within an arbitrary stencil.
+     *\param row row of cell in question, must be in the range [0,getRows()).
+     *\param col column of cell in question, must be in the range [0,getCols()).
+     *\return Integer value representing the number of infected neighbours.
+     */
+    template<class Stencil>
+    int countInfectedNeighbours(int row, int col) const;
+
     /**
      *\brief Updates the state of a single cell based on the current 
      * state of the cell, its neighbours and the probabilities.
      *\pram row Integer value representing the row of the cell in question.
      *\param col Integer value representing the column of the cell in question.
-     *\param generator std::default_random_engine for random number generation.
+     *\param generator RandomStream for random number generation.
      *\return the new updated state of the cell.
      */
-    SIRSArray::State updateCell(int row, int col, std::default_random_engine& generator);
+    SIRSArray::State updateCell(int row, int col, RandomStream& generator);
 
     /**
      *\brief Updates a random cell in the grid.
-     *\param std::default_random_engine reference for random number generation.
+     *\param RandomStream reference for random number generation.
      *\return the new updated state of the cell.
      */
-    SIRSArray::State update(std::default_random_engine& generator);
+    SIRSArray::State update(RandomStream& generator);
+
+    /**
+     *\brief Specialised version of updateCell for a given stencil and set of features.
+     *\param row Integer value representing the row of the cell, must be in the range [0,getRows()).
+     *\param col Integer value representing the column of the cell, must be in the range [0,getCols()).
+     *\param generator RandomStream for random number generation.
+     *\return the new updated state of the cell.
+     *
+     * Features is a combination of the Feature flags. Without ImmunityFeature the lattice must not
+     * contain any Immune cells, with RegionFeature a region map must have been set. With
+     * NeighbourCountFeature the counts must be up to date, which sweep makes sure of.
+     */
+    template<class Stencil, unsigned Features>
+    SIRSArray::State updateCell(int row, int col, RandomStream& generator);
+
+    /**
+     *\brief Performs one sweep, getSize() updates of randomly chosen cells, using a specialised kernel.
+     *\param generator RandomStream for random number generation.
+     *
+     * A kernel built with NeighbourCountFeature first rebuilds the counts if anything else has changed
+     * the cells since they were last kept, any other kernel leaves them to be rebuilt. With batching
+     * set the sites come from the site stream a batch at a time, each cell being prefetched
+     * prefetchDistance updates before it is updated, otherwise they come from generator.
+     */
+    template<class Stencil, unsigned Features>
+    void sweep(RandomStream& generator);
+
+    /**
+     *\brief Selects the sweep kernel specialised for a neighbourhood and set of features.
+     *\param type NeighbourhoodType value representing the shape of the neighbourhood.
+     *\param radius Integer value in the range [1,maxNeighbourhoodRadius] for the size of the neighbourhood.
+     *\param features combination of the Feature flags the kernel must support.
+     *\return SweepFunction to call on the lattice once per sweep, nullptr if there is no such kernel.
+     *
+     * This is meant to be called once at startup so the per-update hot loop contains no dispatch.
+     */
+    static SweepFunction selectSweep(NeighbourhoodType type, int radius, unsigned features);
 
     /**
      *\brief calculates the total number of cells in a given state.
@@ -226,4 +505,253 @@ public:
 
 };
 
+template<class Stencil, unsigned Built, unsigned Bit>
+struct SIRSArray::FeatureDispatch
+{
+    static SIRSArray::SweepFunction select(unsigned features)
+    {
+        return (features & (1u << Bit)) ?
+            FeatureDispatch<Stencil, Built | (1u << Bit), Bit + 1>::select(features) :
+            FeatureDispatch<Stencil, Built, Bit + 1>::select(features);
+    }
+};
+
+template<class Stencil, unsigned Built>
+struct SIRSArray::FeatureDispatch<Stencil, Built, SIRSArray::featureBits>
+{
+    static SIRSArray::SweepFunction select(unsigned)
+    {
+        return &SIRSArray::sweep<Stencil, Built>;
+    }
+};
+
+inline int SIRSArray::wrapIndex(int index, int period)
+{
+    return index < 0 ? index + period : (index >= period ? index - period : index);
+}
+
+template<class Stencil>
+bool SIRSArray::hasInfectedNeighbour(int row, int col) const
+{
+    for(int dr = -Stencil::radius; dr <= Stencil::radius; ++dr)
+    {
+        // Start of the row this offset lands on, taking into account periodic boundary conditions.
+        const State *rowData = &m_boardData[wrapIndex(row + dr, m_rowCount) * m_colCount];
+
+        for(int dc = -Stencil::radius; dc <= Stencil::radius; ++dc)
+        {
+            if(Stencil::contains(dr, dc) && SIRSArray::Infected == rowData[wrapIndex(col + dc, m_colCount)])
+            {
+                return true;
+            }
+        }
+    }
+
+    // Otherwise there are no infected neighbours.
+    return false;
+}
+
+template<class Stencil>
+int SIRSArray::countInfectedNeighbours(int row, int col) const
+{
+    int count = 0;
+    for(int dr = -Stencil::radius; dr <= Stencil::radius; ++dr)
+    {
+        const State *rowData = &m_boardData[wrapIndex(row + dr, m_rowCount) * m_colCount];
+
+        for(int dc = -Stencil::radius; dc <= Stencil::radius; ++dc)
+        {
+            if(Stencil::contains(dr, dc) && SIRSArray::Infected == rowData[wrapIndex(col + dc, m_colCount)])
+            {
+                ++count;
+            }
+        }
+    }
+
+    return count;
+}
+
+template<class Stencil>
+void SIRSArray::addToNeighbourCounts(int row, int col, int change)
+{
+    for(int dr = -Stencil::radius; dr <= Stencil::radius; ++dr)
+    {
+        std::uint8_t *rowCounts = &m_infectedNeighbours[wrapIndex(row + dr, m_rowCount) * m_colCount];
+
+        for(int dc = -Stencil::radius; dc <= Stencil::radius; ++dc)
+        {
+            if(Stencil::contains(dr, dc))
+            {
+                rowCounts[wrapIndex(col + dc, m_colCount)] += change;
+            }
+        }
+    }
+}
+
+template<class Stencil>
+void SIRSArray::rebuildNeighbourCounts()
+{
+    m_infectedNeighbours.assign(m_boardData.size(), 0);
+
+    for(int row = 0; row < m_rowCount; ++row)
+    {
+        for(int col = 0; col < m_colCount; ++col)
+        {
+            if(SIRSArray::Infected == m_boardData[col + row * m_colCount])
+            {
+                addToNeighbourCounts<Stencil>(row, col, 1);
+            }
+        }
+    }
+
+    m_neighbourCountsStale = false;
+}
+
+template<class Stencil, unsigned Features>
+void SIRSArray::prefetchCell(int index) const
+{
+    const int row = index / m_colCount;
+    const int col = index - row * m_colCount;
+
+    for(int dr = -Stencil::radius; dr <= Stencil::radius; ++dr)
+    {
+        __builtin_prefetch(&m_boardData[col + wrapIndex(row + dr, m_rowCount) * m_colCount], 1);
+    }
+
+    if(Features & NeighbourCountFeature)
+    {
+        __builtin_prefetch(&m_infectedNeighbours[index], 1);
+    }
+
+    if(Features & RegionFeature)
+    {
+        __builtin_prefetch(&m_regionData[index]);
+    }
+}
+
+template<class Stencil, unsigned Features>
+SIRSArray::State SIRSArray::updateCell(int row, int col, RandomStream& generator)
+{
+    const int index = col + row * m_colCount;
+    State &cell = m_boardData[index];
+
+    // Probabilities of the cell's region, the table is small enough to stay in cache. Kernels without
+    // regions never touch it.
+    const RegionMap::Probabilities *region = (Features & RegionFeature) ? &m_regionTable[m_regionData[index]] : nullptr;
+
+    // Immune cells never change so there is nothing to do, this check only exists in kernels that
+    // were asked for it.
+    if((Features & ImmunityFeature) && State::Immune == cell)
+    {
+        return cell;
+    }
+
+    if(State::Susceptible == cell)
+    {
+        // A random number is only drawn if there is an infected neighbour, whichever way they are found,
+        // so keeping the counts does not change the sequence of states.
+        bool infected;
+        if(Features & ContactFeature)
+        {
+            const int count = (Features & NeighbourCountFeature) ? m_infectedNeighbours[index] : countInfectedNeighbours<Stencil>(row, col);
+            infected = count > 0 && generator.uniform() <
+                ((Features & RegionFeature) ? 1.0 - std::pow(1.0 - region->probSI, count) : m_contactProbability[count]);
+        }
+        else
+        {
+            const bool exposed = (Features & NeighbourCountFeature) ? (0 != m_infectedNeighbours[index]) : hasInfectedNeighbour<Stencil>(row, col);
+            infected = exposed && generator.uniform() < ((Features & RegionFeature) ? region->probSI : m_probSI);
+        }
+
+        if(infected)
+        {
+            cell = State::Infected;
+            if(Features & NeighbourCountFeature)
+            {
+                addToNeighbourCounts<Stencil>(row, col, 1);
+            }
+        }
+    }
+    else if(State::Infected == cell)
+    {
+        if(generator.uniform() < ((Features & RegionFeature) ? region->probIR : m_probIR))
+        {
+            cell = State::Recovered;
+            if(Features & NeighbourCountFeature)
+            {
+                addToNeighbourCounts<Stencil>(row, col, -1);
+            }
+        }
+    }
+    else if(generator.uniform() < ((Features & RegionFeature) ? region->probRS : m_probRS))
+    {
+        cell = State::Susceptible;
+    }
+
+    return cell;
+}
+
+template<class Stencil, unsigned Features>
+void SIRSArray::sweep(RandomStream& generator)
+{
+    // Create a uniform distribution for the rows and columns remembering to subtract 1 for the closed limits.
+    std::uniform_int_distribution<int> rowDistribution(0,m_rowCount-1);
+    std::uniform_int_distribution<int> colDistribution(0,m_colCount-1);
+
+    if(Features & NeighbourCountFeature)
+    {
+        if(m_neighbourCountsStale)
+        {
+            rebuildNeighbourCounts<Stencil>();
+        }
+    }
+    else
+    {
+        m_neighbourCountsStale = true;
+    }
+
+    const int size = getSize();
+    if(0 == m_batchSize)
+    {
+        for(int i = 0; i < size; ++i)
+        {
+            int row = rowDistribution(generator);
+            int col = colDistribution(generator);
+            updateCell<Stencil, Features>(row, col, generator);
+        }
+        return;
+    }
+
+    // The updates are still made in the order the sites are drawn, so the batch size only changes
+    // how far ahead the cells are asked for.
+    std::vector<int> sites(std::min(m_batchSize, size));
+    for(int begin = 0; begin < size; begin += m_batchSize)
+    {
+        const int count = std::min(m_batchSize, size - begin);
+        for(int n = 0; n < count; ++n)
+        {
+            // Separate statements fix the order of the two draws, which the operands of + would not.
+            const int col = colDistribution(m_siteStream);
+            const int row = rowDistribution(m_siteStream);
+            sites[n] = col + row * m_colCount;
+        }
+
+        for(int n = 0; n < std::min(prefetchDistance, count); ++n)
+        {
+            prefetchCell<Stencil, Features>(sites[n]);
+        }
+
+        for(int n = 0; n < count; ++n)
+        {
+            if(n + prefetchDistance < count)
+            {
+                prefetchCell<Stencil, Features>(sites[n + prefetchDistance]);
+            }
+
+            const int row = sites[n] / m_colCount;
+            updateCell<Stencil, Features>(row, sites[n] - row * m_colCount, generator);
+        }
+    }
+}
+
 #endif /* SIRSArray_hpp */
\ No newline at end of file
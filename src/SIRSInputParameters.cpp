@@ -6,10 +6,47 @@ std::ostream& operator<<(std::ostream& out, const SIRSInputParameters& params)
     out << "Input-Parameters..." << '\n';
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Rows: " << std::right << params.rowCount << '\n';
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Columns: " << std::right << params.colCount << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Dimensions: " << std::right << params.dimensions << '\n';
+    if(!params.axisSizes.empty())
+    {
+        std::string sizes;
+        for(const auto &size : params.axisSizes)
+        {
+            sizes += (sizes.empty() ? "" : "x") + std::to_string(size);
+        }
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Sizes: " << std::right << sizes << '\n';
+    }
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "p_1: " << std::right << params.probSI << '\n';
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "p_2: " << std::right << params.probIR << '\n';
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "p_3: " << std::right << params.probRS << '\n';
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Immune-Fraction: " << std::right << params.immuneFraction << '\n';
+    if(!params.regionMapFile.empty())
+    {
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Region-Map: " << std::right << params.regionMapFile << '\n';
+    }
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Neighbourhood: " << std::right << params.neighbourhood << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Radius: " << std::right << params.radius << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Infection: " << std::right << params.infection << '\n';
+    if(params.neighbourCounts)
+    {
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Neighbour-Counts: " << std::right << "on" << '\n';
+    }
+    if(params.batchSize > 0)
+    {
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Batch-Size: " << std::right << params.batchSize << '\n';
+    }
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Engine: " << std::right << params.engine << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Tau: " << std::right << params.tau << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Threads: " << std::right << params.threadCount << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Seed: " << std::right << params.seed << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Topology: " << std::right << params.topology << '\n';
+    if("lattice" != params.topology)
+    {
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Nodes: " << std::right << params.nodeCount << '\n';
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Mean-Degree: " << std::right << params.meanDegree << '\n';
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Rewire-Probability: " << std::right << params.rewireProbability << '\n';
+        out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Edge-List: " << std::right << params.edgeListFile << '\n';
+    }
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Burn-Period: " << std::right << params.burnPeriod << '\n';
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Sweeps: " << std::right << params.sweeps << '\n';
     out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Measurement-Interval: " << std::right << params.measurementInterval << '\n';
@@ -3,38 +3,74 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <cstdint>
+#include <vector>
 /**
  *\file 
  *\class SIRSInputParameters
  *\brief Class for easily handling input parameters of SIRS simulation.
  *
  * This class essentially just holds some values and has an operator to easily output
- * them to a stream.
+ * them to a stream. The default values are the same as the defaults on the command line.
  */
 class SIRSInputParameters 
 {
 public:
 	
 	/// Number of rows in lattice.
-	int rowCount;
+	int rowCount = 50;
 	/// Number of columns in lattice.
-	int colCount;
+	int colCount = 50;
 	/// Probability of cell going from susceptible to infected upon contact.
-	double probSI;
+	double probSI = 1.0;
 	/// Probability of cell going from infected to recovered.
-	double probIR;
+	double probIR = 1.0;
 	/// Probability of cell going from recovered to susceptible.
-	double probRS;
+	double probRS = 1.0;
 	/// Number of discarded sweeps before recording starts.
-	int burnPeriod;
+	int burnPeriod = 5000;
 	/// Total number of sweeps in the simulation.
-	int sweeps;
+	int sweeps = 10000;
 	/// Interval at which measurements are made.
-	int measurementInterval;
+	int measurementInterval = 10;
 	/// Output directory.
 	std::string outputDirectory;
 	/// Fraction of immune agents.
-	double immuneFraction;
+	double immuneFraction = 0.0;
+	/// Shape of the neighbourhood of each cell.
+	std::string neighbourhood = "von-neumann";
+	/// Radius of the neighbourhood of each cell.
+	int radius = 1;
+	/// Rule for infecting a susceptible cell, any (any infected neighbour) or per-contact (each infected neighbour).
+	std::string infection = "any";
+	/// Whether the 2D lattice keeps the number of infected neighbours of every cell up to date.
+	bool neighbourCounts = false;
+	/// Number of sites the 2D lattice draws and prefetches ahead of updating them, 0 to draw each site as it is updated.
+	int batchSize = 0;
+	/// Engine used to advance the lattice.
+	std::string engine = "exact";
+	/// Time step of the tau-leaping engine.
+	double tau = 0.1;
+	/// Number of threads used by the parallel engines.
+	int threadCount = 1;
+	/// Seed all of the random numbers in the run are derived from.
+	std::uint64_t seed = 0;
+	/// Binary map file giving each cell of the lattice a region with its own probabilities, none if empty.
+	std::string regionMapFile;
+	/// Number of dimensions of the lattice.
+	int dimensions = 2;
+	/// Number of cells along each axis of a lattice that is not 2D, every axis has rowCount cells if empty.
+	std::vector<int> axisSizes;
+	/// Contact structure, lattice, small-world, scale-free or edge-list.
+	std::string topology = "lattice";
+	/// Number of nodes of a generated network.
+	int nodeCount = 2500;
+	/// Mean degree of a generated network.
+	int meanDegree = 4;
+	/// Probability each edge of a small-world network is rewired.
+	double rewireProbability = 0.1;
+	/// File the edge-list topology is read from.
+	std::string edgeListFile;
 
 
 
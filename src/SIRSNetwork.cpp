@@ -0,0 +1,491 @@
+#include "SIRSNetwork.hpp"
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+#include <stdexcept>
+#include <limits>
+#include <iomanip>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    /**
+     *\brief Parses a non-negative node index and advances the position past it.
+     *\param position reference to a pointer into the file, left on the first character after the number.
+     *\param end pointer one past the end of the file.
+     *\return Integer value of the index, -1 if there is no number at the position or it does not fit in an int.
+     */
+    long long parseIndex(const char *&position, const char *end)
+    {
+        if(position == end || *position < '0' || *position > '9')
+        {
+            return -1;
+        }
+
+        long long value = 0;
+        for(; position != end && *position >= '0' && *position <= '9'; ++position)
+        {
+            value = 10 * value + (*position - '0');
+            if(value > std::numeric_limits<int>::max() - 1)
+            {
+                return -1;
+            }
+        }
+
+        return value;
+    }
+
+    /**
+     *\brief Calls edge(a, b) for every edge in a memory mapped edge list.
+     *\param begin pointer to the first character of the file.
+     *\param end pointer one past the last character of the file.
+     *\param fileName string holding the path of the file for error messages.
+     *\param edge callable invoked with the two node indices of each edge.
+     */
+    template<class EdgeFunction>
+    void forEachEdge(const char *begin, const char *end, const std::string &fileName, EdgeFunction edge)
+    {
+        auto skipBlanks = [end](const char *&position)
+        {
+            while(position != end && (' ' == *position || '\t' == *position || '\r' == *position))
+            {
+                ++position;
+            }
+        };
+
+        int line = 1;
+        for(const char *position = begin; position != end; ++line)
+        {
+            skipBlanks(position);
+
+            // Blank lines and comments are skipped, anything after the two indices is ignored so
+            // weighted edge lists can be read too.
+            if(position != end && '\n' != *position && '#' != *position && '%' != *position)
+            {
+                long long a = parseIndex(position, end);
+                skipBlanks(position);
+                long long b = parseIndex(position, end);
+
+                if(a < 0 || b < 0)
+                {
+                    throw std::invalid_argument("Invalid edge on line " + std::to_string(line) + " of " + fileName);
+                }
+
+                edge(static_cast<int>(a), static_cast<int>(b));
+            }
+
+            while(position != end && '\n' != *(position++));
+        }
+    }
+}
+
+SIRSNetwork::SIRSNetwork() : m_offsets(1, 0), m_probSI{1.0}, m_probIR{1.0}, m_probRS{1.0}
+{
+
+}
+
+void SIRSNetwork::buildFromEdges(int nodeCount, const std::vector<std::pair<int, int> > &edges)
+{
+    // Count the degrees, turn them into offsets then drop each edge into both of its rows.
+    m_offsets.assign(nodeCount + 1, 0);
+    for(const auto &edge : edges)
+    {
+        ++m_offsets[edge.first + 1];
+        ++m_offsets[edge.second + 1];
+    }
+    std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+
+    std::vector<std::size_t> cursor(m_offsets.begin(), m_offsets.end() - 1);
+    m_neighbours.resize(m_offsets.back());
+    for(const auto &edge : edges)
+    {
+        m_neighbours[cursor[edge.first]++]  = edge.second;
+        m_neighbours[cursor[edge.second]++] = edge.first;
+    }
+
+    m_stateData.assign(nodeCount, SIRSArray::Susceptible);
+    compact();
+}
+
+void SIRSNetwork::compact()
+{
+    std::size_t write = 0;
+    for(int node = 0; node < getSize(); ++node)
+    {
+        auto first = m_neighbours.begin() + m_offsets[node];
+        auto last  = m_neighbours.begin() + m_offsets[node + 1];
+        std::sort(first, last);
+        last = std::unique(first, last);
+
+        m_offsets[node] = write;
+        for(; first != last; ++first)
+        {
+            if(*first != node)
+            {
+                m_neighbours[write++] = *first;
+            }
+        }
+    }
+
+    m_offsets.back() = write;
+    m_neighbours.resize(write);
+    m_neighbours.shrink_to_fit();
+}
+
+void SIRSNetwork::reorder()
+{
+    const int nodeCount = getSize();
+
+    // Components are started from the lowest degree unvisited node, ties broken by index.
+    std::vector<int> byDegree(nodeCount);
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    auto lowerDegree = [this](int a, int b) { return getDegree(a) < getDegree(b); };
+    std::stable_sort(byDegree.begin(), byDegree.end(), lowerDegree);
+
+    // Cuthill-McKee order, the order vector doubles as the breadth first queue.
+    std::vector<int> order;
+    order.reserve(nodeCount);
+    std::vector<char> visited(nodeCount, 0);
+    for(int start : byDegree)
+    {
+        if(visited[start])
+        {
+            continue;
+        }
+
+        visited[start] = 1;
+        order.push_back(start);
+        for(std::size_t head = order.size() - 1; head < order.size(); ++head)
+        {
+            const int node = order[head];
+            const std::size_t firstNew = order.size();
+            for(std::size_t edge = m_offsets[node]; edge < m_offsets[node + 1]; ++edge)
+            {
+                if(!visited[m_neighbours[edge]])
+                {
+                    visited[m_neighbours[edge]] = 1;
+                    order.push_back(m_neighbours[edge]);
+                }
+            }
+            std::stable_sort(order.begin() + firstNew, order.end(), lowerDegree);
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    std::vector<int> position(nodeCount);
+    for(int index = 0; index < nodeCount; ++index)
+    {
+        position[order[index]] = index;
+    }
+
+    // Rebuild the rows in the new order with the neighbours renumbered.
+    OffsetVector offsets(nodeCount + 1, 0);
+    NeighbourVector neighbours(m_neighbours.size());
+    SIRSArray::StateVector states(nodeCount);
+    for(int index = 0; index < nodeCount; ++index)
+    {
+        const int node = order[index];
+        std::size_t write = offsets[index];
+        for(std::size_t edge = m_offsets[node]; edge < m_offsets[node + 1]; ++edge)
+        {
+            neighbours[write++] = position[m_neighbours[edge]];
+        }
+        std::sort(neighbours.begin() + offsets[index], neighbours.begin() + write);
+
+        offsets[index + 1] = write;
+        states[index] = m_stateData[node];
+    }
+
+    m_offsets.swap(offsets);
+    m_neighbours.swap(neighbours);
+    m_stateData.swap(states);
+}
+
+SIRSNetwork SIRSNetwork::wattsStrogatz(int nodeCount, int degree, double rewireProbability, RandomStream &generator)
+{
+    if(nodeCount < 2 || degree < 2 || degree % 2 != 0 || degree >= nodeCount)
+    {
+        throw std::invalid_argument("Watts-Strogatz networks need an even degree of at least 2 and less than the number of nodes");
+    }
+
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::uniform_int_distribution<int> otherNode(0, nodeCount - 2);
+
+    // Ring of nodes each joined to degree/2 neighbours on either side, every edge then has its far
+    // end moved to a random node with the rewiring probability.
+    std::vector<std::pair<int, int> > edges;
+    edges.reserve(static_cast<std::size_t>(nodeCount) * degree / 2);
+    for(int node = 0; node < nodeCount; ++node)
+    {
+        for(int step = 1; step <= degree / 2; ++step)
+        {
+            int target = (node + step) % nodeCount;
+            if(distribution(generator) < rewireProbability)
+            {
+                target = otherNode(generator);
+                target += (target >= node) ? 1 : 0;
+            }
+
+            edges.push_back(std::make_pair(node, target));
+        }
+    }
+
+    SIRSNetwork network;
+    network.buildFromEdges(nodeCount, edges);
+    network.reorder();
+    return network;
+}
+
+SIRSNetwork SIRSNetwork::barabasiAlbert(int nodeCount, int attachments, RandomStream &generator)
+{
+    if(attachments < 1 || nodeCount <= attachments)
+    {
+        throw std::invalid_argument("Barabasi-Albert networks need at least one attachment and more nodes than attachments");
+    }
+
+    std::vector<std::pair<int, int> > edges;
+    edges.reserve(static_cast<std::size_t>(nodeCount) * attachments);
+
+    // Both ends of every edge, drawing uniformly from this picks nodes in proportion to their degree.
+    std::vector<int> endpoints;
+    endpoints.reserve(2 * edges.capacity());
+
+    for(int a = 0; a <= attachments; ++a)
+    {
+        for(int b = a + 1; b <= attachments; ++b)
+        {
+            edges.push_back(std::make_pair(a, b));
+            endpoints.push_back(a);
+            endpoints.push_back(b);
+        }
+    }
+
+    std::vector<int> targets;
+    for(int node = attachments + 1; node < nodeCount; ++node)
+    {
+        std::uniform_int_distribution<std::size_t> endpointDistribution(0, endpoints.size() - 1);
+
+        targets.clear();
+        while(static_cast<int>(targets.size()) < attachments)
+        {
+            int target = endpoints[endpointDistribution(generator)];
+            if(std::find(targets.begin(), targets.end(), target) == targets.end())
+            {
+                targets.push_back(target);
+            }
+        }
+
+        for(int target : targets)
+        {
+            edges.push_back(std::make_pair(node, target));
+            endpoints.push_back(node);
+            endpoints.push_back(target);
+        }
+    }
+
+    SIRSNetwork network;
+    network.buildFromEdges(nodeCount, edges);
+    network.reorder();
+    return network;
+}
+
+SIRSNetwork SIRSNetwork::loadEdgeList(const std::string &fileName)
+{
+    int descriptor = open(fileName.c_str(), O_RDONLY);
+    struct stat fileStatus;
+    if(descriptor < 0 || fstat(descriptor, &fileStatus) != 0)
+    {
+        if(descriptor >= 0)
+        {
+            close(descriptor);
+        }
+        throw std::invalid_argument("Cannot read edge list: " + fileName);
+    }
+
+    SIRSNetwork network;
+    if(0 == fileStatus.st_size)
+    {
+        close(descriptor);
+        return network;
+    }
+
+    void *mapping = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if(MAP_FAILED == mapping)
+    {
+        throw std::invalid_argument("Cannot map edge list: " + fileName);
+    }
+
+    const char *begin = static_cast<const char*>(mapping);
+    const char *end   = begin + fileStatus.st_size;
+    madvise(mapping, fileStatus.st_size, MADV_SEQUENTIAL);
+
+    try
+    {
+        // First pass counts the degrees, growing the node count as larger indices turn up.
+        OffsetVector &offsets = network.m_offsets;
+        forEachEdge(begin, end, fileName, [&offsets](int a, int b)
+        {
+            std::size_t largest = std::max(a, b);
+            if(largest + 2 > offsets.size())
+            {
+                offsets.resize(largest + 2, 0);
+            }
+            ++offsets[a + 1];
+            ++offsets[b + 1];
+        });
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        // Second pass drops each edge into both of its rows.
+        std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+        NeighbourVector &neighbours = network.m_neighbours;
+        neighbours.resize(offsets.back());
+        forEachEdge(begin, end, fileName, [&cursor, &neighbours](int a, int b)
+        {
+            neighbours[cursor[a]++] = b;
+            neighbours[cursor[b]++] = a;
+        });
+    }
+    catch(...)
+    {
+        munmap(mapping, fileStatus.st_size);
+        throw;
+    }
+    munmap(mapping, fileStatus.st_size);
+
+    network.m_stateData.assign(network.m_offsets.size() - 1, SIRSArray::Susceptible);
+    network.compact();
+    network.reorder();
+    return network;
+}
+
+void SIRSNetwork::initialise(std::uint64_t seed, double immuneFraction)
+{
+    SIRSArray::initialiseStates(m_stateData, seed, immuneFraction);
+}
+
+void SIRSNetwork::setImmuneFraction(double immuneFraction, RandomStream &generator)
+{
+    SIRSArray::changeImmuneFraction(m_stateData, immuneFraction, generator);
+}
+
+void SIRSNetwork::setProbabilities(double probSI, double probIR, double probRS)
+{
+    m_probSI = probSI;
+    m_probIR = probIR;
+    m_probRS = probRS;
+}
+
+int SIRSNetwork::getSize() const
+{
+    return m_stateData.size();
+}
+
+std::size_t SIRSNetwork::getEdgeCount() const
+{
+    return m_neighbours.size() / 2;
+}
+
+int SIRSNetwork::getDegree(int node) const
+{
+    return m_offsets[node + 1] - m_offsets[node];
+}
+
+int SIRSNetwork::bandwidth() const
+{
+    int width = 0;
+    for(int node = 0; node < getSize(); ++node)
+    {
+        // Neighbours are sorted so only the first and last need checking.
+        if(getDegree(node) > 0)
+        {
+            width = std::max(width, std::abs(node - m_neighbours[m_offsets[node]]));
+            width = std::max(width, std::abs(m_neighbours[m_offsets[node + 1] - 1] - node));
+        }
+    }
+
+    return width;
+}
+
+const SIRSArray::StateVector& SIRSNetwork::getStateData() const
+{
+    return m_stateData;
+}
+
+bool SIRSNetwork::hasInfectedNeighbour(int node) const
+{
+    for(std::size_t edge = m_offsets[node]; edge < m_offsets[node + 1]; ++edge)
+    {
+        if(SIRSArray::Infected == m_stateData[m_neighbours[edge]])
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+SIRSArray::State SIRSNetwork::updateNode(int node, RandomStream &generator)
+{
+    SIRSArray::State &state = m_stateData[node];
+
+    if(SIRSArray::Susceptible == state)
+    {
+        if(hasInfectedNeighbour(node) && generator.uniform() < m_probSI)
+        {
+            state = SIRSArray::Infected;
+        }
+    }
+    else if(SIRSArray::Infected == state)
+    {
+        if(generator.uniform() < m_probIR)
+        {
+            state = SIRSArray::Recovered;
+        }
+    }
+    else if(SIRSArray::Recovered == state && generator.uniform() < m_probRS)
+    {
+        state = SIRSArray::Susceptible;
+    }
+
+    return state;
+}
+
+void SIRSNetwork::sweep(RandomStream &generator)
+{
+    const int size = getSize();
+    std::uniform_int_distribution<int> nodeDistribution(0, size - 1);
+
+    for(int i = 0; i < size; ++i)
+    {
+        updateNode(nodeDistribution(generator), generator);
+    }
+}
+
+int SIRSNetwork::stateCount(SIRSArray::State state) const
+{
+    return std::count(m_stateData.begin(), m_stateData.end(), state);
+}
+
+double SIRSNetwork::stateFraction(SIRSArray::State state) const
+{
+    return static_cast<double>(stateCount(state)) / getSize();
+}
+
+std::ostream& operator<<(std::ostream &out, const SIRSNetwork &network)
+{
+    int outputColumnWidth = 30;
+    out << "Network..." << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Nodes: " <<
+    std::right << network.getSize() << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Edges: " <<
+    std::right << network.getEdgeCount() << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Mean-Degree: " <<
+    std::right << 2.0 * network.getEdgeCount() / std::max(1, network.getSize()) << '\n';
+    out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Bandwidth: " <<
+    std::right << network.bandwidth() << '\n';
+    return out;
+}
@@ -0,0 +1,217 @@
+#ifndef SIRSNetwork_hpp
+#define SIRSNetwork_hpp
+
+#include "SIRSArray.hpp" // For the State enumeration shared with the lattice.
+#include <vector>
+#include <random>
+#include <string>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+/**
+ *\file
+ *\class SIRSNetwork
+ *\brief Class to model the SIRS model on an arbitrary undirected contact network.
+ *
+ * The cells follow exactly the same rules as on SIRSArray, the only difference is that the
+ * neighbours of a node are its contacts on the network rather than a stencil on a lattice.
+ * Adjacency is held in compressed sparse row form: the neighbours of node n are
+ * m_neighbours[m_offsets[n]] to m_neighbours[m_offsets[n+1]-1], sorted, without self loops or
+ * repeated edges. Once built the nodes are renumbered with the reverse Cuthill-McKee ordering so
+ * that the neighbours of a node are stored close to it, which keeps the infected neighbour checks
+ * in cache on large networks.
+ */
+class SIRSNetwork
+{
+private:
+    /// Vector of the start of each node's neighbours.
+    using OffsetVector = std::vector<std::size_t, HugePageAllocator<std::size_t> >;
+
+    /// Vector of neighbour indices.
+    using NeighbourVector = std::vector<int, HugePageAllocator<int> >;
+
+    /// Member variable holding the start of each node's neighbours, one more entry than there are nodes.
+    OffsetVector m_offsets;
+
+    /// Member variable holding the neighbours of every node one after another.
+    NeighbourVector m_neighbours;
+
+    /// Member variable that holds the state of every node.
+    SIRSArray::StateVector m_stateData;
+
+    /// Member variable for the probability of going from susceptible to infected.
+    double m_probSI;
+
+    /// Member variable for the probability of going from infected to recovered.
+    double m_probIR;
+
+    /// Member variable for the probability of going from recovered to susceptible.
+    double m_probRS;
+
+    /**
+     *\brief Constructor for an empty network, used by the factory functions.
+     */
+    SIRSNetwork();
+
+    /**
+     *\brief Builds the adjacency from a list of undirected edges.
+     *\param nodeCount integer value representing the number of nodes.
+     *\param edges vector of pairs of node indices, each edge only needs to appear once.
+     */
+    void buildFromEdges(int nodeCount, const std::vector<std::pair<int, int> > &edges);
+
+    /**
+     *\brief Sorts each node's neighbours and removes self loops and repeated edges.
+     *
+     * Called once the offsets and neighbours have been filled, the arrays are compacted in place.
+     */
+    void compact();
+
+    /**
+     *\brief Renumbers the nodes with the reverse Cuthill-McKee ordering.
+     *
+     * Each connected component is walked breadth first from one of its lowest degree nodes, visiting
+     * the neighbours of each node in order of increasing degree, and the final order is reversed.
+     */
+    void reorder();
+
+public:
+    /**
+     *\brief Creates a Watts-Strogatz small world network.
+     *\param nodeCount integer value representing the number of nodes.
+     *\param degree even integer value representing the number of neighbours of each node on the initial ring.
+     *\param rewireProbability floating point value representing the probability each edge is rewired.
+     *\param generator RandomStream reference for random number generation.
+     *\return SIRSNetwork instance with every node susceptible.
+     *
+     * Rewired edges keep one end and move the other to a uniformly random node other than itself, an
+     * edge rewired onto an existing one is dropped.
+     */
+    static SIRSNetwork wattsStrogatz(int nodeCount, int degree, double rewireProbability, RandomStream &generator);
+
+    /**
+     *\brief Creates a Barabasi-Albert scale free network by preferential attachment.
+     *\param nodeCount integer value representing the number of nodes.
+     *\param attachments integer value representing the number of edges each new node brings.
+     *\param generator RandomStream reference for random number generation.
+     *\return SIRSNetwork instance with every node susceptible.
+     *
+     * The network grows from a complete graph of attachments+1 nodes, each new node is connected to
+     * that many distinct existing nodes chosen with probability proportional to their degree.
+     */
+    static SIRSNetwork barabasiAlbert(int nodeCount, int attachments, RandomStream &generator);
+
+    /**
+     *\brief Loads a network from a text file with one edge per line.
+     *\param fileName string holding the path of the edge list.
+     *\return SIRSNetwork instance with every node susceptible.
+     *
+     * Each line holds two non-negative node indices separated by white space, lines starting with
+     * # or % are comments. The file is memory mapped and read twice, once to count the degrees and
+     * once to fill in the neighbours, so the edges are never held in memory as a list. The number of
+     * nodes is one more than the largest index. Throws std::invalid_argument if the file cannot be
+     * read or contains something other than an edge.
+     */
+    static SIRSNetwork loadEdgeList(const std::string &fileName);
+
+    /**
+     *\brief Fills the network with an even mix of susceptible, infected and recovered nodes plus exactly
+     * round(immuneFraction * size) immune nodes, see SIRSArray::initialise.
+     *\param seed 64 bit seed the states are generated from.
+     *\param immuneFraction floating point value representing the fraction of nodes that are immune.
+     */
+    void initialise(std::uint64_t seed, double immuneFraction);
+
+    /**
+     *\brief Changes the number of immune nodes, see SIRSArray::changeImmuneFraction.
+     *\param immuneFraction floating point value representing the new fraction of immune nodes.
+     *\param generator RandomStream reference for random number generation.
+     */
+    void setImmuneFraction(double immuneFraction, RandomStream &generator);
+
+    /**
+     *\brief Setter for all three transition probabilities.
+     *\param probSI probability of going from susceptible to infected if the node has an infected neighbour.
+     *\param probIR probability of infected node going from infected to recovered.
+     *\param probRS probability of recovered node becoming susceptible again.
+     */
+    void setProbabilities(double probSI, double probIR, double probRS);
+
+    /**
+     *\brief Getter for the number of nodes.
+     *\return Integer value representing the number of nodes.
+     */
+    int getSize() const;
+
+    /**
+     *\brief Getter for the number of undirected edges.
+     *\return Integer value representing the number of edges.
+     */
+    std::size_t getEdgeCount() const;
+
+    /**
+     *\brief Getter for the number of neighbours of a node.
+     *\param node integer value representing the node, in the range [0,getSize()).
+     *\return Integer value representing the degree of the node.
+     */
+    int getDegree(int node) const;
+
+    /**
+     *\brief Calculates the bandwidth of the adjacency matrix in the current node order.
+     *\return Integer value representing the largest difference between the indices of two neighbours.
+     */
+    int bandwidth() const;
+
+    /**
+     *\brief Getter for the state of every node.
+     *\return constant reference to the vector holding the state of every node.
+     */
+    const SIRSArray::StateVector& getStateData() const;
+
+    /**
+     *\brief Determines whether a node has an infected neighbour.
+     *\param node integer value representing the node, in the range [0,getSize()).
+     *\return Boolean value representing whether the node has an infected neighbour.
+     */
+    bool hasInfectedNeighbour(int node) const;
+
+    /**
+     *\brief Updates the state of a single node based on its state, its neighbours and the probabilities.
+     *\param node integer value representing the node, in the range [0,getSize()).
+     *\param generator RandomStream for random number generation.
+     *\return the new updated state of the node.
+     */
+    SIRSArray::State updateNode(int node, RandomStream &generator);
+
+    /**
+     *\brief Performs one sweep, getSize() updates of randomly chosen nodes.
+     *\param generator RandomStream for random number generation.
+     */
+    void sweep(RandomStream &generator);
+
+    /**
+     *\brief calculates the total number of nodes in a given state.
+     *\param state value representing the state of interest.
+     *\return Integer value representing the total number of nodes in the state of interest.
+     */
+    int stateCount(SIRSArray::State state) const;
+
+    /**
+     *\brief calculates the fraction of nodes in a given state.
+     *\param state value representing the state of interest.
+     *\return Floating point value representing the fraction of nodes in the state of interest.
+     */
+    double stateFraction(SIRSArray::State state) const;
+
+    /**
+     *\brief operator<< overload for outputting a summary of the network.
+     *\param out std::ostream reference that is being streamed to.
+     *\param network constant SIRSNetwork reference to be output.
+     *\return std::ostream reference so the operator can be chained.
+     */
+    friend std::ostream& operator<<(std::ostream &out, const SIRSNetwork &network);
+};
+
+#endif /* SIRSNetwork_hpp */
@@ -8,5 +8,18 @@ std::ostream& operator<<(std::ostream &out, const SIRSResults &results)
    	std::right << results.orderParameter << " +/- " << results.orderParameterError << '\n';
    	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Susceptibility: " << 
    	std::right << results.susceptibility << " +/- " << results.susceptibilityError << '\n';
+   	out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Effective-Samples: " << 
+   	std::right << results.effectiveSampleSize << '\n';
+
+   	// Replica lines only appear for ensembles so single runs keep their layout.
+   	if(results.replicaCount > 1)
+   	{
+   		out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Replicas: " << 
+   		std::right << results.replicaCount << '\n';
+   		out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Between-Replica-Error: " << 
+   		std::right << results.betweenReplicaError << '\n';
+   		out << std::setw(outputColumnWidth) << std::setfill(' ') << std::left << "Within-Replica-Error: " << 
+   		std::right << results.withinReplicaError << '\n';
+   	}
 	return out;
 }
\ No newline at end of file
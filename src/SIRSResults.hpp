@@ -16,12 +16,22 @@ class SIRSResults
 public:
 	/// Order parameter.
 	double orderParameter;
-	/// Order parameter error.
+	/// Order parameter error, corrected for autocorrelation by blocking.
 	double orderParameterError;
 	/// Susceptibility.
 	double susceptibility;
 	/// Susceptibility error.
 	double susceptibilityError;
+	/// Number of independent measurements the order parameter series is worth.
+	double effectiveSampleSize;
+	/// Number of independent replicas combined, 0 or 1 for a single run.
+	int replicaCount;
+	/// Order parameter error from the spread of the replica averages.
+	double betweenReplicaError;
+	/// Order parameter error from the blocked errors of the replicas combined.
+	double withinReplicaError;
+	/// Number of cells or nodes simulated, the order parameter is the infected fraction of them.
+	int population;
 
 	/** 
 	 *\brief operator<< overload for outputting the results.
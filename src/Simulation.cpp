@@ -0,0 +1,531 @@
+#include "Simulation.hpp"
+#include "RandomStream.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+Simulation::Simulation(
+	const SIRSInputParameters &parameters,
+	RandomStream &generator
+	) : Simulation(parameters, &generator, 0)
+{
+
+}
+
+Simulation::Simulation(
+	const SIRSInputParameters &parameters,
+	std::uint64_t replica
+	) : Simulation(parameters, nullptr, replica)
+{
+
+}
+
+Simulation::Simulation(
+	const SIRSInputParameters &parameters,
+	RandomStream *generator,
+	std::uint64_t replica
+	) : m_parameters(parameters),
+		m_replica{replica},
+		m_ownedGenerator(parameters.seed, RandomStream::makeStreamId(RandomStream::MainPurpose, replica, 0)),
+		m_generator(generator ? *generator : m_ownedGenerator),
+		m_lattice(m_generator,
+			("lattice" == parameters.topology && 2 == parameters.dimensions) ? parameters.rowCount : 0,
+			("lattice" == parameters.topology && 2 == parameters.dimensions) ? parameters.colCount : 0,
+			parameters.probSI,
+			parameters.probIR,
+			parameters.probRS,
+			parameters.immuneFraction,
+			parameters.threadCount),
+		m_orderParameterData(parameters.sweeps/parameters.measurementInterval),
+		m_features{0},
+		m_counters{nullptr}
+{
+	// The estimators ask for the population when they are evaluated, after the geometry has been built.
+	static const char *fractionNames[SIRSArray::MAXSTATE] = {"Susceptible-Fraction", "Infected-Fraction", "Recovered-Fraction", "Immune-Fraction"};
+	for(int state = 0; state < SIRSArray::MAXSTATE; ++state)
+	{
+		m_measurements.addEstimator(fractionNames[state], [this, state](const double *means, const double *)
+		{
+			return means[state]/populationSize();
+		});
+	}
+
+	m_measurements.addEstimator("Susceptibility", [this](const double *means, const double *squareMeans)
+	{
+		return (squareMeans[SIRSArray::Infected] - means[SIRSArray::Infected] * means[SIRSArray::Infected])/populationSize();
+	});
+	m_measurements.reserve(parameters.sweeps/parameters.measurementInterval + 1);
+
+	if(parameters.threadCount < 1)
+	{
+		throw std::invalid_argument("Thread count must be at least 1 but got " + std::to_string(parameters.threadCount));
+	}
+
+	if(!parameters.regionMapFile.empty() && ("lattice" != parameters.topology || 2 != parameters.dimensions))
+	{
+		throw std::invalid_argument("Region maps are only supported on the 2D lattice");
+	}
+
+	if("any" != parameters.infection && "per-contact" != parameters.infection)
+	{
+		throw std::invalid_argument("Unknown infection rule: " + parameters.infection);
+	}
+
+	// Only the 2D lattice kernels know how many neighbours are infected.
+	if(("per-contact" == parameters.infection || parameters.neighbourCounts) &&
+		("lattice" != parameters.topology || 2 != parameters.dimensions || "exact" != parameters.engine))
+	{
+		throw std::invalid_argument("Per-contact infection and neighbour counts are only supported by the exact engine on the 2D lattice");
+	}
+
+	// Only the 2D lattice kernels draw their sites in batches.
+	if(parameters.batchSize < 0 || (parameters.batchSize > 0 &&
+		("lattice" != parameters.topology || 2 != parameters.dimensions || "exact" != parameters.engine)))
+	{
+		throw std::invalid_argument("Batched sweeps are only supported by the exact engine on the 2D lattice");
+	}
+
+	// A whole number of tau-leap steps must make up a sweep, written this way round NaN fails too.
+	if("tau-leap" == parameters.engine && !(parameters.tau > 0 && 1.0 / parameters.tau <= std::numeric_limits<int>::max()))
+	{
+		std::ostringstream message;
+		message << "The tau-leap time step must be positive and at least 1/" << std::numeric_limits<int>::max() << ", not " << parameters.tau;
+		throw std::invalid_argument(message.str());
+	}
+
+	// main maps two axis sizes onto the rows and columns, any other number would be silently ignored.
+	if("lattice" == parameters.topology && 2 == parameters.dimensions && !parameters.axisSizes.empty() && 2 != parameters.axisSizes.size())
+	{
+		throw std::invalid_argument("Expected 2 axis sizes but got " + std::to_string(parameters.axisSizes.size()));
+	}
+
+	// Networks replace the lattice entirely and only have the exact engine.
+	if("lattice" != parameters.topology)
+	{
+		if("exact" != parameters.engine)
+		{
+			throw std::invalid_argument("The " + parameters.engine + " engine only supports the lattice topology");
+		}
+
+		if("small-world" == parameters.topology)
+		{
+			m_network.reset(new SIRSNetwork(SIRSNetwork::wattsStrogatz(
+				parameters.nodeCount,
+				parameters.meanDegree,
+				parameters.rewireProbability,
+				m_generator)));
+		}
+		else if("scale-free" == parameters.topology)
+		{
+			// Each new node brings half of the mean degree's worth of edges.
+			m_network.reset(new SIRSNetwork(SIRSNetwork::barabasiAlbert(
+				parameters.nodeCount,
+				parameters.meanDegree/2,
+				m_generator)));
+		}
+		else if("edge-list" == parameters.topology)
+		{
+			m_network.reset(new SIRSNetwork(SIRSNetwork::loadEdgeList(parameters.edgeListFile)));
+		}
+		else
+		{
+			throw std::invalid_argument("Unknown topology: " + parameters.topology);
+		}
+
+		if(0 == m_network->getSize())
+		{
+			throw std::invalid_argument("The network has no nodes");
+		}
+
+		std::uniform_int_distribution<std::uint64_t> seedDistribution;
+		m_network->setProbabilities(parameters.probSI, parameters.probIR, parameters.probRS);
+		m_network->initialise(seedDistribution(m_generator), parameters.immuneFraction);
+		return;
+	}
+
+	// Any other dimension uses the nearest neighbour lattice of that dimension and the exact engine.
+	if(2 != parameters.dimensions)
+	{
+		if("exact" != parameters.engine || "von-neumann" != parameters.neighbourhood || 1 != parameters.radius)
+		{
+			throw std::invalid_argument("Lattices that are not 2D only support the exact engine with a von-neumann neighbourhood of radius 1");
+		}
+
+		std::vector<int> sizes = parameters.axisSizes;
+		if(sizes.empty())
+		{
+			sizes.assign(std::max(0, parameters.dimensions), parameters.rowCount);
+		}
+
+		if(static_cast<int>(sizes.size()) != parameters.dimensions)
+		{
+			throw std::invalid_argument("Expected " + std::to_string(parameters.dimensions) + " axis sizes but got " + std::to_string(sizes.size()));
+		}
+
+		std::uniform_int_distribution<std::uint64_t> seedDistribution;
+		m_hyperLattice = HyperLatticeBase::create(sizes, parameters.probSI, parameters.probIR, parameters.probRS);
+		m_hyperLattice->initialise(seedDistribution(m_generator), parameters.immuneFraction, parameters.threadCount);
+		return;
+	}
+
+	// Select the update kernel once so there is no dispatch in the main loop. Only ask for the immunity
+	// check if there can actually be immune cells on the lattice.
+	NeighbourhoodType neighbourhood = parseNeighbourhood(parameters.neighbourhood);
+	m_features = (parameters.immuneFraction != 0) ? SIRSArray::ImmunityFeature : 0;
+
+	// Per region probabilities replace the lattice wide ones.
+	if(!parameters.regionMapFile.empty())
+	{
+		m_lattice.setRegions(RegionMap::load(parameters.regionMapFile));
+		m_features |= SIRSArray::RegionFeature;
+	}
+
+	if(parameters.neighbourCounts)
+	{
+		m_features |= SIRSArray::NeighbourCountFeature;
+	}
+
+	if("per-contact" == parameters.infection)
+	{
+		m_features |= SIRSArray::ContactFeature;
+	}
+
+	m_sweepKernel = SIRSArray::selectSweep(neighbourhood, parameters.radius, m_features);
+
+	// Batched sites come from a stream of their own so the batch size cannot change the dynamics.
+	if(parameters.batchSize > 0)
+	{
+		m_lattice.setBatching(parameters.batchSize, RandomStream(parameters.seed, RandomStream::makeStreamId(RandomStream::SitePurpose, m_replica, 0)));
+	}
+
+	if(nullptr == m_sweepKernel || parameters.radius >= std::min(parameters.rowCount, parameters.colCount))
+	{
+		throw std::invalid_argument("Unsupported neighbourhood: " + parameters.neighbourhood +
+			" with radius " + std::to_string(parameters.radius));
+	}
+
+	// Create the approximate engine if it was asked for, otherwise the specialised exact kernel is used.
+	if("tau-leap" == parameters.engine)
+	{
+		std::uniform_int_distribution<std::uint64_t> seedDistribution;
+		m_tauLeapEngine.reset(new TauLeapEngine(
+			m_lattice,
+			parameters.tau,
+			neighbourhood,
+			parameters.radius,
+			parameters.threadCount,
+			seedDistribution(m_generator),
+			m_replica));
+	}
+	else if("exact" != parameters.engine)
+	{
+		throw std::invalid_argument("Unknown engine: " + parameters.engine);
+	}
+}
+
+void Simulation::addMeasurementCallback(MeasurementCallback callback)
+{
+	m_measurementCallbacks.push_back(callback);
+}
+
+void Simulation::setSweepCallback(SweepCallback callback)
+{
+	m_sweepCallback = callback;
+}
+
+void Simulation::setPerfCounters(PerfCounters *counters)
+{
+	m_counters = counters;
+}
+
+const SIRSInputParameters& Simulation::getParameters() const
+{
+	return m_parameters;
+}
+
+const SIRSArray& Simulation::getLattice() const
+{
+	return m_lattice;
+}
+
+const SIRSNetwork* Simulation::getNetwork() const
+{
+	return m_network.get();
+}
+
+const HyperLatticeBase* Simulation::getHyperLattice() const
+{
+	return m_hyperLattice.get();
+}
+
+const SIRSArray::StateVector& Simulation::getStateData() const
+{
+	if(m_network)
+	{
+		return m_network->getStateData();
+	}
+
+	return m_hyperLattice ? m_hyperLattice->getStateData() : m_lattice.getBoardData();
+}
+
+int Simulation::populationSize() const
+{
+	if(m_network)
+	{
+		return m_network->getSize();
+	}
+
+	return m_hyperLattice ? m_hyperLattice->getSize() : m_lattice.getSize();
+}
+
+const DataArray& Simulation::getOrderParameterData() const
+{
+	return m_orderParameterData;
+}
+
+MeasurementSeries& Simulation::getMeasurements()
+{
+	return m_measurements;
+}
+
+const MeasurementSeries& Simulation::getMeasurements() const
+{
+	return m_measurements;
+}
+
+const std::vector<MeasurementSeries::Estimate>& Simulation::getEstimates() const
+{
+	return m_estimates;
+}
+
+void Simulation::sweep()
+{
+	if(m_network)
+	{
+		m_network->sweep(m_generator);
+	}
+	else if(m_hyperLattice)
+	{
+		m_hyperLattice->sweep(m_generator);
+	}
+	else if(m_tauLeapEngine)
+	{
+		m_tauLeapEngine->sweep(m_lattice);
+	}
+	else
+	{
+		(m_lattice.*m_sweepKernel)(m_generator);
+	}
+}
+
+void Simulation::setProbabilities(double probSI, double probIR, double probRS)
+{
+	if(m_lattice.hasRegions())
+	{
+		throw std::invalid_argument("The probabilities of a lattice with a region map come from the map");
+	}
+
+	m_parameters.probSI = probSI;
+	m_parameters.probIR = probIR;
+	m_parameters.probRS = probRS;
+
+	if(m_network)
+	{
+		m_network->setProbabilities(probSI, probIR, probRS);
+	}
+	else if(m_hyperLattice)
+	{
+		m_hyperLattice->setProbabilities(probSI, probIR, probRS);
+	}
+	else
+	{
+		// The tau-leap engine reads the lattice probabilities on every step.
+		m_lattice.setProbSI(probSI);
+		m_lattice.setProbIR(probIR);
+		m_lattice.setProbRS(probRS);
+	}
+}
+
+void Simulation::setImmuneFraction(double immuneFraction)
+{
+	m_parameters.immuneFraction = immuneFraction;
+
+	if(m_network)
+	{
+		m_network->setImmuneFraction(immuneFraction, m_generator);
+		return;
+	}
+
+	if(m_hyperLattice)
+	{
+		m_hyperLattice->setImmuneFraction(immuneFraction, m_generator);
+		return;
+	}
+
+	m_lattice.setImmuneFraction(immuneFraction, m_generator);
+
+	// The kernel selected without immunity never checks for immune cells, so swap it for one that does.
+	if(immuneFraction != 0)
+	{
+		m_features |= SIRSArray::ImmunityFeature;
+		m_sweepKernel = SIRSArray::selectSweep(parseNeighbourhood(m_parameters.neighbourhood), m_parameters.radius, m_features);
+	}
+}
+
+void Simulation::randomise()
+{
+	std::uniform_int_distribution<std::uint64_t> seedDistribution;
+
+	if(m_network)
+	{
+		m_network->initialise(seedDistribution(m_generator), m_parameters.immuneFraction);
+	}
+	else if(m_hyperLattice)
+	{
+		m_hyperLattice->initialise(seedDistribution(m_generator), m_parameters.immuneFraction, m_parameters.threadCount);
+	}
+	else
+	{
+		m_lattice.randomise(m_generator);
+	}
+}
+
+int Simulation::equilibrate(int window, int maxSweeps, double tolerance)
+{
+	const SIRSArray::StateVector &cells = getStateData();
+	const double size = populationSize();
+	window = std::max(1, window);
+
+	// Compare the average infected fraction over consecutive windows, averaging keeps the noise of a
+	// single sweep from passing for convergence.
+	double previousAverage = -1;
+	int sweepCount = 0;
+	while(sweepCount < maxSweeps)
+	{
+		double infectedSum = 0;
+		int infected = 0;
+		int windowSweeps = 0;
+		for(; windowSweeps < window && sweepCount < maxSweeps; ++windowSweeps, ++sweepCount)
+		{
+			sweep();
+			infected = std::count(cells.begin(), cells.end(), SIRSArray::Infected);
+			infectedSum += infected;
+		}
+
+		// maxSweeps can cut the last window short, so average over the sweeps it actually has.
+		const double average = infectedSum / windowSweeps / size;
+		if(0 == infected || (previousAverage >= 0 && std::abs(average - previousAverage) < tolerance))
+		{
+			break;
+		}
+
+		previousAverage = average;
+	}
+
+	return sweepCount;
+}
+
+SIRSResults Simulation::run()
+{
+	return run(m_parameters.burnPeriod);
+}
+
+SIRSResults Simulation::run(int burnPeriod)
+{
+	const int totalSweeps 		  = m_parameters.sweeps;
+	const int measurementInterval = m_parameters.measurementInterval;
+	const int size 				  = populationSize();
+
+	m_orderParameterData = DataArray(totalSweeps/measurementInterval);
+	m_measurements.clear();
+
+	for(int sweepIndex = 0; sweepIndex < totalSweeps+burnPeriod; ++sweepIndex)
+	{
+		// The counters are read whenever the phase changes. Measurements and the sweep callback are both
+		// charged to the analysis, so without a sweep callback only measurement sweeps read them, but with
+		// one (animation, frames or telemetry) they are read on entering and leaving every sweep.
+		if(m_counters)
+		{
+			PerfCounters::Phase phase = (sweepIndex < burnPeriod) ? PerfCounters::BurnPhase : PerfCounters::SweepPhase;
+			m_counters->enter(phase);
+			m_counters->addUpdates(phase, size);
+		}
+
+		sweep();
+
+		// If we are on a measurement sweep then do any measurement.
+		if((0 == sweepIndex%measurementInterval) && (sweepIndex >= burnPeriod))
+		{
+			if(m_counters)
+			{
+				m_counters->enter(PerfCounters::AnalysisPhase);
+			}
+
+			// Record every observable in one pass over the cells, the order parameter is the infected count.
+			MeasurementSeries::StateCounts counts = m_measurements.record(sweepIndex, getStateData());
+			double orderParameter = counts[SIRSArray::Infected];
+			m_orderParameterData.push_back(orderParameter);
+
+			for(const auto &callback : m_measurementCallbacks)
+			{
+				callback(sweepIndex, orderParameter, m_lattice);
+			}
+		}
+
+		if(m_sweepCallback)
+		{
+			if(m_counters)
+			{
+				m_counters->enter(PerfCounters::AnalysisPhase);
+			}
+
+			m_sweepCallback(sweepIndex, m_lattice);
+		}
+	}
+
+	if(m_counters)
+	{
+		m_counters->enter(PerfCounters::AnalysisPhase);
+	}
+
+	// Average the order parameter and calculate the error, blocking takes care of the autocorrelation
+	// between measurements.
+	DataArray::BlockingAnalysis blocking = m_orderParameterData.blocking();
+	double orderParameterAverage = m_orderParameterData.mean()/size;
+	double orderParameterError   = blocking.error/size;
+
+	// Evaluate every estimator together, the ``Susceptibility'' of the order parameter is one of them.
+	RandomStream bootstrapStream(m_parameters.seed, RandomStream::makeStreamId(RandomStream::BootstrapPurpose, m_replica, 0));
+	m_estimates = m_measurements.analyse(bootstrapStream);
+
+	double susceptibility 	   = 0;
+	double susceptibilityError = 0;
+	for(const auto &estimate : m_estimates)
+	{
+		if("Susceptibility" == estimate.name)
+		{
+			susceptibility 	    = estimate.value;
+			susceptibilityError = estimate.jackKnifeError;
+		}
+	}
+
+	if(m_counters)
+	{
+		m_counters->leave();
+	}
+
+	return SIRSResults
+	{
+		orderParameterAverage,
+		orderParameterError,
+		susceptibility,
+		susceptibilityError,
+		blocking.effectiveSampleSize,
+		1,
+		0.0,
+		orderParameterError,
+		populationSize(),
+	};
+}
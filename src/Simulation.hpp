@@ -0,0 +1,250 @@
+#ifndef Simulation_hpp
+#define Simulation_hpp
+
+#include "SIRSArray.hpp"
+#include "SIRSInputParameters.hpp"
+#include "SIRSResults.hpp"
+#include "DataArray.hpp"
+#include "TauLeapEngine.hpp"
+#include "SIRSNetwork.hpp"
+#include "HyperLattice.hpp"
+#include "MeasurementSeries.hpp"
+#include "PerfCounters.hpp"
+#include <random>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+/**
+ *\file
+ *\class Simulation
+ *\brief Class that drives a complete SIRS simulation in-process: burn in, sweeps, measurements and analysis.
+ *
+ * The simulation never touches the filesystem, callers that want output register callbacks which are
+ * invoked on measurement sweeps and/or after every sweep. This lets other tools run many short
+ * simulations by linking against libsirs instead of spawning the sirs executable.
+ *
+ * If the parameters ask for a network topology the cells live on a SIRSNetwork instead of the lattice,
+ * and if they ask for anything other than two dimensions on a HyperLattice. The 2D lattice is then left
+ * empty and the measurement and sweep callbacks receive it that way.
+ */
+class Simulation
+{
+public:
+	/// Callback invoked on every measurement sweep with the sweep index, the number of infected cells and the lattice.
+	using MeasurementCallback = std::function<void(int sweep, double orderParameter, const SIRSArray &lattice)>;
+
+	/// Callback invoked after every sweep, including burn in, with the sweep index and the lattice.
+	using SweepCallback = std::function<void(int sweep, const SIRSArray &lattice)>;
+
+private:
+	/// Member variable holding the parameters the simulation was created with.
+	SIRSInputParameters m_parameters;
+
+	/// Member variable for the replica the simulation belongs to, it selects the random streams.
+	std::uint64_t m_replica;
+
+	/// Member variable for the main stream of the replica, used when the caller does not provide a generator.
+	RandomStream m_ownedGenerator;
+
+	/// Member variable for the generator used by the simulation, either m_ownedGenerator or owned by the caller.
+	RandomStream &m_generator;
+
+	/// Member variable holding the lattice being simulated.
+	SIRSArray m_lattice;
+
+	/// Member variable for the exact kernel selected for the neighbourhood and features.
+	SIRSArray::SweepFunction m_sweepKernel;
+
+	/// Member variable for the approximate engine, null when the exact engine is used.
+	std::unique_ptr<TauLeapEngine> m_tauLeapEngine;
+
+	/// Member variable holding the contact network, null when the cells live on the lattice.
+	std::unique_ptr<SIRSNetwork> m_network;
+
+	/// Member variable holding the lattice of any other dimension, null when the cells live on the 2D lattice.
+	std::unique_ptr<HyperLatticeBase> m_hyperLattice;
+
+	/// Member variable holding the order parameter recorded on each measurement sweep.
+	DataArray m_orderParameterData;
+
+	/// Member variable holding every observable recorded on each measurement sweep.
+	MeasurementSeries m_measurements;
+
+	/// Member variable holding the estimates from the last run.
+	std::vector<MeasurementSeries::Estimate> m_estimates;
+
+	/// Member variable holding the measurement callbacks in the order they were added.
+	std::vector<MeasurementCallback> m_measurementCallbacks;
+
+	/// Member variable for the sweep callback, may be empty.
+	SweepCallback m_sweepCallback;
+
+	/// Member variable holding the SIRSArray::Feature flags the 2D lattice kernel was selected with.
+	unsigned m_features;
+
+	/// Member variable pointing to the hardware counters the phases of a run are attributed to, may be null.
+	PerfCounters *m_counters;
+
+	/**
+	 *\brief Constructor both public constructors delegate to.
+	 *\param parameters SIRSInputParameters reference describing the simulation.
+	 *\param generator pointer to the caller's generator, or nullptr to seed m_ownedGenerator from parameters.seed.
+	 *\param replica integer value for the replica the simulation belongs to.
+	 */
+	Simulation(const SIRSInputParameters &parameters, RandomStream *generator, std::uint64_t replica);
+
+	/**
+	 *\brief Calculates the number of cells in whichever geometry is being simulated.
+	 *\return Integer value representing the number of cells.
+	 */
+	int populationSize() const;
+
+public:
+	/**
+	 *\brief Constructor that creates a randomised lattice and selects the engine.
+	 *\param parameters SIRSInputParameters reference describing the simulation, the output directory is ignored.
+	 *\param generator RandomStream reference for random number generation, must outlive the simulation.
+	 *
+	 * Throws std::invalid_argument if the parameters ask for an unknown engine, neighbourhood, topology or dimension.
+	 */
+	Simulation(const SIRSInputParameters &parameters, RandomStream &generator);
+
+	/**
+	 *\brief Constructor for a simulation whose random numbers are all derived from parameters.seed.
+	 *\param parameters SIRSInputParameters reference describing the simulation, the output directory is ignored.
+	 *\param replica integer value for the replica, simulations of different replicas use independent streams.
+	 *
+	 * Two simulations created from the same parameters and replica produce the same results whatever the thread count.
+	 * Throws std::invalid_argument if the parameters ask for an unknown engine, neighbourhood, topology or dimension.
+	 */
+	explicit Simulation(const SIRSInputParameters &parameters, std::uint64_t replica = 0);
+
+	/**
+	 *\brief Adds a callback to be invoked on each measurement sweep.
+	 *\param callback MeasurementCallback to store, callbacks are invoked in the order they were added.
+	 */
+	void addMeasurementCallback(MeasurementCallback callback);
+
+	/**
+	 *\brief Setter for the callback invoked after every sweep.
+	 *\param callback SweepCallback to store.
+	 */
+	void setSweepCallback(SweepCallback callback);
+
+	/**
+	 *\brief Setter for the hardware counters that burn in, sweeps and analysis are attributed to.
+	 *\param counters pointer to PerfCounters that must outlive every run, nullptr to stop counting.
+	 */
+	void setPerfCounters(PerfCounters *counters);
+
+	/**
+	 *\brief Getter for the parameters of the simulation.
+	 *\return constant SIRSInputParameters reference.
+	 */
+	const SIRSInputParameters& getParameters() const;
+
+	/**
+	 *\brief Getter for the lattice being simulated.
+	 *\return constant SIRSArray reference.
+	 */
+	const SIRSArray& getLattice() const;
+
+	/**
+	 *\brief Getter for the cells of whichever geometry is being simulated.
+	 *\return constant reference to the vector holding the state of every cell.
+	 */
+	const SIRSArray::StateVector& getStateData() const;
+
+	/**
+	 *\brief Getter for the contact network.
+	 *\return constant SIRSNetwork pointer, nullptr when the simulation runs on the lattice.
+	 */
+	const SIRSNetwork* getNetwork() const;
+
+	/**
+	 *\brief Getter for the lattice when it is not two dimensional.
+	 *\return constant HyperLatticeBase pointer, nullptr when the simulation runs on the 2D lattice or a network.
+	 */
+	const HyperLatticeBase* getHyperLattice() const;
+
+	/**
+	 *\brief Getter for the order parameter recorded so far.
+	 *\return constant DataArray reference holding the number of infected cells on each measurement sweep.
+	 */
+	const DataArray& getOrderParameterData() const;
+
+	/**
+	 *\brief Getter for the measurements, observables and estimators can be added before run is called.
+	 *\return MeasurementSeries reference.
+	 *
+	 * The state fractions and the susceptibility are registered as estimators by the constructor.
+	 */
+	MeasurementSeries& getMeasurements();
+
+	/**
+	 *\brief constant version of getMeasurements().
+	 *\return constant MeasurementSeries reference.
+	 */
+	const MeasurementSeries& getMeasurements() const;
+
+	/**
+	 *\brief Getter for the estimates of the last run.
+	 *\return constant reference to the vector of estimates, empty before run is called.
+	 */
+	const std::vector<MeasurementSeries::Estimate>& getEstimates() const;
+
+	/**
+	 *\brief Advances the lattice by one sweep with the selected engine.
+	 */
+	void sweep();
+
+	/**
+	 *\brief Changes the transition probabilities of the cells that are already being simulated.
+	 *\param probSI probability of going from susceptible to infected if the cell has an infected neighbour.
+	 *\param probIR probability of infected cell going from infected to recovered.
+	 *\param probRS probability of recovered cell becoming susceptible again.
+	 *
+	 * Throws std::invalid_argument on a lattice with a region map, whose probabilities come from the map.
+	 */
+	void setProbabilities(double probSI, double probIR, double probRS);
+
+	/**
+	 *\brief Changes the fraction of immune cells, see SIRSArray::changeImmuneFraction.
+	 *\param immuneFraction floating point value representing the new fraction of immune cells.
+	 */
+	void setImmuneFraction(double immuneFraction);
+
+	/**
+	 *\brief Gives every cell that is not immune a random state, as at the start of a simulation.
+	 */
+	void randomise();
+
+	/**
+	 *\brief Sweeps until the infected fraction stops drifting, in place of a full burn period.
+	 *\param window integer value representing the number of sweeps averaged over before each comparison.
+	 *\param maxSweeps integer value representing the most sweeps to make.
+	 *\param tolerance floating point value representing the largest change in the average infected fraction
+	 * between consecutive windows that counts as equilibrated.
+	 *\return Integer value representing the number of sweeps made.
+	 *
+	 * Stops early if the infection dies out since nothing can change after that.
+	 */
+	int equilibrate(int window, int maxSweeps, double tolerance);
+
+	/**
+	 *\brief Runs the burn period and measurement sweeps then analyses the recorded order parameter.
+	 *\return SIRSResults instance holding the averages and errors, normalised by the lattice size.
+	 */
+	SIRSResults run();
+
+	/**
+	 *\brief Runs the measurement sweeps after a given burn period, discarding any earlier measurements.
+	 *\param burnPeriod integer value representing the number of sweeps before measurements start, 0 after equilibrate.
+	 *\return SIRSResults instance holding the averages and errors, normalised by the lattice size.
+	 */
+	SIRSResults run(int burnPeriod);
+};
+
+#endif /* Simulation_hpp */
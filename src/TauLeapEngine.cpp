@@ -0,0 +1,214 @@
+#include "TauLeapEngine.hpp"
+#include "parallelFor.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/// State each state moves to when it makes a transition.
+	const SIRSArray::State successorState[SIRSArray::MAXSTATE] =
+	{
+		SIRSArray::Infected,
+		SIRSArray::Recovered,
+		SIRSArray::Susceptible,
+		SIRSArray::Immune,
+	};
+}
+
+TauLeapEngine::TauLeapEngine(
+	const SIRSArray &lattice,
+	double tau,
+	NeighbourhoodType type,
+	int radius,
+	int threadCount,
+	std::uint64_t seed,
+	std::uint64_t replica
+	) : m_stepsPerSweep{std::max(1, static_cast<int>(std::ceil(1.0 / tau)))},
+		m_threadCount{std::max(1, std::min(threadCount, lattice.getRows()))},
+		m_radius{radius},
+		m_stepKernel{nullptr},
+		m_stream(seed),
+		m_replica{replica},
+		m_stepCount{0},
+		m_infected((lattice.getRows() + 2 * radius) * (lattice.getCols() + 2 * radius), 0),
+		m_nextBoard(lattice.getSize())
+{
+	// Round the time step down so that a whole number of steps make up one sweep.
+	m_tau = 1.0 / m_stepsPerSweep;
+
+	switch(type)
+	{
+		case VonNeumannNeighbourhood :
+			switch(radius)
+			{
+				case 1 : m_stepKernel = &TauLeapEngine::stepRows<VonNeumann<1> >; break;
+				case 2 : m_stepKernel = &TauLeapEngine::stepRows<VonNeumann<2> >; break;
+				case 3 : m_stepKernel = &TauLeapEngine::stepRows<VonNeumann<3> >; break;
+				default: break;
+			}
+			break;
+
+		case MooreNeighbourhood :
+			switch(radius)
+			{
+				case 1 : m_stepKernel = &TauLeapEngine::stepRows<Moore<1> >; break;
+				case 2 : m_stepKernel = &TauLeapEngine::stepRows<Moore<2> >; break;
+				case 3 : m_stepKernel = &TauLeapEngine::stepRows<Moore<3> >; break;
+				default: break;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+double TauLeapEngine::getTau() const
+{
+	return m_tau;
+}
+
+void TauLeapEngine::fillInfected(const SIRSArray &lattice, int rowBegin, int rowEnd)
+{
+	const int cols = lattice.m_colCount;
+	const int paddedCols = cols + 2 * m_radius;
+
+	for(int row = rowBegin; row < rowEnd; ++row)
+	{
+		const SIRSArray::State *source = &lattice.m_boardData[row * cols];
+		unsigned char *target = &m_infected[(row + m_radius) * paddedCols];
+
+		for(int col = 0; col < cols; ++col)
+		{
+			target[col + m_radius] = (SIRSArray::Infected == source[col]);
+		}
+
+		// Periodic boundary conditions along the row.
+		for(int pad = 0; pad < m_radius; ++pad)
+		{
+			target[pad] = target[cols + pad];
+			target[cols + m_radius + pad] = target[m_radius + pad];
+		}
+	}
+}
+
+template<class Stencil>
+void TauLeapEngine::stepRows(SIRSArray &lattice, int rowBegin, int rowEnd)
+{
+	const int cols = lattice.m_colCount;
+	const int paddedCols = cols + 2 * m_radius;
+
+	// Every step has its own stream and each row starts at a fixed offset into it, two numbers per block.
+	const RandomStream stepStream = m_stream.split(RandomStream::makeStreamId(RandomStream::TauLeapPurpose, m_replica, m_stepCount));
+	const std::uint64_t blocksPerRow = (cols + 1) / 2;
+
+	// Per row scratch space, kept separate so the loops below are simple enough to vectorise.
+	std::vector<unsigned char> hasInfected(cols);
+	std::vector<double> uniforms(cols);
+
+	for(int row = rowBegin; row < rowEnd; ++row)
+	{
+		std::fill(hasInfected.begin(), hasInfected.end(), 0);
+
+		for(int dr = -Stencil::radius; dr <= Stencil::radius; ++dr)
+		{
+			const unsigned char *infectedRow = &m_infected[(row + m_radius + dr) * paddedCols + m_radius];
+			for(int dc = -Stencil::radius; dc <= Stencil::radius; ++dc)
+			{
+				if(Stencil::contains(dr, dc))
+				{
+					for(int col = 0; col < cols; ++col)
+					{
+						hasInfected[col] |= infectedRow[col + dc];
+					}
+				}
+			}
+		}
+
+		RandomStream rowStream = stepStream;
+		rowStream.jump(row * blocksPerRow);
+		for(int col = 0; col < cols; ++col)
+		{
+			uniforms[col] = rowStream.uniform();
+		}
+
+		const SIRSArray::State *current = &lattice.m_boardData[row * cols];
+		SIRSArray::State *next = &m_nextBoard[row * cols];
+		const double *transitionProbability = m_transitionProbability.data();
+
+		if(lattice.hasRegions())
+		{
+			const std::uint8_t *regions = &lattice.m_regionData[row * cols];
+			for(int col = 0; col < cols; ++col)
+			{
+				SIRSArray::State state = current[col];
+				double probability = transitionProbability[(regions[col] * SIRSArray::MAXSTATE + state) * 2 + hasInfected[col]];
+				next[col] = (uniforms[col] < probability) ? successorState[state] : state;
+			}
+		}
+		else
+		{
+			for(int col = 0; col < cols; ++col)
+			{
+				SIRSArray::State state = current[col];
+				double probability = transitionProbability[state * 2 + hasInfected[col]];
+				next[col] = (uniforms[col] < probability) ? successorState[state] : state;
+			}
+		}
+	}
+}
+
+void TauLeapEngine::step(SIRSArray &lattice)
+{
+	// Probability of at least one successful attempt in a Poisson(tau) number of attempts. These are
+	// worked out every step so changes to the lattice probabilities are picked up.
+	const std::size_t regionCount = lattice.hasRegions() ? lattice.m_regionTable.size() : 1;
+	m_transitionProbability.resize(regionCount * SIRSArray::MAXSTATE * 2);
+	for(std::size_t region = 0; region < regionCount; ++region)
+	{
+		double probSI = lattice.hasRegions() ? lattice.m_regionTable[region].probSI : lattice.getProbSI();
+		double probIR = lattice.hasRegions() ? lattice.m_regionTable[region].probIR : lattice.getProbIR();
+		double probRS = lattice.hasRegions() ? lattice.m_regionTable[region].probRS : lattice.getProbRS();
+
+		double *probability = &m_transitionProbability[region * SIRSArray::MAXSTATE * 2];
+		probability[2 * SIRSArray::Susceptible]     = 0.0;
+		probability[2 * SIRSArray::Susceptible + 1] = 1.0 - std::exp(-probSI * m_tau);
+		probability[2 * SIRSArray::Infected]        = 1.0 - std::exp(-probIR * m_tau);
+		probability[2 * SIRSArray::Infected + 1]    = probability[2 * SIRSArray::Infected];
+		probability[2 * SIRSArray::Recovered]       = 1.0 - std::exp(-probRS * m_tau);
+		probability[2 * SIRSArray::Recovered + 1]   = probability[2 * SIRSArray::Recovered];
+		probability[2 * SIRSArray::Immune]          = 0.0;
+		probability[2 * SIRSArray::Immune + 1]      = 0.0;
+	}
+
+	parallelFor(0, lattice.getRows(), m_threadCount, [this, &lattice](int rowBegin, int rowEnd, int)
+	{
+		fillInfected(lattice, rowBegin, rowEnd);
+	});
+
+	// Copy the padding rows once all of the interior has been filled.
+	const int rows = lattice.getRows();
+	const int paddedCols = lattice.getCols() + 2 * m_radius;
+	for(int pad = 0; pad < m_radius; ++pad)
+	{
+		std::copy_n(&m_infected[(rows + pad) * paddedCols], paddedCols, &m_infected[pad * paddedCols]);
+		std::copy_n(&m_infected[(m_radius + pad) * paddedCols], paddedCols, &m_infected[(rows + m_radius + pad) * paddedCols]);
+	}
+
+	parallelFor(0, lattice.getRows(), m_threadCount, [this, &lattice](int rowBegin, int rowEnd, int)
+	{
+		(this->*m_stepKernel)(lattice, rowBegin, rowEnd);
+	});
+
+	lattice.m_boardData.swap(m_nextBoard);
+	lattice.m_neighbourCountsStale = true;
+	++m_stepCount;
+}
+
+void TauLeapEngine::sweep(SIRSArray &lattice)
+{
+	for(int i = 0; i < m_stepsPerSweep; ++i)
+	{
+		step(lattice);
+	}
+}
@@ -0,0 +1,121 @@
+#ifndef TauLeapEngine_hpp
+#define TauLeapEngine_hpp
+
+#include "SIRSArray.hpp"
+#include "Neighbourhood.hpp"
+#include "RandomStream.hpp"
+#include <vector>
+#include <random>
+#include <cstdint>
+
+/**
+ *\file
+ *\class TauLeapEngine
+ *\brief Approximate, synchronous integrator for the SIRS lattice that advances time in steps of tau.
+ *
+ * In the exact random-sequential dynamics each cell receives on average one update attempt per sweep,
+ * so over a time tau (measured in sweeps) a cell with transition probability p changes state with
+ * probability 1 - exp(-p*tau). This engine applies those probabilities to every cell at once using the
+ * state of the lattice at the start of the step, which makes the update trivially parallel. The error
+ * comes from ignoring changes to the neighbourhood during a step and vanishes as tau goes to zero.
+ *
+ * The random numbers for each row of each step come from their own RandomStream, so the trajectory for
+ * a given seed does not depend on the number of threads.
+ */
+class TauLeapEngine
+{
+private:
+	/// Pointer to the step kernel specialised for the neighbourhood.
+	using StepFunction = void (TauLeapEngine::*)(SIRSArray&, int, int);
+
+	/// Member variable for the time step actually used, 1/m_stepsPerSweep.
+	double m_tau;
+
+	/// Member variable for the number of steps that make up one sweep.
+	int m_stepsPerSweep;
+
+	/// Member variable for the number of threads the lattice is split between.
+	int m_threadCount;
+
+	/// Member variable for the radius of the neighbourhood, the width of the padding around m_infected.
+	int m_radius;
+
+	/// Member variable for the step kernel specialised for the neighbourhood.
+	StepFunction m_stepKernel;
+
+	/// Member variable for the stream the per step streams are split from.
+	RandomStream m_stream;
+
+	/// Member variable for the replica the engine belongs to, part of every stream id.
+	std::uint64_t m_replica;
+
+	/// Member variable counting the steps taken so far, part of every stream id.
+	std::uint64_t m_stepCount;
+
+	/// Member variable holding 1 for infected cells, padded by m_radius cells on each side.
+	std::vector<unsigned char, HugePageAllocator<unsigned char> > m_infected;
+
+	/// Member variable holding the next state of the lattice while it is being computed.
+	SIRSArray::StateVector m_nextBoard;
+
+	/// Member variable holding the probability of each state changing in a step, indexed by
+	/// (region * MAXSTATE + state) * 2 + has infected neighbour. Without regions there is only region 0.
+	std::vector<double> m_transitionProbability;
+
+	/**
+	 *\brief Fills the padded infected indicator for a range of rows.
+	 *\param lattice SIRSArray reference being advanced.
+	 *\param rowBegin first row to fill.
+	 *\param rowEnd one past the last row to fill.
+	 */
+	void fillInfected(const SIRSArray &lattice, int rowBegin, int rowEnd);
+
+	/**
+	 *\brief Computes the next state of a range of rows.
+	 *\param lattice SIRSArray reference being advanced.
+	 *\param rowBegin first row to update.
+	 *\param rowEnd one past the last row to update.
+	 */
+	template<class Stencil>
+	void stepRows(SIRSArray &lattice, int rowBegin, int rowEnd);
+
+public:
+	/**
+	 *\brief Constructor.
+	 *\param lattice SIRSArray reference the engine will advance, used for its probabilities and size.
+	 *\param tau floating point value representing the requested time step in sweeps, rounded down so it divides one sweep.
+	 *\param type NeighbourhoodType value representing the shape of the neighbourhood.
+	 *\param radius Integer value representing the radius of the neighbourhood.
+	 *\param threadCount Integer value representing the number of threads to use.
+	 *\param seed 64 bit seed for the random streams.
+	 *\param replica integer value for the replica the engine belongs to, so replicas sharing a seed use different streams.
+	 */
+	TauLeapEngine(
+		const SIRSArray &lattice,
+		double tau,
+		NeighbourhoodType type,
+		int radius,
+		int threadCount,
+		std::uint64_t seed,
+		std::uint64_t replica = 0);
+
+	/**
+	 *\brief Getter for the time step actually being used.
+	 *\return Floating point value representing the time step in sweeps.
+	 */
+	double getTau() const;
+
+	/**
+	 *\brief Advances the lattice by a single time step.
+	 *\param lattice SIRSArray reference to advance.
+	 */
+	void step(SIRSArray &lattice);
+
+	/**
+	 *\brief Advances the lattice by one sweep, i.e. one unit of time.
+	 *\param lattice SIRSArray reference to advance.
+	 */
+	void sweep(SIRSArray &lattice);
+};
+
+#endif /* TauLeapEngine_hpp */
@@ -0,0 +1,140 @@
+#include "TelemetryPublisher.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+constexpr std::uint32_t TelemetrySegment::magicNumber;
+constexpr const char *TelemetrySegment::namePrefix;
+
+TelemetryPublisher::TelemetryPublisher(
+	const std::string &name,
+	int population,
+	int rows,
+	int cols,
+	int totalSweeps,
+	int maxImageSide,
+	double interval
+	) : m_name(name),
+		m_segment{nullptr},
+		m_mappedSize{0},
+		m_rowCount{rows},
+		m_colCount{cols},
+		m_imageStride{1},
+		m_interval{interval},
+		m_lastPublished{-interval},
+		m_metrics()
+{
+	// Sample every m_imageStride-th cell so neither side of the image is longer than maxImageSide.
+	std::uint32_t imageRows = 0;
+	std::uint32_t imageCols = 0;
+	if(maxImageSide > 0 && rows > 0 && cols > 0)
+	{
+		m_imageStride = (std::max(rows, cols) + maxImageSide - 1) / maxImageSide;
+		imageRows = (rows + m_imageStride - 1) / m_imageStride;
+		imageCols = (cols + m_imageStride - 1) / m_imageStride;
+	}
+
+	m_metrics.processId   = getpid();
+	m_metrics.totalSweeps = totalSweeps;
+	m_metrics.population  = population;
+	m_metrics.imageRows   = imageRows;
+	m_metrics.imageCols   = imageCols;
+
+	const std::uint32_t imageCapacity = imageRows * imageCols;
+	m_mappedSize = TelemetrySegment::segmentSize(imageCapacity);
+
+	const std::string path = "/" + m_name;
+	int descriptor = shm_open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+	if(descriptor < 0)
+	{
+		throw std::runtime_error("Cannot create telemetry segment: " + m_name);
+	}
+
+	if(ftruncate(descriptor, m_mappedSize) != 0)
+	{
+		close(descriptor);
+		shm_unlink(path.c_str());
+		throw std::runtime_error("Cannot size telemetry segment: " + m_name);
+	}
+
+	void *mapping = mmap(nullptr, m_mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if(MAP_FAILED == mapping)
+	{
+		shm_unlink(path.c_str());
+		throw std::runtime_error("Cannot map telemetry segment: " + m_name);
+	}
+
+	// The magic number is written last so a monitor never sees a half initialised header.
+	m_segment = new (mapping) TelemetrySegment;
+	m_segment->imageCapacity = imageCapacity;
+	m_segment->sequence.store(0, std::memory_order_relaxed);
+	std::memcpy(&m_segment->metrics, &m_metrics, sizeof(m_metrics));
+	std::atomic_thread_fence(std::memory_order_release);
+	m_segment->magic = TelemetrySegment::magicNumber;
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+	munmap(m_segment, m_mappedSize);
+	shm_unlink(("/" + m_name).c_str());
+}
+
+const std::string& TelemetryPublisher::getName() const
+{
+	return m_name;
+}
+
+void TelemetryPublisher::write(int sweep, const SIRSArray::StateVector &states, bool finished)
+{
+	const double now = m_runTimer.elapsed();
+	m_lastPublished = now;
+
+	std::fill(std::begin(m_metrics.stateCounts), std::end(m_metrics.stateCounts), 0);
+	for(const auto &state : states)
+	{
+		++m_metrics.stateCounts[state];
+	}
+
+	const double sweepsDone = sweep + 1;
+	m_metrics.sweep            = sweep;
+	m_metrics.updatesPerSecond = (now > 0) ? sweepsDone * m_metrics.population / now : 0.0;
+	m_metrics.secondsRemaining = (sweepsDone > 0) ? (m_metrics.totalSweeps - sweepsDone) * now / sweepsDone : 0.0;
+	m_metrics.finished         = finished ? 1 : 0;
+
+	// Seqlock write: odd while writing, readers retry if they see an odd or changed sequence.
+	const std::uint64_t sequence = m_segment->sequence.load(std::memory_order_relaxed);
+	m_segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	std::memcpy(&m_segment->metrics, &m_metrics, sizeof(m_metrics));
+
+	unsigned char *pixel = m_segment->image();
+	for(int row = 0; row < m_rowCount && m_metrics.imageRows > 0; row += m_imageStride)
+	{
+		for(int col = 0; col < m_colCount; col += m_imageStride)
+		{
+			*(pixel++) = static_cast<unsigned char>(states[col + row * m_colCount]);
+		}
+	}
+
+	m_segment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void TelemetryPublisher::publish(int sweep, const SIRSArray::StateVector &states)
+{
+	if(m_runTimer.elapsed() - m_lastPublished >= m_interval)
+	{
+		write(sweep, states, false);
+	}
+}
+
+void TelemetryPublisher::finish(int sweep, const SIRSArray::StateVector &states)
+{
+	write(sweep, states, true);
+}
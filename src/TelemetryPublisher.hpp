@@ -0,0 +1,113 @@
+#ifndef TelemetryPublisher_hpp
+#define TelemetryPublisher_hpp
+
+#include "SIRSArray.hpp"
+#include "TelemetrySegment.hpp"
+#include "Timer.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ *\file
+ *\class TelemetryPublisher
+ *\brief Class that publishes the live state of a run to a POSIX shared memory segment.
+ *
+ * publish is meant to be called after every sweep, it only reads the clock unless the publishing
+ * interval has passed, in which case it counts the states, samples the lattice image and writes
+ * them under the seqlock described in TelemetrySegment. The segment is removed when the publisher
+ * is destroyed.
+ */
+class TelemetryPublisher
+{
+private:
+	/// Member variable holding the name of the segment.
+	std::string m_name;
+
+	/// Member variable pointing at the mapped segment.
+	TelemetrySegment *m_segment;
+
+	/// Member variable for the number of bytes mapped.
+	std::size_t m_mappedSize;
+
+	/// Member variable for the number of rows of the lattice, 0 if the cells do not form a 2D lattice.
+	int m_rowCount;
+
+	/// Member variable for the number of columns of the lattice, 0 if the cells do not form a 2D lattice.
+	int m_colCount;
+
+	/// Member variable for the number of cells in each direction represented by one pixel of the image.
+	int m_imageStride;
+
+	/// Member variable for the minimum number of seconds between publications.
+	double m_interval;
+
+	/// Member variable timing the run since the publisher was created.
+	Timer m_runTimer;
+
+	/// Member variable for the time of the last publication.
+	double m_lastPublished;
+
+	/// Member variable holding the metrics while they are put together outside the seqlock.
+	TelemetryMetrics m_metrics;
+
+	/**
+	 *\brief Counts the states, samples the image and writes everything to the segment.
+	 *\param sweep integer value representing the sweep that has just finished.
+	 *\param states constant reference to the vector holding the state of every cell.
+	 *\param finished Boolean value for whether this is the final publication.
+	 */
+	void write(int sweep, const SIRSArray::StateVector &states, bool finished);
+
+public:
+	/**
+	 *\brief Constructor that creates and maps the segment.
+	 *\param name string holding the segment name, without the leading slash.
+	 *\param population integer value representing the number of cells.
+	 *\param rows integer value representing the rows of the lattice, 0 if there is no 2D lattice to draw.
+	 *\param cols integer value representing the columns of the lattice, 0 if there is no 2D lattice to draw.
+	 *\param totalSweeps integer value representing the total number of sweeps, including burn in.
+	 *\param maxImageSide integer value representing the largest number of pixels along each side of the image, 0 for no image.
+	 *\param interval floating point value representing the minimum number of seconds between publications.
+	 *
+	 * Throws std::runtime_error if the segment cannot be created.
+	 */
+	TelemetryPublisher(
+		const std::string &name,
+		int population,
+		int rows,
+		int cols,
+		int totalSweeps,
+		int maxImageSide = 64,
+		double interval = 0.25);
+
+	/**
+	 *\brief Destructor that unmaps and removes the segment.
+	 */
+	~TelemetryPublisher();
+
+	TelemetryPublisher(const TelemetryPublisher&) = delete;
+	TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+
+	/**
+	 *\brief Getter for the name of the segment.
+	 *\return constant string reference holding the name.
+	 */
+	const std::string& getName() const;
+
+	/**
+	 *\brief Publishes the state of the run if the interval has passed since the last publication.
+	 *\param sweep integer value representing the sweep that has just finished.
+	 *\param states constant reference to the vector holding the state of every cell.
+	 */
+	void publish(int sweep, const SIRSArray::StateVector &states);
+
+	/**
+	 *\brief Publishes the final state of the run and marks it finished.
+	 *\param sweep integer value representing the last sweep.
+	 *\param states constant reference to the vector holding the state of every cell.
+	 */
+	void finish(int sweep, const SIRSArray::StateVector &states);
+};
+
+#endif /* TelemetryPublisher_hpp */
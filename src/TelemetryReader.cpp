@@ -0,0 +1,109 @@
+#include "TelemetryReader.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+namespace
+{
+	/// Number of times a read is retried while the writer is busy before giving up.
+	const int readAttempts = 1000;
+}
+
+TelemetryReader::TelemetryReader(const std::string &name) : m_name(name), m_segment{nullptr}, m_mappedSize{0}
+{
+	int descriptor = shm_open(("/" + m_name).c_str(), O_RDONLY, 0);
+	struct stat segmentStatus;
+	if(descriptor < 0 || fstat(descriptor, &segmentStatus) != 0 || static_cast<std::size_t>(segmentStatus.st_size) < sizeof(TelemetrySegment))
+	{
+		if(descriptor >= 0)
+		{
+			close(descriptor);
+		}
+		throw std::runtime_error("No telemetry segment: " + m_name);
+	}
+
+	m_mappedSize = segmentStatus.st_size;
+	void *mapping = mmap(nullptr, m_mappedSize, PROT_READ, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if(MAP_FAILED == mapping)
+	{
+		throw std::runtime_error("Cannot map telemetry segment: " + m_name);
+	}
+
+	m_segment = static_cast<const TelemetrySegment*>(mapping);
+	if(TelemetrySegment::magicNumber != m_segment->magic || TelemetrySegment::segmentSize(m_segment->imageCapacity) > m_mappedSize)
+	{
+		munmap(mapping, m_mappedSize);
+		throw std::runtime_error("Not a telemetry segment: " + m_name);
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+TelemetryReader::~TelemetryReader()
+{
+	munmap(const_cast<TelemetrySegment*>(m_segment), m_mappedSize);
+}
+
+const std::string& TelemetryReader::getName() const
+{
+	return m_name;
+}
+
+bool TelemetryReader::read(TelemetryMetrics &metrics, std::vector<unsigned char> *image) const
+{
+	for(int attempt = 0; attempt < readAttempts; ++attempt)
+	{
+		const std::uint64_t before = m_segment->sequence.load(std::memory_order_acquire);
+		if(before & 1)
+		{
+			continue;
+		}
+
+		std::memcpy(&metrics, &m_segment->metrics, sizeof(metrics));
+
+		// The image size is checked against the capacity because a torn copy could hold anything.
+		const std::size_t pixels = static_cast<std::size_t>(metrics.imageRows) * metrics.imageCols;
+		if(image && pixels <= m_segment->imageCapacity)
+		{
+			image->assign(m_segment->image(), m_segment->image() + pixels);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(m_segment->sequence.load(std::memory_order_relaxed) == before)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::vector<std::string> TelemetryReader::listSegments()
+{
+	// Linux exposes POSIX shared memory as files in /dev/shm.
+	std::vector<std::string> names;
+	DIR *directory = opendir("/dev/shm");
+	if(nullptr == directory)
+	{
+		return names;
+	}
+
+	const std::string prefix = TelemetrySegment::namePrefix;
+	for(dirent *entry = readdir(directory); entry != nullptr; entry = readdir(directory))
+	{
+		std::string name = entry->d_name;
+		if(0 == name.compare(0, prefix.size(), prefix))
+		{
+			names.push_back(name);
+		}
+	}
+	closedir(directory);
+
+	std::sort(names.begin(), names.end());
+	return names;
+}
@@ -0,0 +1,66 @@
+#ifndef TelemetryReader_hpp
+#define TelemetryReader_hpp
+
+#include "TelemetrySegment.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ *\file
+ *\class TelemetryReader
+ *\brief Class that reads consistent snapshots of the telemetry a run publishes to shared memory.
+ *
+ * The segment is mapped read-only so a reader can never disturb the run it is watching.
+ */
+class TelemetryReader
+{
+private:
+	/// Member variable holding the name of the segment.
+	std::string m_name;
+
+	/// Member variable pointing at the mapped segment.
+	const TelemetrySegment *m_segment;
+
+	/// Member variable for the number of bytes mapped.
+	std::size_t m_mappedSize;
+
+public:
+	/**
+	 *\brief Constructor that opens and maps an existing segment.
+	 *\param name string holding the segment name, without the leading slash.
+	 *
+	 * Throws std::runtime_error if the segment does not exist or is not SIRS telemetry.
+	 */
+	explicit TelemetryReader(const std::string &name);
+
+	/**
+	 *\brief Destructor that unmaps the segment.
+	 */
+	~TelemetryReader();
+
+	TelemetryReader(const TelemetryReader&) = delete;
+	TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+	/**
+	 *\brief Getter for the name of the segment.
+	 *\return constant string reference holding the name.
+	 */
+	const std::string& getName() const;
+
+	/**
+	 *\brief Copies the metrics, and optionally the image, as they were at a single instant.
+	 *\param metrics TelemetryMetrics reference to copy the metrics into.
+	 *\param image pointer to a vector that is filled with the image row by row, may be nullptr.
+	 *\return Boolean value, false if no consistent copy could be made because the run kept writing.
+	 */
+	bool read(TelemetryMetrics &metrics, std::vector<unsigned char> *image = nullptr) const;
+
+	/**
+	 *\brief Lists the telemetry segments that currently exist.
+	 *\return vector of segment names starting with TelemetrySegment::namePrefix, sorted.
+	 */
+	static std::vector<std::string> listSegments();
+};
+
+#endif /* TelemetryReader_hpp */
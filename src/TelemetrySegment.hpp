@@ -0,0 +1,97 @@
+#ifndef TelemetrySegment_hpp
+#define TelemetrySegment_hpp
+
+#include "SIRSArray.hpp" // For the number of states.
+#include <atomic>
+#include <cstdint>
+
+/**
+ *\file
+ *\class TelemetryMetrics
+ *\brief Class holding the live metrics of a running simulation as they are laid out in shared memory.
+ */
+class TelemetryMetrics
+{
+public:
+	/// Process id of the run, so a monitor can tell a run that was killed from one that is still going.
+	std::int64_t processId;
+	/// Most recently completed sweep, including the burn period.
+	std::int64_t sweep;
+	/// Total number of sweeps the run will make, including the burn period.
+	std::int64_t totalSweeps;
+	/// Number of cells being simulated.
+	std::int64_t population;
+	/// Number of cells in each state.
+	std::int64_t stateCounts[SIRSArray::MAXSTATE];
+	/// Average number of cell updates per second since the run started.
+	double updatesPerSecond;
+	/// Estimated number of seconds until the run finishes.
+	double secondsRemaining;
+	/// Number of rows of the lattice image, 0 if there is no image.
+	std::uint32_t imageRows;
+	/// Number of columns of the lattice image, 0 if there is no image.
+	std::uint32_t imageCols;
+	/// Non-zero once the run has finished.
+	std::uint32_t finished;
+};
+
+/**
+ *\class TelemetrySegment
+ *\brief Header of the POSIX shared memory segment a run publishes its metrics to.
+ *
+ * The header is followed by imageCapacity bytes holding the lattice image, one state per byte row
+ * by row. The metrics and image are protected by a seqlock: the writer makes sequence odd, writes,
+ * then makes it even again, and a reader only accepts a copy if sequence was the same even number
+ * before and after it. The writer never waits for readers, so any number of monitors cost the
+ * simulation nothing.
+ */
+class TelemetrySegment
+{
+public:
+	/// Value of magic in a valid segment, "SIRT" read as a little-endian integer.
+	static constexpr std::uint32_t magicNumber = 0x54524953;
+
+	/// Name prefix of every segment, the monitor looks for segments starting with it.
+	static constexpr const char *namePrefix = "sirs-";
+
+	/// Identifies the segment as SIRS telemetry.
+	std::uint32_t magic;
+	/// Number of bytes reserved for the image after the header.
+	std::uint32_t imageCapacity;
+	/// Seqlock counter, odd while the writer is updating the segment.
+	std::atomic<std::uint64_t> sequence;
+	/// Metrics of the run.
+	TelemetryMetrics metrics;
+
+	/**
+	 *\brief Calculates the size of a segment.
+	 *\param imageCapacity integer value representing the number of bytes reserved for the image.
+	 *\return Integer value representing the total number of bytes to map.
+	 */
+	static std::size_t segmentSize(std::uint32_t imageCapacity)
+	{
+		return sizeof(TelemetrySegment) + imageCapacity;
+	}
+
+	/**
+	 *\brief Getter for the image stored after the header.
+	 *\return pointer to the first byte of the image.
+	 */
+	unsigned char* image()
+	{
+		return reinterpret_cast<unsigned char*>(this + 1);
+	}
+
+	/**
+	 *\brief constant version of image().
+	 *\return constant pointer to the first byte of the image.
+	 */
+	const unsigned char* image() const
+	{
+		return reinterpret_cast<const unsigned char*>(this + 1);
+	}
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The telemetry seqlock needs a lock free 64 bit atomic to live in shared memory");
+
+#endif /* TelemetrySegment_hpp */
@@ -0,0 +1,155 @@
+#ifndef TimeSeriesFormat_hpp
+#define TimeSeriesFormat_hpp
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ *\file
+ *\class TimeSeriesFormat
+ *\brief Class describing the binary time series files the counts of every measurement are written to.
+ *
+ * A file is laid out as
+ *
+ *     char     magic[8]              "SIRSTS01"
+ *     varint   columnCount, levelCount, levelFactor
+ *     varint   name length, chars    columnCount times
+ *     chunk                          any number of times
+ *
+ * where every chunk is
+ *
+ *     uint8    kind                  rawChunk, levelChunk or endChunk
+ *     varint   level, rowCount, payload length
+ *     uint8    payload               payload length times
+ *
+ * Raw chunks hold the measurements themselves, level chunks hold the buckets of downsampled level
+ * 1 to levelCount, each bucket summarising levelFactor buckets of the level below it (level 0 being
+ * the measurements). A payload is columnar: the sweep column, then for a level chunk the number of
+ * measurements in each bucket, then each count column, or its minimum, maximum and sum columns for a
+ * level chunk. Each column starts with its first value and continues with the differences between
+ * neighbouring values, zigzag encoded so small negative steps stay small, then written as LEB128
+ * varints, so a count that changes by a few cells a measurement costs a byte.
+ *
+ * Chunks are self contained and end chunks are only written when the run closes the file, so the
+ * complete chunks of a run that was killed can still be read.
+ */
+class TimeSeriesFormat
+{
+public:
+	/// First eight bytes of every file.
+	static constexpr const char *magic = "SIRSTS01";
+
+	/// Kind of a chunk holding measurements.
+	static constexpr unsigned char rawChunk = 0;
+
+	/// Kind of a chunk holding the buckets of a downsampled level.
+	static constexpr unsigned char levelChunk = 1;
+
+	/// Kind of the chunk that marks a file as complete.
+	static constexpr unsigned char endChunk = 2;
+
+	/**
+	 *\brief Appends an unsigned value as a LEB128 varint, seven bits a byte, least significant first.
+	 *\param out vector of bytes to append to.
+	 *\param value unsigned 64 bit value.
+	 */
+	static void appendVarint(std::vector<unsigned char> &out, std::uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			out.push_back(static_cast<unsigned char>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<unsigned char>(value));
+	}
+
+	/**
+	 *\brief Appends a signed value zigzag encoded, so 0, -1, 1, -2... become 0, 1, 2, 3...
+	 *\param out vector of bytes to append to.
+	 *\param value signed 64 bit value.
+	 */
+	static void appendSigned(std::vector<unsigned char> &out, std::int64_t value)
+	{
+		appendVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+	}
+
+	/**
+	 *\brief Appends a column as its first value followed by the differences between neighbouring values.
+	 *\param out vector of bytes to append to.
+	 *\param column constant vector of the values.
+	 */
+	static void appendColumn(std::vector<unsigned char> &out, const std::vector<std::int64_t> &column)
+	{
+		std::int64_t previous = 0;
+		for(std::int64_t value : column)
+		{
+			appendSigned(out, value - previous);
+			previous = value;
+		}
+	}
+
+	/**
+	 *\brief Reads a LEB128 varint.
+	 *\param data pointer to the bytes.
+	 *\param size number of bytes.
+	 *\param offset position of the varint, moved past it.
+	 *\return unsigned 64 bit value.
+	 *
+	 * Throws std::runtime_error if the varint runs past the end of the bytes.
+	 */
+	static std::uint64_t readVarint(const unsigned char *data, std::size_t size, std::size_t &offset)
+	{
+		std::uint64_t value = 0;
+		for(int shift = 0; shift < 64; shift += 7)
+		{
+			if(offset >= size)
+			{
+				throw std::runtime_error("Time series varint runs past the end of its data");
+			}
+
+			unsigned char byte = data[offset++];
+			value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+			if(0 == (byte & 0x80))
+			{
+				return value;
+			}
+		}
+
+		throw std::runtime_error("Time series varint is too long");
+	}
+
+	/**
+	 *\brief Reads a zigzag encoded signed value.
+	 *\param data pointer to the bytes.
+	 *\param size number of bytes.
+	 *\param offset position of the value, moved past it.
+	 *\return signed 64 bit value.
+	 */
+	static std::int64_t readSigned(const unsigned char *data, std::size_t size, std::size_t &offset)
+	{
+		std::uint64_t value = readVarint(data, size, offset);
+		return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+	}
+
+	/**
+	 *\brief Reads a column written by appendColumn and appends its values.
+	 *\param data pointer to the bytes.
+	 *\param size number of bytes.
+	 *\param offset position of the column, moved past it.
+	 *\param count number of values in the column.
+	 *\param column vector the values are appended to.
+	 */
+	static void readColumn(const unsigned char *data, std::size_t size, std::size_t &offset, std::size_t count, std::vector<std::int64_t> &column)
+	{
+		std::int64_t value = 0;
+		for(std::size_t n = 0; n < count; ++n)
+		{
+			value += readSigned(data, size, offset);
+			column.push_back(value);
+		}
+	}
+};
+
+#endif /* TimeSeriesFormat_hpp */
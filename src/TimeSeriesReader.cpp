@@ -0,0 +1,193 @@
+#include "TimeSeriesReader.hpp"
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <stdexcept>
+
+TimeSeriesReader::TimeSeriesReader(const std::string &fileName) : m_levelFactor{0}, m_complete{false}
+{
+	std::ifstream in(fileName, std::ios::in | std::ios::binary);
+	if(!in)
+	{
+		throw std::runtime_error("Cannot open time series: " + fileName);
+	}
+
+	const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	const unsigned char *data = bytes.data();
+	const std::size_t size = bytes.size();
+
+	const std::size_t magicSize = std::strlen(TimeSeriesFormat::magic);
+	if(size < magicSize || 0 != std::memcmp(data, TimeSeriesFormat::magic, magicSize))
+	{
+		throw std::runtime_error("Not a SIRS time series: " + fileName);
+	}
+
+	std::size_t offset = magicSize;
+	const std::size_t columnCount = TimeSeriesFormat::readVarint(data, size, offset);
+	const std::size_t levelCount  = TimeSeriesFormat::readVarint(data, size, offset);
+	m_levelFactor = TimeSeriesFormat::readVarint(data, size, offset);
+
+	for(std::size_t column = 0; column < columnCount; ++column)
+	{
+		std::size_t length = TimeSeriesFormat::readVarint(data, size, offset);
+		if(length > size - offset)
+		{
+			throw std::runtime_error("Time series column name runs past the end of the file: " + fileName);
+		}
+		m_columnNames.emplace_back(reinterpret_cast<const char*>(data + offset), length);
+		offset += length;
+	}
+
+	m_levels.resize(levelCount + 1);
+	m_levels[0].columns.resize(columnCount);
+	for(std::size_t level = 1; level <= levelCount; ++level)
+	{
+		m_levels[level].columns.resize(3 * columnCount);
+	}
+
+	// Stop at the end chunk, or at the first chunk the file ends part way through.
+	while(offset < size && !m_complete)
+	{
+		std::size_t payloadOffset = offset + 1;
+		std::size_t level, rows, length;
+		try
+		{
+			level  = TimeSeriesFormat::readVarint(data, size, payloadOffset);
+			rows   = TimeSeriesFormat::readVarint(data, size, payloadOffset);
+			length = TimeSeriesFormat::readVarint(data, size, payloadOffset);
+		}
+		catch(const std::runtime_error&)
+		{
+			break;
+		}
+
+		if(length > size - payloadOffset)
+		{
+			break;
+		}
+
+		const unsigned char kind = data[offset];
+		const std::size_t end = payloadOffset + length;
+		if(TimeSeriesFormat::endChunk == kind)
+		{
+			m_complete = true;
+		}
+		else if((TimeSeriesFormat::rawChunk == kind && 0 == level) || (TimeSeriesFormat::levelChunk == kind && level >= 1 && level <= levelCount))
+		{
+			Level &target = m_levels[level];
+			TimeSeriesFormat::readColumn(data, end, payloadOffset, rows, target.sweeps);
+			if(0 == level)
+			{
+				target.rowCounts.insert(target.rowCounts.end(), rows, 1);
+			}
+			else
+			{
+				TimeSeriesFormat::readColumn(data, end, payloadOffset, rows, target.rowCounts);
+			}
+
+			for(auto &column : target.columns)
+			{
+				TimeSeriesFormat::readColumn(data, end, payloadOffset, rows, column);
+			}
+		}
+		else
+		{
+			throw std::runtime_error("Unknown time series chunk in: " + fileName);
+		}
+
+		offset = end;
+	}
+}
+
+const std::vector<std::string>& TimeSeriesReader::getColumnNames() const
+{
+	return m_columnNames;
+}
+
+int TimeSeriesReader::findColumn(const std::string &name) const
+{
+	for(std::size_t column = 0; column < m_columnNames.size(); ++column)
+	{
+		if(name == m_columnNames[column])
+		{
+			return column;
+		}
+	}
+
+	return -1;
+}
+
+int TimeSeriesReader::getLevelCount() const
+{
+	return m_levels.size() - 1;
+}
+
+int TimeSeriesReader::getLevelFactor() const
+{
+	return m_levelFactor;
+}
+
+const TimeSeriesReader::Level& TimeSeriesReader::getLevel(int level) const
+{
+	return m_levels.at(level);
+}
+
+bool TimeSeriesReader::isComplete() const
+{
+	return m_complete;
+}
+
+void TimeSeriesReader::writeText(std::ostream &out, int column) const
+{
+	const Level &measurements = m_levels[0];
+	for(std::size_t row = 0; row < measurements.sweeps.size(); ++row)
+	{
+		// The order parameter was streamed as a double, so it is formatted as one here too.
+		out << measurements.sweeps[row] << ' ' << static_cast<double>(measurements.columns[column][row]) << '\n';
+	}
+}
+
+void TimeSeriesReader::writeColumns(std::ostream &out, int level) const
+{
+	const Level &rows = m_levels.at(level);
+
+	out << "# sweep";
+	if(0 == level)
+	{
+		for(const auto &name : m_columnNames)
+		{
+			out << ' ' << name;
+		}
+	}
+	else
+	{
+		out << " measurements";
+		for(const auto &name : m_columnNames)
+		{
+			out << ' ' << name << "-min " << name << "-max " << name << "-mean";
+		}
+	}
+	out << '\n';
+
+	for(std::size_t row = 0; row < rows.sweeps.size(); ++row)
+	{
+		out << rows.sweeps[row];
+		if(0 == level)
+		{
+			for(const auto &column : rows.columns)
+			{
+				out << ' ' << column[row];
+			}
+		}
+		else
+		{
+			out << ' ' << rows.rowCounts[row];
+			for(std::size_t column = 0; column < rows.columns.size(); column += 3)
+			{
+				out << ' ' << rows.columns[column][row] << ' ' << rows.columns[column + 1][row] << ' ' <<
+				static_cast<double>(rows.columns[column + 2][row]) / rows.rowCounts[row];
+			}
+		}
+		out << '\n';
+	}
+}
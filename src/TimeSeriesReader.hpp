@@ -0,0 +1,111 @@
+#ifndef TimeSeriesReader_hpp
+#define TimeSeriesReader_hpp
+
+#include "TimeSeriesFormat.hpp"
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+
+/**
+ *\file
+ *\class TimeSeriesReader
+ *\brief Class that reads a time series written by TimeSeriesWriter back into columns.
+ *
+ * The whole file is decoded on construction. A file without an end chunk, from a run that did not
+ * finish, is read up to its last complete chunk.
+ */
+class TimeSeriesReader
+{
+public:
+	/**
+	 *\class Level
+	 *\brief Class holding the rows of the measurements or of one downsampled level.
+	 */
+	class Level
+	{
+	public:
+		/// Sweep of each measurement, or of the first measurement of each bucket.
+		std::vector<std::int64_t> sweeps;
+		/// Number of measurements in each bucket, 1 for the measurements themselves.
+		std::vector<std::int64_t> rowCounts;
+		/// Each column of the measurements, or the minimum, maximum and sum of each column of the buckets.
+		std::vector<std::vector<std::int64_t> > columns;
+	};
+
+private:
+	/// Member variable holding the name of each count column.
+	std::vector<std::string> m_columnNames;
+
+	/// Member variable for the number of buckets of the level below in each bucket.
+	int m_levelFactor;
+
+	/// Member variable holding the measurements, then each downsampled level.
+	std::vector<Level> m_levels;
+
+	/// Member variable that is true if the file ended with an end chunk.
+	bool m_complete;
+
+public:
+	/**
+	 *\brief Constructor that reads and decodes a file.
+	 *\param fileName string holding the name of the file.
+	 *
+	 * Throws std::runtime_error if the file cannot be read or is not a SIRS time series.
+	 */
+	explicit TimeSeriesReader(const std::string &fileName);
+
+	/**
+	 *\brief Getter for the names of the count columns.
+	 *\return constant vector of names.
+	 */
+	const std::vector<std::string>& getColumnNames() const;
+
+	/**
+	 *\brief Finds a count column by name.
+	 *\param name string holding the name of the column.
+	 *\return Integer value representing the index of the column, -1 if there is none.
+	 */
+	int findColumn(const std::string &name) const;
+
+	/**
+	 *\brief Getter for the number of downsampled levels.
+	 *\return Integer value, the levels are numbered 1 to this.
+	 */
+	int getLevelCount() const;
+
+	/**
+	 *\brief Getter for the number of buckets of the level below in each bucket.
+	 *\return Integer value representing the downsampling factor.
+	 */
+	int getLevelFactor() const;
+
+	/**
+	 *\brief Getter for the rows of a level.
+	 *\param level integer value, 0 for the measurements.
+	 *\return constant Level reference.
+	 */
+	const Level& getLevel(int level) const;
+
+	/**
+	 *\brief Whether the file ended with an end chunk.
+	 *\return Boolean value, false if the run that wrote it did not finish.
+	 */
+	bool isComplete() const;
+
+	/**
+	 *\brief Writes one column of the measurements as "sweep count" lines, exactly as OrderParameter.dat is written.
+	 *\param out std::ostream reference to write to.
+	 *\param column integer value representing the index of the column.
+	 */
+	void writeText(std::ostream &out, int column) const;
+
+	/**
+	 *\brief Writes a level with every column, one row per line, the first line a comment naming the columns.
+	 *\param out std::ostream reference to write to.
+	 *\param level integer value, 0 for the measurements, otherwise the minimum, maximum and mean of each column are written.
+	 */
+	void writeColumns(std::ostream &out, int level) const;
+};
+
+#endif /* TimeSeriesReader_hpp */
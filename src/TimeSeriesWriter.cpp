@@ -0,0 +1,232 @@
+#include "TimeSeriesWriter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+constexpr const char *TimeSeriesFormat::magic;
+constexpr unsigned char TimeSeriesFormat::rawChunk;
+constexpr unsigned char TimeSeriesFormat::levelChunk;
+constexpr unsigned char TimeSeriesFormat::endChunk;
+
+TimeSeriesWriter::TimeSeriesWriter(
+	const std::string &fileName,
+	const std::vector<std::string> &columnNames,
+	int levelCount,
+	int levelFactor,
+	int blockRows
+	) : m_out(fileName, std::ios::out | std::ios::binary),
+		m_columnCount(columnNames.size()),
+		m_levelFactor{std::max(2, levelFactor)},
+		m_blockRows{std::max(1, blockRows)},
+		m_columns(columnNames.size()),
+		m_levels(std::max(0, levelCount)),
+		m_byteCount{0},
+		m_rowCount{0},
+		m_closed{false}
+{
+	if(!m_out)
+	{
+		throw std::runtime_error("Cannot create time series: " + fileName);
+	}
+
+	for(auto &level : m_levels)
+	{
+		level.children = 0;
+		level.columns.resize(3 * m_columnCount);
+	}
+
+	std::vector<unsigned char> header(TimeSeriesFormat::magic, TimeSeriesFormat::magic + std::strlen(TimeSeriesFormat::magic));
+	TimeSeriesFormat::appendVarint(header, m_columnCount);
+	TimeSeriesFormat::appendVarint(header, m_levels.size());
+	TimeSeriesFormat::appendVarint(header, m_levelFactor);
+	for(const auto &name : columnNames)
+	{
+		TimeSeriesFormat::appendVarint(header, name.size());
+		header.insert(header.end(), name.begin(), name.end());
+	}
+
+	m_out.write(reinterpret_cast<const char*>(header.data()), header.size());
+	m_byteCount += header.size();
+}
+
+TimeSeriesWriter::~TimeSeriesWriter()
+{
+	close();
+}
+
+void TimeSeriesWriter::writeChunk(unsigned char kind, int level, std::size_t rows, const std::vector<unsigned char> &payload)
+{
+	std::vector<unsigned char> header(1, kind);
+	TimeSeriesFormat::appendVarint(header, level);
+	TimeSeriesFormat::appendVarint(header, rows);
+	TimeSeriesFormat::appendVarint(header, payload.size());
+
+	m_out.write(reinterpret_cast<const char*>(header.data()), header.size());
+	m_out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+	m_byteCount += header.size() + payload.size();
+}
+
+void TimeSeriesWriter::flushRows()
+{
+	if(m_sweeps.empty())
+	{
+		return;
+	}
+
+	std::vector<unsigned char> payload;
+	TimeSeriesFormat::appendColumn(payload, m_sweeps);
+	for(const auto &column : m_columns)
+	{
+		TimeSeriesFormat::appendColumn(payload, column);
+	}
+
+	writeChunk(TimeSeriesFormat::rawChunk, 0, m_sweeps.size(), payload);
+
+	m_sweeps.clear();
+	for(auto &column : m_columns)
+	{
+		column.clear();
+	}
+}
+
+void TimeSeriesWriter::flushLevel(int level)
+{
+	Level &current = m_levels[level];
+	if(current.sweeps.empty())
+	{
+		return;
+	}
+
+	std::vector<unsigned char> payload;
+	TimeSeriesFormat::appendColumn(payload, current.sweeps);
+	TimeSeriesFormat::appendColumn(payload, current.rowCounts);
+	for(const auto &column : current.columns)
+	{
+		TimeSeriesFormat::appendColumn(payload, column);
+	}
+
+	writeChunk(TimeSeriesFormat::levelChunk, level + 1, current.sweeps.size(), payload);
+
+	current.sweeps.clear();
+	current.rowCounts.clear();
+	for(auto &column : current.columns)
+	{
+		column.clear();
+	}
+}
+
+void TimeSeriesWriter::merge(int level, std::int64_t sweep, std::int64_t rows, const std::int64_t *minimum, const std::int64_t *maximum, const std::int64_t *sum)
+{
+	Level &current = m_levels[level];
+	if(0 == current.children)
+	{
+		current.firstSweep = sweep;
+		current.rows = rows;
+		current.minimum.assign(minimum, minimum + m_columnCount);
+		current.maximum.assign(maximum, maximum + m_columnCount);
+		current.sum.assign(sum, sum + m_columnCount);
+	}
+	else
+	{
+		current.rows += rows;
+		for(int column = 0; column < m_columnCount; ++column)
+		{
+			current.minimum[column] = std::min(current.minimum[column], minimum[column]);
+			current.maximum[column] = std::max(current.maximum[column], maximum[column]);
+			current.sum[column] += sum[column];
+		}
+	}
+
+	if(++current.children == m_levelFactor)
+	{
+		finishBucket(level);
+	}
+}
+
+void TimeSeriesWriter::finishBucket(int level)
+{
+	Level &current = m_levels[level];
+
+	current.sweeps.push_back(current.firstSweep);
+	current.rowCounts.push_back(current.rows);
+	for(int column = 0; column < m_columnCount; ++column)
+	{
+		current.columns[3 * column].push_back(current.minimum[column]);
+		current.columns[3 * column + 1].push_back(current.maximum[column]);
+		current.columns[3 * column + 2].push_back(current.sum[column]);
+	}
+	current.children = 0;
+
+	if(current.sweeps.size() >= static_cast<std::size_t>(m_blockRows))
+	{
+		flushLevel(level);
+	}
+
+	if(level + 1 < static_cast<int>(m_levels.size()))
+	{
+		merge(level + 1, current.firstSweep, current.rows, current.minimum.data(), current.maximum.data(), current.sum.data());
+	}
+}
+
+void TimeSeriesWriter::append(std::int64_t sweep, const std::int64_t *values)
+{
+	if(m_closed)
+	{
+		return;
+	}
+
+	m_sweeps.push_back(sweep);
+	for(int column = 0; column < m_columnCount; ++column)
+	{
+		m_columns[column].push_back(values[column]);
+	}
+	++m_rowCount;
+
+	if(m_sweeps.size() >= static_cast<std::size_t>(m_blockRows))
+	{
+		flushRows();
+	}
+
+	// A single measurement is its own minimum, maximum and sum.
+	if(!m_levels.empty())
+	{
+		merge(0, sweep, 1, values, values, values);
+	}
+}
+
+void TimeSeriesWriter::close()
+{
+	if(m_closed)
+	{
+		return;
+	}
+	m_closed = true;
+
+	// Finish partly filled buckets from the bottom up so each is counted in the levels above it.
+	for(std::size_t level = 0; level < m_levels.size(); ++level)
+	{
+		if(m_levels[level].children > 0)
+		{
+			finishBucket(level);
+		}
+	}
+
+	flushRows();
+	for(std::size_t level = 0; level < m_levels.size(); ++level)
+	{
+		flushLevel(level);
+	}
+
+	writeChunk(TimeSeriesFormat::endChunk, 0, m_rowCount, std::vector<unsigned char>());
+	m_out.close();
+}
+
+std::uint64_t TimeSeriesWriter::getByteCount() const
+{
+	return m_byteCount;
+}
+
+std::uint64_t TimeSeriesWriter::getRowCount() const
+{
+	return m_rowCount;
+}
@@ -0,0 +1,166 @@
+#ifndef TimeSeriesWriter_hpp
+#define TimeSeriesWriter_hpp
+
+#include "TimeSeriesFormat.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ *\file
+ *\class TimeSeriesWriter
+ *\brief Class that streams integer counts to a compact binary time series with downsampled levels.
+ *
+ * Measurements are buffered a block at a time and written as one columnar chunk, so memory stays
+ * bounded however long the run. Each downsampled level keeps the minimum, maximum and sum of every
+ * column over its current bucket, so a plot of a long run can read a few thousand buckets instead
+ * of every measurement, without losing the spikes a plain stride would skip.
+ */
+class TimeSeriesWriter
+{
+private:
+	/**
+	 *\class Level
+	 *\brief Class holding the bucket being filled and the finished buckets waiting to be written at one level.
+	 */
+	class Level
+	{
+	public:
+		/// Number of buckets, or measurements for level 1, merged into the current bucket.
+		int children;
+		/// Sweep of the first measurement of the current bucket.
+		std::int64_t firstSweep;
+		/// Number of measurements in the current bucket.
+		std::int64_t rows;
+		/// Smallest value of each column in the current bucket.
+		std::vector<std::int64_t> minimum;
+		/// Largest value of each column in the current bucket.
+		std::vector<std::int64_t> maximum;
+		/// Sum of each column over the current bucket.
+		std::vector<std::int64_t> sum;
+
+		/// First sweep of each finished bucket.
+		std::vector<std::int64_t> sweeps;
+		/// Number of measurements in each finished bucket.
+		std::vector<std::int64_t> rowCounts;
+		/// Minimum, maximum and sum of each column of each finished bucket, three columns per column.
+		std::vector<std::vector<std::int64_t> > columns;
+	};
+
+	/// Member variable holding the file being written.
+	std::ofstream m_out;
+
+	/// Member variable for the number of count columns.
+	int m_columnCount;
+
+	/// Member variable for the number of buckets of the level below merged into each bucket.
+	int m_levelFactor;
+
+	/// Member variable for the number of rows or buckets buffered before a chunk is written.
+	int m_blockRows;
+
+	/// Member variable holding the sweep of each buffered measurement.
+	std::vector<std::int64_t> m_sweeps;
+
+	/// Member variable holding each column of the buffered measurements.
+	std::vector<std::vector<std::int64_t> > m_columns;
+
+	/// Member variable holding the downsampled levels, m_levels[0] is level 1.
+	std::vector<Level> m_levels;
+
+	/// Member variable for the number of bytes written so far.
+	std::uint64_t m_byteCount;
+
+	/// Member variable for the number of measurements appended so far.
+	std::uint64_t m_rowCount;
+
+	/// Member variable that is true once the file has been closed.
+	bool m_closed;
+
+	/**
+	 *\brief Writes a chunk and its header.
+	 *\param kind one of the TimeSeriesFormat chunk kinds.
+	 *\param level integer value representing the level the chunk belongs to, 0 for measurements.
+	 *\param rows integer value representing the number of rows in the chunk.
+	 *\param payload constant vector of the encoded columns.
+	 */
+	void writeChunk(unsigned char kind, int level, std::size_t rows, const std::vector<unsigned char> &payload);
+
+	/**
+	 *\brief Writes the buffered measurements as a raw chunk.
+	 */
+	void flushRows();
+
+	/**
+	 *\brief Writes the finished buckets of a level as a level chunk.
+	 *\param level integer value representing the index into m_levels.
+	 */
+	void flushLevel(int level);
+
+	/**
+	 *\brief Merges a bucket, or a measurement at level 0, into the current bucket of a level.
+	 *\param level integer value representing the index into m_levels.
+	 *\param sweep sweep of the first measurement being merged.
+	 *\param rows number of measurements being merged.
+	 *\param minimum pointer to the minimum of each column of what is being merged.
+	 *\param maximum pointer to the maximum of each column of what is being merged.
+	 *\param sum pointer to the sum of each column of what is being merged.
+	 */
+	void merge(int level, std::int64_t sweep, std::int64_t rows, const std::int64_t *minimum, const std::int64_t *maximum, const std::int64_t *sum);
+
+	/**
+	 *\brief Finishes the current bucket of a level and passes it up to the next level.
+	 *\param level integer value representing the index into m_levels.
+	 */
+	void finishBucket(int level);
+
+public:
+	/**
+	 *\brief Constructor that creates the file and writes its header.
+	 *\param fileName string holding the name of the file.
+	 *\param columnNames constant vector of the name of each count column.
+	 *\param levelCount integer value representing the number of downsampled levels, 0 for none.
+	 *\param levelFactor integer value representing the number of buckets of the level below in each bucket, at least 2.
+	 *\param blockRows integer value representing the number of rows buffered before a chunk is written.
+	 *
+	 * Throws std::runtime_error if the file cannot be created.
+	 */
+	TimeSeriesWriter(const std::string &fileName, const std::vector<std::string> &columnNames, int levelCount = 0, int levelFactor = 16, int blockRows = 4096);
+
+	/**
+	 *\brief Destructor that closes the file.
+	 */
+	~TimeSeriesWriter();
+
+	TimeSeriesWriter(const TimeSeriesWriter&) = delete;
+	TimeSeriesWriter& operator=(const TimeSeriesWriter&) = delete;
+
+	/**
+	 *\brief Appends a measurement.
+	 *\param sweep integer value representing the sweep the measurement was made on.
+	 *\param values pointer to the value of each column.
+	 */
+	void append(std::int64_t sweep, const std::int64_t *values);
+
+	/**
+	 *\brief Writes everything still buffered, including partly filled buckets, and the end chunk.
+	 *
+	 * Closing twice does nothing, appending after closing is ignored.
+	 */
+	void close();
+
+	/**
+	 *\brief Getter for the number of bytes written so far.
+	 *\return Integer value representing the size of the file once it is closed.
+	 */
+	std::uint64_t getByteCount() const;
+
+	/**
+	 *\brief Getter for the number of measurements appended.
+	 *\return Integer value representing the number of measurements.
+	 */
+	std::uint64_t getRowCount() const;
+};
+
+#endif /* TimeSeriesWriter_hpp */
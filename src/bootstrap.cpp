@@ -1,6 +1,9 @@
 #include "bootstrap.hpp"
 
-double bootstrap(const DataArray::IDataFunctor &fcn, const DataArray &data, std::default_random_engine &generator, int iterations)
+namespace
+{
+template<class Generator>
+double bootstrapWith(const DataArray::IDataFunctor &fcn, const DataArray &data, Generator &generator, int iterations)
 {
 	// ``Uniform'' distribution to sample from the data. Arguments are closed interval so need to subtract 1
 	// in order to safely index the array.
@@ -10,12 +13,14 @@ double bootstrap(const DataArray::IDataFunctor &fcn, const DataArray &data, std:
 	DataArray resampledFncValues;
 	resampledFncValues.reserve(iterations);
 
+	// Data array to hold each n samples, its memory is reused for every re-sample.
+	DataArray tempData;
+	tempData.reserve(data.getSize());
+
 	// Re-sample the number of times specified by the call.
 	for(int i = 0; i < iterations; ++i)
 	{
-		// Create a data array to hold each n samples.
-		DataArray tempData;
-		tempData.reserve(data.getSize());
+		tempData.clear();
 
 		// Pick randomly n measurements.
 		for(int j = 0; j < data.getSize(); ++j)
@@ -34,4 +39,15 @@ double bootstrap(const DataArray::IDataFunctor &fcn, const DataArray &data, std:
 	double meanSquared = resampledFncValues.squareMean();
 	double error 	   = sqrt(meanSquared - mean * mean);
 	return error;
-}
\ No newline at end of file
+}
+}
+
+double bootstrap(const DataArray::IDataFunctor &fcn, const DataArray &data, std::default_random_engine &generator, int iterations)
+{
+	return bootstrapWith(fcn, data, generator, iterations);
+}
+
+double bootstrap(const DataArray::IDataFunctor &fcn, const DataArray &data, RandomStream &stream, int iterations)
+{
+	return bootstrapWith(fcn, data, stream, iterations);
+}
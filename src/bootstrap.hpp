@@ -2,6 +2,7 @@
 #define bootstrap_hpp
 
 #include "DataArray.hpp"
+#include "RandomStream.hpp"
 #include <random>
 #include <cmath>
 /**
@@ -24,4 +25,20 @@ double bootstrap(const DataArray::IDataFunctor &fcn,
 				 std::default_random_engine &generator, 
 				 int iterations = 100);
 
+/**
+ *\brief Function calculate bootstrap error of any function of a DataArray using a RandomStream.
+ *\param fcn a IDataFunctor reference that acts on the data (this is the function).
+ *\param data a DataArray reference the function is a function of.
+ *\param stream RandomStream reference for randomly re-sampling.
+ *\param iterations integer value representing the number of re-samplings.
+ *\return floating point value representing the bootstrap error.
+ *
+ * Same as the std::default_random_engine version, but a worker given its own stream (see
+ * RandomStream::makeStreamId with BootstrapPurpose) never shares random numbers with any other worker.
+ */
+double bootstrap(const DataArray::IDataFunctor &fcn, 
+				 const DataArray &data, 
+				 RandomStream &stream, 
+				 int iterations = 100);
+
 #endif /* bootstrap_hpp */
\ No newline at end of file
@@ -7,12 +7,14 @@ double jackKnife(const DataArray::IDataFunctor &fcn, const DataArray &data)
 	DataArray reducedFcnValues;
 	reducedFcnValues.reserve(data.getSize());
 
+	// Temporary data array to hold the reduced sample set, its memory is reused for every one.
+	DataArray tempDataArray;
+	tempDataArray.reserve(data.getSize()-1);
+
 	// Remove one data point at a time.
 	for(int i = 0; i < data.getSize(); ++i)
 	{
-		// Create temporary data array to hold the reduced sample set.
-		DataArray tempDataArray;
-		tempDataArray.reserve(data.getSize()-1);
+		tempDataArray.clear();
 		for(int j = 0; j < i; ++j)
 		{
 			tempDataArray.push_back(data[j]);
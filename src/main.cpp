@@ -1,13 +1,24 @@
 #include "SIRSArray.hpp"
+#include "Simulation.hpp"
+#include "AdaptiveScan.hpp"
+#include "ParameterChain.hpp"
+#include "DeterministicSolver.hpp"
+#include "ReplicaEnsemble.hpp"
+#include "EngineComparison.hpp"
+#include "HugePageAllocator.hpp"
+#include "RandomStream.hpp"
+#include "ClusterAnalysis.hpp"
+#include "CorrelationFunction.hpp"
+#include "MeasurementPipeline.hpp"
+#include "PerfCounters.hpp"
+#include "FrameRenderer.hpp"
+#include "TimeSeriesWriter.hpp"
 #include "getTimeStamp.hpp"
 #include "makeDirectory.hpp"
 #include "SIRSInputParameters.hpp"
-#include "DataArray.hpp"
 #include "SIRSResults.hpp"
 #include "Timer.hpp"
-#include "Susceptibility.hpp"
-#include "bootstrap.hpp"
-#include "jackKnife.hpp"
+#include "TelemetryPublisher.hpp"
 #include <random>
 #include <iostream>
 #include <algorithm>
@@ -17,6 +28,13 @@
 #include <fstream>
 #include <iomanip>
 #include <string>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <cmath>
+#include <stdexcept>
+#include <cstdint>
+#include <unistd.h>
 
 int main(int argc, char const *argv[])
 {
@@ -27,23 +45,51 @@ int main(int argc, char const *argv[])
     // Start the clock so execution time can be calculated. 
     Timer timer;
 
-    // Seed the pseudo random number generator using the system clock.
-    unsigned int seed = static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count());
-
-    // Create a generator that can be fed to any distribution to produce pseudo random numbers according to that distribution. 
-    std::default_random_engine generator(seed);
-
     // Input parameters.
-    int rowCount;
-    int colCount;
-    double probSI;
-    double probIR;
-    double probRS;
-    int burnPeriod;
-    int totalSweeps;
-    int measurementInterval;
-    std::string outputName;
-    double immuneFraction;
+    SIRSInputParameters inputParameters;
+
+    // Adaptive scan parameters.
+    std::string scanMode;
+    int scanCoarseCount;
+    int scanDepth;
+    double scanOrderTolerance;
+    double scanSusceptibilityFraction;
+    double scanMin;
+    double scanMax;
+    double bisectTolerance;
+
+    // Warm started chain parameters.
+    std::string chainMode;
+    int chainCount;
+    int chainWindow;
+    int chainMaxSweeps;
+    double chainTolerance;
+
+    // How the lattice and other large buffers are backed.
+    std::string hugePages;
+
+    // Number of independent replicas to run.
+    int replicaCount;
+
+    // Number of measurements between correlation function measurements.
+    int correlationInterval;
+    int analysisThreadCount;
+    int equivalenceRuns;
+    int frameInterval;
+    std::string frameFormatName;
+    int frameSide;
+    std::string framePalette;
+    int frameThreadCount;
+
+    // Format of the counts recorded on each measurement sweep.
+    std::string seriesFormat;
+    int seriesLevels;
+    int seriesFactor;
+
+    // Live telemetry parameters.
+    std::string telemetryName;
+    int telemetryImageSide;
+    double telemetryInterval;
 
     // Set up optional command line arguments.
     boost::program_options::options_description desc("Options for SIRS simulation");
@@ -51,16 +97,67 @@ int main(int argc, char const *argv[])
     // Add all optional command line arguments.
     desc.add_options()
         
-        ("column-count,c", boost::program_options::value<int>(&rowCount)->default_value(50), "The number of rows in the lattice.")
-        ("row-count,r", boost::program_options::value<int>(&colCount)->default_value(50), "The number of columns in the lattice.")
-        ("prob-SI,p", boost::program_options::value<double>(&probSI)->default_value(1.0), "The probability of going from susceptible to infected upon contact.")
-        ("prob-IR,q", boost::program_options::value<double>(&probIR)->default_value(1.0), "The probability of going from infected to recovered.")
-        ("prob-RS,g", boost::program_options::value<double>(&probRS)->default_value(1.0), "The probability of going from recovered to susceptible.")
-        ("burn-period,b", boost::program_options::value<int>(&burnPeriod)->default_value(5000), "Burn period for the simulation.")
-        ("sweeps,s", boost::program_options::value<int>(&totalSweeps)->default_value(10000), "The number of sweeps in the simulation.")
-        ("output,o",boost::program_options::value<std::string>(&outputName)->default_value(getTimeStamp()), "Name of output directory to save output files into.")
-        ("immune,m",boost::program_options::value<double>(&immuneFraction)->default_value(0.0), "Percentage of population who are completely immune to the infection.")
-        ("measurement-interval,i", boost::program_options::value<int>(&measurementInterval)->default_value(10), "Number of sweeps between output/measurements")
+        ("column-count,c", boost::program_options::value<int>(&inputParameters.colCount)->default_value(50), "The number of columns in the lattice.")
+        ("row-count,r", boost::program_options::value<int>(&inputParameters.rowCount)->default_value(50), "The number of rows in the lattice.")
+        ("prob-SI,p", boost::program_options::value<double>(&inputParameters.probSI)->default_value(1.0), "The probability of going from susceptible to infected upon contact.")
+        ("prob-IR,q", boost::program_options::value<double>(&inputParameters.probIR)->default_value(1.0), "The probability of going from infected to recovered.")
+        ("prob-RS,g", boost::program_options::value<double>(&inputParameters.probRS)->default_value(1.0), "The probability of going from recovered to susceptible.")
+        ("burn-period,b", boost::program_options::value<int>(&inputParameters.burnPeriod)->default_value(5000), "Burn period for the simulation.")
+        ("sweeps,s", boost::program_options::value<int>(&inputParameters.sweeps)->default_value(10000), "The number of sweeps in the simulation.")
+        ("output,o",boost::program_options::value<std::string>(&inputParameters.outputDirectory)->default_value(getTimeStamp()), "Name of output directory to save output files into.")
+        ("immune,m",boost::program_options::value<double>(&inputParameters.immuneFraction)->default_value(0.0), "Percentage of population who are completely immune to the infection.")
+        ("region-map", boost::program_options::value<std::string>(&inputParameters.regionMapFile)->default_value(""), "Binary map file giving each cell a region with its own p_1, p_2 and p_3, which then replace -p, -q and -g.")
+        ("neighbourhood,n", boost::program_options::value<std::string>(&inputParameters.neighbourhood)->default_value("von-neumann"), "Shape of the neighbourhood of each cell, von-neumann or moore.")
+        ("radius", boost::program_options::value<int>(&inputParameters.radius)->default_value(1), "Radius of the neighbourhood of each cell, between 1 and 3.")
+        ("infection", boost::program_options::value<std::string>(&inputParameters.infection)->default_value("any"), "Rule for infecting a susceptible cell, any (probability p1 if any neighbour is infected) or per-contact (each infected neighbour infects with probability p1). per-contact needs the 2D lattice and the exact engine.")
+        ("neighbour-counts", boost::program_options::bool_switch(&inputParameters.neighbourCounts), "Keep the number of infected neighbours of every cell up to date instead of scanning the neighbourhood of each susceptible cell, the results are unchanged.")
+        ("batch-size", boost::program_options::value<int>(&inputParameters.batchSize)->default_value(0), "Number of sites the 2D lattice draws from a stream of their own and prefetches ahead of updating them, which hides memory latency on lattices larger than the cache. Every size from 1 up gives the same results for the same seed, 0 draws each site from the update generator as it is updated, so batched runs follow a different trajectory and are not comparable run for run with unbatched ones.")
+        ("engine,e", boost::program_options::value<std::string>(&inputParameters.engine)->default_value("exact"), "Engine used to advance the lattice, exact or tau-leap. mean-field or pair instead solve the mean-field or pair approximation rate equations for the steady state, which is near instant and also works with --scan.")
+        ("tau", boost::program_options::value<double>(&inputParameters.tau)->default_value(0.1), "Time step in sweeps for the tau-leap engine, smaller is more accurate.")
+        ("threads,t", boost::program_options::value<int>(&inputParameters.threadCount)->default_value(std::max(1u, std::thread::hardware_concurrency())), "Number of threads used by the tau-leap engine and to fill the initial lattice.")
+        ("seed", boost::program_options::value<std::uint64_t>(&inputParameters.seed)->default_value(static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())), "Seed for the random numbers, a run is reproducible from its seed and parameters whatever the thread count. Defaults to the system clock.")
+        ("dims", boost::program_options::value<int>(&inputParameters.dimensions)->default_value(2), "Number of dimensions of the lattice, between 1 and 4. Anything other than 2 uses a nearest neighbour hypercubic lattice.")
+        ("sizes", boost::program_options::value<std::vector<int> >(&inputParameters.axisSizes)->multitoken(), "Number of cells along each axis, one value per dimension. Without it every axis has row-count cells.")
+        ("topology", boost::program_options::value<std::string>(&inputParameters.topology)->default_value("lattice"), "Contact structure, lattice, small-world (Watts-Strogatz), scale-free (Barabasi-Albert) or edge-list.")
+        ("nodes", boost::program_options::value<int>(&inputParameters.nodeCount)->default_value(2500), "Number of nodes of a small-world or scale-free network.")
+        ("degree", boost::program_options::value<int>(&inputParameters.meanDegree)->default_value(4), "Mean degree of a small-world or scale-free network, must be even.")
+        ("rewire", boost::program_options::value<double>(&inputParameters.rewireProbability)->default_value(0.1), "Probability each edge of a small-world network is rewired.")
+        ("edge-list", boost::program_options::value<std::string>(&inputParameters.edgeListFile)->default_value(""), "File of the edge-list topology, two node indices per line.")
+        ("huge-pages", boost::program_options::value<std::string>(&hugePages)->default_value("transparent"), "Backing of the lattice and other large buffers, off, transparent (madvise) or explicit (the reserved pool, falling back to transparent).")
+        ("replicas", boost::program_options::value<int>(&replicaCount)->default_value(1), "Number of independent replicas run on separate threads, more than one combines them into a single result with between and within replica errors.")
+        ("equivalence", boost::program_options::value<int>(&equivalenceRuns)->implicit_value(8), "Test the engine against the exact engine with this many runs of each at every point of a fixed matrix of probabilities, immune fractions and lattice sizes, 8 if no number is given. The burn period and sweeps apply to every run.")
+        ("validate", "Rerun the simulation with the exact engine from the same initial lattice and compare the order parameters.")
+        ("measurement-interval,i", boost::program_options::value<int>(&inputParameters.measurementInterval)->default_value(10), "Number of sweeps between output/measurements")
+        ("scan", boost::program_options::value<std::string>(&scanMode)->default_value("none"), "Run an adaptive scan instead of a single simulation, none, probabilities (p1-p3 plane) or immunity.")
+        ("scan-coarse", boost::program_options::value<int>(&scanCoarseCount)->default_value(4), "Number of cells along each axis of the initial scan grid.")
+        ("scan-depth", boost::program_options::value<int>(&scanDepth)->default_value(3), "Maximum number of times a scan cell is halved.")
+        ("scan-tolerance", boost::program_options::value<double>(&scanOrderTolerance)->default_value(0.05), "Change in order parameter across a scan cell that causes it to be refined.")
+        ("scan-susceptibility", boost::program_options::value<double>(&scanSusceptibilityFraction)->default_value(0.5), "Fraction of the peak susceptibility above which scan cells are refined.")
+        ("scan-min", boost::program_options::value<double>(&scanMin)->default_value(0.0), "Smallest immune fraction in an immunity scan.")
+        ("scan-max", boost::program_options::value<double>(&scanMax)->default_value(1.0), "Largest immune fraction in an immunity scan.")
+        ("bisect-tolerance", boost::program_options::value<double>(&bisectTolerance)->default_value(0.005), "Width of the final bracket when bisecting for the immune fraction at which the epidemic dies out.")
+        ("chain", boost::program_options::value<std::string>(&chainMode)->default_value("none"), "Follow a path through the phase diagram with one lattice that is re-equilibrated at each point instead of burnt in, none, probabilities (p1-p3 plane) or immunity.")
+        ("chain-points", boost::program_options::value<int>(&chainCount)->default_value(10), "Number of intervals along each axis of a chain, an immunity chain runs from scan-min to scan-max.")
+        ("chain-window", boost::program_options::value<int>(&chainWindow)->default_value(100), "Number of sweeps averaged over in each window of a re-equilibration.")
+        ("chain-max", boost::program_options::value<int>(&chainMaxSweeps)->default_value(2000), "Largest number of sweeps a re-equilibration can make.")
+        ("chain-tolerance", boost::program_options::value<double>(&chainTolerance)->default_value(0.002), "Change in the average infected fraction between windows at which a re-equilibration stops.")
+        ("hysteresis", "Follow the chain backwards as well and compare the order parameters of both directions.")
+        ("clusters", "Label the clusters of infected cells on each measurement sweep and record their statistics.")
+        ("correlations", "Measure the spatial correlation function and structure factor of the infected field.")
+        ("correlation-interval", boost::program_options::value<int>(&correlationInterval)->default_value(1), "Number of measurement sweeps between correlation function measurements.")
+        ("analysis-threads", boost::program_options::value<int>(&analysisThreadCount)->default_value(0), "Number of threads measuring clusters and correlations on copies of the lattice while the sweeps carry on, 0 to measure in the sweep loop.")
+        ("telemetry", boost::program_options::value<std::string>(&telemetryName)->implicit_value(std::string(TelemetrySegment::namePrefix) + std::to_string(getpid())), "Publish live metrics to a POSIX shared memory segment with this name, sirs-<pid> if no name is given. Read it with sirs-monitor.")
+        ("telemetry-image", boost::program_options::value<int>(&telemetryImageSide)->default_value(64), "Largest side in pixels of the lattice image published with the telemetry, 0 for none.")
+        ("telemetry-interval", boost::program_options::value<double>(&telemetryInterval)->default_value(0.25), "Minimum number of seconds between telemetry updates.")
+        ("counters", "Count cycles, instructions, cache, branch and TLB misses per cell update in the burn in, sweeps and analysis with Linux perf_event counters. The analysis includes the measurements, any animation, frames and telemetry, and the statistics at the end.")
+        ("frames", boost::program_options::value<int>(&frameInterval)->default_value(0), "Render the lattice to an image in the Frames directory every this many sweeps, 0 for none.")
+        ("frame-format", boost::program_options::value<std::string>(&frameFormatName)->default_value("png"), "Image format of the frames, png or ppm.")
+        ("frame-side", boost::program_options::value<int>(&frameSide)->default_value(0), "Largest side of a frame in pixels, larger lattices are downsampled, 0 for one pixel per cell.")
+        ("frame-palette", boost::program_options::value<std::string>(&framePalette)->default_value("red,green,blue,blue"), "Colours of susceptible, infected, recovered and immune cells in the frames, names or #rrggbb. The default matches animate.gp.")
+        ("frame-threads", boost::program_options::value<int>(&frameThreadCount)->default_value(1), "Number of threads encoding frames while the sweeps carry on, 0 to encode in the sweep loop.")
+        ("series-format", boost::program_options::value<std::string>(&seriesFormat)->default_value("text"), "Format the counts of each measurement sweep are written in, text (the infected count in OrderParameter.dat) or binary (every state count in Series.sts, read with sirs-series).")
+        ("series-levels", boost::program_options::value<int>(&seriesLevels)->default_value(0), "Number of downsampled levels of minimum, maximum and mean counts added to a binary series for plotting.")
+        ("series-factor", boost::program_options::value<int>(&seriesFactor)->default_value(16), "Number of buckets of the level below summarised by each bucket of a downsampled level.")
         ("animate,a","Animate the program by printing the current state of the lattice to an output file during simulation")
         ("help,h", "Produce help message");
 
@@ -76,14 +173,410 @@ int main(int argc, char const *argv[])
         return 1;
     }
 
+    // Choose the backing of large buffers before any are allocated.
+    HugePageMode hugePageMode = parseHugePageMode(hugePages);
+    if(MAXHUGEPAGEMODE == hugePageMode)
+    {
+        std::cerr << "Unknown huge page mode: " << hugePages << '\n';
+        return 1;
+    }
+    setHugePageMode(hugePageMode);
+
+    // In two dimensions the axis sizes are just the rows and columns.
+    if(2 == inputParameters.dimensions && 2 == inputParameters.axisSizes.size())
+    {
+        inputParameters.rowCount = inputParameters.axisSizes[0];
+        inputParameters.colCount = inputParameters.axisSizes[1];
+        inputParameters.axisSizes.clear();
+    }
+
+    // Create a generator that can be fed to any distribution to produce pseudo random numbers according to that distribution,
+    // it is the main stream of the run seed so the whole run can be reproduced.
+    RandomStream generator(inputParameters.seed, RandomStream::makeStreamId(RandomStream::MainPurpose, 0, 0));
+
+    // Follow a warm started chain through the phase diagram instead of a single simulation.
+    if("none" != chainMode)
+    {
+        if("probabilities" != chainMode && "immunity" != chainMode)
+        {
+            std::cerr << "Unknown chain: " << chainMode << '\n';
+            return 1;
+        }
+
+        const std::string &outputName = inputParameters.outputDirectory;
+        makeDirectory(outputName);
+
+        std::fstream inputParametersOutput(outputName+"/Input.txt", std::ios::out);
+        std::cout << inputParameters << '\n';
+        inputParametersOutput << inputParameters << '\n';
+
+        const bool probabilities = ("probabilities" == chainMode);
+        ParameterChain::Axes axes = probabilities ? ParameterChain::ProbabilityAxes : ParameterChain::ImmunityAxis;
+        std::vector<std::pair<double, double> > path = probabilities ?
+            ParameterChain::probabilityPath(chainCount) :
+            ParameterChain::immunityPath(scanMin, scanMax, chainCount);
+
+        ParameterChain chain(inputParameters, generator, chainWindow, chainMaxSweeps, chainTolerance);
+
+        std::vector<ParameterChain::ChainPoint> forward;
+        std::vector<ParameterChain::ChainPoint> backward;
+        try
+        {
+            forward = chain.follow(axes, path);
+            if(vm.count("hysteresis"))
+            {
+                std::reverse(path.begin(), path.end());
+                backward = chain.follow(axes, path);
+            }
+        }
+        catch(const std::invalid_argument &error)
+        {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
+
+        // Write each direction in the same format as a scan.
+        auto writePoints = [&](const std::vector<ParameterChain::ChainPoint> &points, const std::string &suffix)
+        {
+            std::vector<AdaptiveScan::ScanPoint> scanPoints = ParameterChain::toScanPoints(points);
+            if(probabilities)
+            {
+                std::fstream orderOutput(outputName+"/p1p3Order"+suffix+".dat", std::ios::out);
+                std::fstream susceptibilityOutput(outputName+"/p1p3Sus"+suffix+".dat", std::ios::out);
+                AdaptiveScan::writeProbabilityScan(orderOutput, susceptibilityOutput, scanPoints);
+            }
+            else
+            {
+                std::fstream immuneOutput(outputName+"/ImmuneOrder"+suffix+".dat", std::ios::out);
+                AdaptiveScan::writeImmunityScan(immuneOutput, scanPoints);
+            }
+
+            std::fstream pathOutput(outputName+"/Chain"+suffix+".dat", std::ios::out);
+            ParameterChain::writePath(pathOutput, points);
+        };
+
+        writePoints(forward, "");
+
+        // Compare the sweeps spent equilibrating with a full burn period at every point.
+        long burnSweeps = 0;
+        int coldStarts = 0;
+        for(const auto &points : {forward, backward})
+        {
+            for(const auto &point : points)
+            {
+                burnSweeps += point.burnSweeps;
+                coldStarts += point.coldStart;
+            }
+        }
+
+        const int pointCount = forward.size() + backward.size();
+        std::stringstream chainReport;
+        chainReport << "Chain..." << '\n';
+        chainReport << std::setw(30) << std::setfill(' ') << std::left << "Points: " << std::right << pointCount << '\n';
+        chainReport << std::setw(30) << std::setfill(' ') << std::left << "Cold-Starts: " << std::right << coldStarts << '\n';
+        chainReport << std::setw(30) << std::setfill(' ') << std::left << "Burn-Sweeps: " << std::right << burnSweeps << '\n';
+        chainReport << std::setw(30) << std::setfill(' ') << std::left << "Independent-Burn-Sweeps: " << 
+        std::right << static_cast<long>(pointCount) * inputParameters.burnPeriod << '\n';
+
+        if(vm.count("hysteresis"))
+        {
+            writePoints(backward, "Reverse");
+
+            std::fstream hysteresisOutput(outputName+"/Hysteresis.dat", std::ios::out);
+            ParameterChain::writeHysteresis(hysteresisOutput, forward, backward);
+
+            ParameterChain::Hysteresis hysteresis = ParameterChain::compare(forward, backward);
+            chainReport << std::setw(30) << std::setfill(' ') << std::left << "Hysteresis-Max-Difference: " << 
+            std::right << hysteresis.maxDifference << '\n';
+            chainReport << std::setw(30) << std::setfill(' ') << std::left << "Hysteresis-Max-Deviation: " << 
+            std::right << hysteresis.maxDeviation << '\n';
+            chainReport << std::setw(30) << std::setfill(' ') << std::left << "Hysteresis-Points: " << 
+            std::right << hysteresis.significantCount << '\n';
+        }
+
+        std::fstream resultsOutput(outputName+"/Results.txt", std::ios::out);
+        std::cout << chainReport.str();
+        resultsOutput << chainReport.str();
+
+        std::cout << std::setw(30) << std::setfill(' ') << std::left << "Time take to execute(s) =    " << 
+        std::right << timer.elapsed() << '\n';
+
+        return 0;
+    }
+
+    // Run an adaptive scan of the phase diagram instead of a single simulation.
+    if("none" != scanMode)
+    {
+        if("probabilities" != scanMode && "immunity" != scanMode)
+        {
+            std::cerr << "Unknown scan: " << scanMode << '\n';
+            return 1;
+        }
+
+        const std::string &outputName = inputParameters.outputDirectory;
+        makeDirectory(outputName);
+
+        std::fstream inputParametersOutput(outputName+"/Input.txt", std::ios::out);
+        std::cout << inputParameters << '\n';
+        inputParametersOutput << inputParameters << '\n';
+
+        // Each point is a complete in-process simulation, or a solution of the rate equations for a preview.
+        DeterministicSolver::Closure closure;
+        AdaptiveScan::Evaluator evaluator = [&generator](const SIRSInputParameters &parameters)
+        {
+            Simulation pointSimulation(parameters, generator);
+            return pointSimulation.run();
+        };
+
+        if(DeterministicSolver::parseEngine(inputParameters.engine, closure))
+        {
+            DeterministicSolver solver(closure);
+            evaluator = [solver](const SIRSInputParameters &parameters)
+            {
+                return solver.solve(parameters);
+            };
+        }
+
+        AdaptiveScan scan(inputParameters, evaluator, scanOrderTolerance, scanSusceptibilityFraction);
+
+        try
+        {
+            if("probabilities" == scanMode)
+            {
+                std::vector<AdaptiveScan::ScanPoint> points = scan.scanProbabilities(scanCoarseCount, scanDepth);
+
+                std::fstream orderOutput(outputName+"/p1p3Order.dat", std::ios::out);
+                std::fstream susceptibilityOutput(outputName+"/p1p3Sus.dat", std::ios::out);
+                AdaptiveScan::writeProbabilityScan(orderOutput, susceptibilityOutput, points);
+
+                std::cout << "Points evaluated: " << points.size() << '\n';
+            }
+            else
+            {
+                std::vector<AdaptiveScan::ScanPoint> points = scan.scanImmunity(scanMin, scanMax, scanCoarseCount, scanDepth);
+
+                std::fstream immuneOutput(outputName+"/ImmuneOrder.dat", std::ios::out);
+                AdaptiveScan::writeImmunityScan(immuneOutput, points);
+
+                double threshold = scan.bisectImmuneThreshold(scanMin, scanMax, bisectTolerance);
+
+                std::fstream resultsOutput(outputName+"/Results.txt", std::ios::out);
+                std::stringstream thresholdReport;
+                thresholdReport << std::setw(30) << std::setfill(' ') << std::left << "Immune-Threshold: " << 
+                std::right << threshold << " +/- " << bisectTolerance/2 << '\n';
+
+                std::cout << "Points evaluated: " << points.size() << '\n';
+                std::cout << thresholdReport.str();
+                resultsOutput << thresholdReport.str();
+            }
+        }
+        catch(const std::invalid_argument &error)
+        {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
+
+        std::cout << std::setw(30) << std::setfill(' ') << std::left << "Time take to execute(s) =    " << 
+        std::right << timer.elapsed() << '\n';
+
+        return 0;
+    }
+
+    // Compare the engine against the exact engine over the standard matrix instead of a single simulation.
+    if(vm.count("equivalence"))
+    {
+        DeterministicSolver::Closure closure;
+        if(DeterministicSolver::parseEngine(inputParameters.engine, closure))
+        {
+            std::cerr << "The " << inputParameters.engine << " engine does not sample the dynamics so cannot be compared" << '\n';
+            return 1;
+        }
+
+        const std::string &outputName = inputParameters.outputDirectory;
+        makeDirectory(outputName);
+
+        std::fstream inputParametersOutput(outputName+"/Input.txt", std::ios::out);
+        std::cout << inputParameters << '\n';
+        inputParametersOutput << inputParameters << '\n';
+
+        EngineComparison comparison(inputParameters, equivalenceRuns);
+        std::vector<EngineComparison::Comparison> comparisons;
+        try
+        {
+            comparisons = comparison.compare(EngineComparison::standardMatrix());
+        }
+        catch(const std::invalid_argument &error)
+        {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
+
+        std::fstream equivalenceOutput(outputName+"/Equivalence.dat", std::ios::out);
+        EngineComparison::writeComparisons(equivalenceOutput, comparisons);
+        EngineComparison::writeComparisons(std::cout, comparisons);
+        std::cout << '\n';
+
+        std::fstream resultsOutput(outputName+"/Results.txt", std::ios::out);
+        comparison.writeSummary(std::cout, comparisons);
+        comparison.writeSummary(resultsOutput, comparisons);
+
+        std::cout << std::setw(30) << std::setfill(' ') << std::left << "Time take to execute(s) =    " << 
+        std::right << timer.elapsed() << '\n';
+
+        // A failure makes the exit status non-zero so make check can stop on it.
+        bool passed = std::all_of(comparisons.begin(), comparisons.end(), [](const EngineComparison::Comparison &point)
+        {
+            return point.passed;
+        });
+
+        return passed ? 0 : 1;
+    }
+
+    // Solve the rate equations for the steady state instead of simulating.
+    DeterministicSolver::Closure closure;
+    if(DeterministicSolver::parseEngine(inputParameters.engine, closure))
+    {
+        SIRSResults results;
+        try
+        {
+            results = DeterministicSolver(closure).solve(inputParameters);
+        }
+        catch(const std::invalid_argument &error)
+        {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
+
+        const std::string &outputName = inputParameters.outputDirectory;
+        makeDirectory(outputName);
+
+        std::fstream inputParametersOutput(outputName+"/Input.txt", std::ios::out);
+        std::fstream resultsOutput(outputName+"/Results.txt", std::ios::out);
+
+        std::cout << inputParameters << '\n';
+        inputParametersOutput << inputParameters << '\n';
+
+        std::cout << results << '\n';
+        resultsOutput << results << '\n';
+
+        std::cout << std::setw(30) << std::setfill(' ') << std::left << "Time take to execute(s) =    " << 
+        std::right << timer.elapsed() << '\n';
+
+        return 0;
+    }
+
+    // Run independent replicas and combine them instead of a single simulation.
+    if(replicaCount > 1)
+    {
+        if(vm.count("clusters") || vm.count("correlations") || vm.count("animate") || frameInterval > 0 || vm.count("validate") || vm.count("telemetry") || vm.count("counters") || "text" != seriesFormat)
+        {
+            std::cerr << "Clusters, correlations, animation, frames, validation, telemetry, counters and binary series are only available for a single replica" << '\n';
+            return 1;
+        }
+
+        std::unique_ptr<ReplicaEnsemble> ensemble;
+        try
+        {
+            ensemble.reset(new ReplicaEnsemble(inputParameters, replicaCount));
+        }
+        catch(const std::invalid_argument &error)
+        {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
+
+        const std::string &outputName = inputParameters.outputDirectory;
+        makeDirectory(outputName);
+
+        std::fstream inputParametersOutput(outputName+"/Input.txt", std::ios::out);
+        std::cout << inputParameters << '\n';
+        inputParametersOutput << inputParameters << '\n';
+
+        SIRSResults results = ensemble->run();
+
+        std::fstream resultsOutput(outputName+"/Results.txt", std::ios::out);
+        std::cout << results << '\n';
+        resultsOutput << results << '\n';
+
+        // One line per replica, and the order parameter of every replica on each measurement sweep.
+        std::fstream replicaOutput(outputName+"/Replicas.dat", std::ios::out);
+        ensemble->writeReplicas(replicaOutput);
+
+        std::fstream orderParameterOutput(outputName+"/OrderParameter.dat", std::ios::out);
+        ensemble->writeOrderParameters(orderParameterOutput);
+
+        std::cout << std::setw(30) << std::setfill(' ') << std::left << "Time take to execute(s) =    " << 
+        std::right << timer.elapsed() << '\n';
+
+        return 0;
+    }
+
+    // The lattice measurements only exist for the 2D lattice.
+    if(("lattice" != inputParameters.topology || 2 != inputParameters.dimensions) && (vm.count("clusters") || vm.count("correlations") || vm.count("animate") || frameInterval > 0))
+    {
+        std::cerr << "Clusters, correlations, animation and frames are only available on the 2D lattice" << '\n';
+        return 1;
+    }
+
+    FrameRenderer::Format frameFormat = FrameRenderer::parseFormat(frameFormatName);
+    FrameRenderer::Palette palette;
+    if(frameInterval > 0 && (FrameRenderer::MAXFORMAT == frameFormat || !FrameRenderer::parsePalette(framePalette, palette)))
+    {
+        std::cerr << "Unknown frame format or palette: " << frameFormatName << ' ' << framePalette << '\n';
+        return 1;
+    }
+
+    if("text" != seriesFormat && "binary" != seriesFormat)
+    {
+        std::cerr << "Unknown series format: " << seriesFormat << '\n';
+        return 1;
+    }
+
+    // Take a copy of the generator so the validation run starts from exactly the same lattice.
+    RandomStream validationGenerator = generator;
+
+    // Create the simulation, this checks the parameters so do it before creating any output.
+    std::unique_ptr<Simulation> simulation;
+    try
+    {
+        simulation.reset(new Simulation(inputParameters, generator));
+    }
+    catch(const std::invalid_argument &error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    const std::string &outputName = inputParameters.outputDirectory;
+
     // Create an output directory from either the default time stamp or the user defined string.
     makeDirectory(outputName);
 
-    // Create an output file for the lattice so it can be animated.
-    std::fstream latticeOutput(outputName+"/Lattice.dat", std::ios::out);
+    // Create an output file for the lattice so it can be animated, networks and other dimensions have no 2D lattice to write.
+    const bool isLattice = ("lattice" == inputParameters.topology && 2 == inputParameters.dimensions);
+    std::fstream latticeOutput;
+    if(isLattice)
+    {
+        latticeOutput.open(outputName+"/Lattice.dat", std::ios::out);
+    }
 
-    // Create an output file for the order parameter which in this case is the fraction of infected states.
-    std::fstream orderParameterOutput(outputName+"/OrderParameter.dat", std::ios::out);
+    // Create an output file for the order parameter which in this case is the number of infected states,
+    // or a binary series of every state count instead.
+    std::fstream orderParameterOutput;
+    std::unique_ptr<TimeSeriesWriter> seriesOutput;
+    if("binary" == seriesFormat)
+    {
+        std::vector<std::string> columnNames;
+        for(int state = 0; state < SIRSArray::MAXSTATE; ++state)
+        {
+            columnNames.push_back(simulation->getMeasurements().getColumnName(state));
+        }
+        seriesOutput.reset(new TimeSeriesWriter(outputName+"/Series.sts", columnNames, seriesLevels, seriesFactor));
+    }
+    else
+    {
+        orderParameterOutput.open(outputName+"/OrderParameter.dat", std::ios::out);
+    }
 
     // Create an output file for the input parameters.
     std::fstream inputParametersOutput(outputName+"/Input.txt", std::ios::out);
@@ -91,69 +584,201 @@ int main(int argc, char const *argv[])
     // Create an output file for the results.
     std::fstream resultsOutput(outputName+"/Results.txt", std::ios::out);
 
-    // Create a SIRS lattice that will be used in the simulation.
-    SIRSArray lattice(generator,rowCount, colCount, probSI, probIR, probRS, immuneFraction);
-
     // Print the initial lattice to an output file.
-    latticeOutput << lattice;
-
-    // Create an object to hold the input parameters.
-    SIRSInputParameters inputParameters
-    {
-      rowCount,
-      colCount,
-      probSI,
-      probIR,
-      probRS,
-      burnPeriod,
-      totalSweeps,
-      measurementInterval,
-      outputName,
-      immuneFraction
-    };
+    if(isLattice)
+    {
+        latticeOutput << simulation->getLattice();
+    }
 
     // Print the input parameters to the command line and to the output file.
     std::cout << inputParameters << '\n';
     inputParametersOutput << inputParameters << '\n';
 
-    // Create an array to store the value of the order parameter on each recorded sweep.
-    DataArray orderParameterData(totalSweeps/measurementInterval);
+    // Describe the network that was actually built.
+    if(simulation->getNetwork())
+    {
+        std::cout << *simulation->getNetwork() << '\n';
+        inputParametersOutput << *simulation->getNetwork() << '\n';
+    }
+
+    // Output the number of infected states and the current sweep on each measurement sweep.
+    if(seriesOutput)
+    {
+        const Simulation &measured = *simulation;
+        TimeSeriesWriter &series = *seriesOutput;
+        simulation->addMeasurementCallback([&measured, &series](int sweep, double, const SIRSArray&)
+        {
+            // The counts were just recorded as the last measurement.
+            const MeasurementSeries &measurements = measured.getMeasurements();
+            const int last = measurements.getSize() - 1;
+
+            MeasurementSeries::StateCounts counts;
+            for(int state = 0; state < SIRSArray::MAXSTATE; ++state)
+            {
+                counts[state] = measurements.getColumn(state)[last];
+            }
+            series.append(sweep, counts.data());
+        });
+    }
+    else
+    {
+        simulation->addMeasurementCallback([&orderParameterOutput](int sweep, double orderParameter, const SIRSArray&)
+        {
+            orderParameterOutput << sweep << ' ' <<  orderParameter << '\n';
+        });
+    }
+
+    // Open the counters before any analysis thread starts so the threads are counted with the run.
+    std::unique_ptr<PerfCounters> counters;
+    if(vm.count("counters"))
+    {
+        counters.reset(new PerfCounters());
+        simulation->setPerfCounters(counters.get());
+    }
+
+    // Clusters and correlations are measured on snapshots by the analysis threads, each thread labels
+    // and transforms with its own scratch space and the results are added to the totals in sweep order.
+    MeasurementPipeline pipeline(analysisThreadCount);
+    const int scratchCount = std::max(1, pipeline.getThreadCount());
+
+    // Label the infected clusters on measurement sweeps, their statistics are written at the end.
+    ClusterAnalysis clusters(inputParameters.threadCount);
+    std::vector<ClusterAnalysis> clusterLabellers;
+    if(vm.count("clusters"))
+    {
+        // Inline the labelling can use the simulation's threads, otherwise the analysis threads share the work.
+        clusterLabellers.assign(scratchCount, ClusterAnalysis(pipeline.getThreadCount() > 0 ? 1 : inputParameters.threadCount));
+        pipeline.addAnalysis([&clusters, &clusterLabellers](int, const SIRSArray &snapshot, int worker)
+        {
+            ClusterAnalysis::Labelling labelling = clusterLabellers[worker].label(snapshot);
+            return MeasurementPipeline::Commit([&clusters, labelling]()
+            {
+                clusters.add(labelling);
+            });
+        });
+    }
+
+    // Accumulate the structure factor on every correlationInterval-th measurement sweep.
+    CorrelationFunction correlations(inputParameters.rowCount, inputParameters.colCount);
+    std::vector<CorrelationFunction> correlationTransforms;
+    if(vm.count("correlations"))
+    {
+        correlationTransforms.assign(scratchCount, correlations);
+        pipeline.addAnalysis([&correlations, &correlationTransforms](int, const SIRSArray &snapshot, int worker)
+        {
+            auto structureFactor = std::make_shared<std::vector<double> >(correlationTransforms[worker].structureFactorOf(snapshot));
+            return MeasurementPipeline::Commit([&correlations, structureFactor]()
+            {
+                correlations.add(*structureFactor);
+            });
+        }, correlationInterval);
+    }
+
+    if(vm.count("clusters") || vm.count("correlations"))
+    {
+        simulation->addMeasurementCallback([&pipeline](int sweep, double, const SIRSArray &lattice)
+        {
+            pipeline.submit(sweep, lattice);
+        });
+    }
+
+    // Publish live metrics for sirs-monitor, a run without telemetry is still worth finishing.
+    std::unique_ptr<TelemetryPublisher> telemetry;
+    if(vm.count("telemetry"))
+    {
+        try
+        {
+            telemetry.reset(new TelemetryPublisher(
+                telemetryName,
+                simulation->getStateData().size(),
+                isLattice ? inputParameters.rowCount : 0,
+                isLattice ? inputParameters.colCount : 0,
+                inputParameters.burnPeriod + inputParameters.sweeps,
+                telemetryImageSide,
+                telemetryInterval));
+            std::cout << "Publishing telemetry to: " << telemetry->getName() << '\n';
+        }
+        catch(const std::runtime_error &error)
+        {
+            std::cerr << error.what() << '\n';
+        }
+    }
+
+    // Frames are encoded and written by their own threads from snapshots of the lattice.
+    MeasurementPipeline framePipeline(frameThreadCount);
+    std::unique_ptr<FrameRenderer> renderer;
+    int frameFailures = 0;
+    if(frameInterval > 0)
+    {
+        makeDirectory(outputName+"/Frames");
+        renderer.reset(new FrameRenderer(outputName+"/Frames", frameFormat, frameSide, palette));
+
+        const FrameRenderer &frameRenderer = *renderer;
+        framePipeline.addAnalysis([&frameRenderer, &frameFailures](int sweep, const SIRSArray &snapshot, int)
+        {
+            bool written = frameRenderer.render(sweep, snapshot);
+            return MeasurementPipeline::Commit([&frameFailures, written]()
+            {
+                frameFailures += written ? 0 : 1;
+            });
+        });
+    }
+
+    const bool animate = vm.count("animate");
+    if(animate || telemetry || renderer)
+    {
+        const Simulation &running = *simulation;
+        simulation->setSweepCallback([&latticeOutput, &telemetry, &running, &framePipeline, animate, frameInterval](int sweep, const SIRSArray &lattice)
+        {
+            if(animate)
+            {
+                // Move to the top of the file.
+                latticeOutput.seekg(0,std::ios::beg);
+
+                // Output the current state of the lattice.
+                latticeOutput << lattice << std::flush;
+            }
+
+            if(frameInterval > 0 && 0 == sweep % frameInterval)
+            {
+                framePipeline.submit(sweep, lattice);
+            }
+
+            if(telemetry)
+            {
+                telemetry->publish(sweep, running.getStateData());
+            }
+        });
+    }
 
 /*************************************************************************************************************************
 ************************************************* Main Loop *************************************************************
 *************************************************************************************************************************/
-  
-  
-   for(int sweep = 0; sweep < totalSweeps+burnPeriod; ++sweep )
-   {
-      // Update the lattice by performing row*col sweeps.
-      for(int i = 0; i < lattice.getSize(); ++i)
-      {
-        lattice.update(generator);
-      }
 
-      // If we are on a measurement sweep then do any measurement/output.
-      if((0 == sweep%measurementInterval) && (sweep >= burnPeriod))
-      {
-        // Calculate the fraction of infected sites on this sweep.
-        double orderParameter = lattice.stateCount(SIRSArray::Infected);
+   SIRSResults results = simulation->run();
 
-        // Output the fraction of infected states and the current sweep.
-        orderParameterOutput << sweep << ' ' <<  orderParameter << '\n';
+   // Wait for the analysis threads to catch up with the last measurement sweep.
+   if(counters)
+   {
+      counters->enter(PerfCounters::AnalysisPhase);
+   }
 
-        // Record the order parameter on this sweep.
-        orderParameterData.push_back(orderParameter);
+   pipeline.finish();
+   framePipeline.finish();
 
-        
-      }
-      if(vm.count("animate"))
-      {
-        // Move to the top of the file.
-      latticeOutput.seekg(0,std::ios::beg);
+   if(counters)
+   {
+      counters->leave();
+   }
 
-      // Output the current state of the lattice.
-      latticeOutput << lattice << std::flush;
-      }
+   if(seriesOutput)
+   {
+      seriesOutput->close();
+   }
+
+   if(telemetry)
+   {
+      telemetry->finish(inputParameters.burnPeriod + inputParameters.sweeps - 1, simulation->getStateData());
    }
     
 
@@ -161,33 +786,83 @@ int main(int argc, char const *argv[])
 ******************************************** Output/Clean Up *************************************************************
 **************************************************************************************************************************/
 
-   // Average the order parameter and calculate the error.
-   double orderParameterAverage = orderParameterData.mean()/lattice.getSize();
-   double orderParameterError   = orderParameterData.error()/lattice.getSize();
-
-   // Calculate the ``Susceptibility'' of the order parameter.
-   // Create susceptibility functor.
-   Susceptibility susceptibilityFcn;
-   double susceptibility = susceptibilityFcn(orderParameterData)/lattice.getSize();
-
-   // Calculate the error in the susceptibility using jackknife.
-   double susceptibilityError = jackKnife(susceptibilityFcn, orderParameterData)/lattice.getSize();
-
-   // Create an object to hold the results.
-   SIRSResults results
-   {
-        orderParameterAverage,
-        orderParameterError,
-        susceptibility,
-        susceptibilityError,
-   };
-   
    // Output the results to the command line.
    std::cout << results << '\n';
 
    // Output the results to the output file.
    resultsOutput << results << '\n';
 
+   // Output every observable recorded alongside the order parameter, and the measurements themselves.
+   MeasurementSeries::writeEstimates(std::cout, simulation->getEstimates());
+   std::cout << '\n';
+   MeasurementSeries::writeEstimates(resultsOutput, simulation->getEstimates());
+   resultsOutput << '\n';
+
+   std::fstream measurementOutput(outputName+"/Measurements.dat", std::ios::out);
+   simulation->getMeasurements().writeColumns(measurementOutput);
+
+   if(frameFailures > 0)
+   {
+      std::cerr << frameFailures << " frames could not be written" << '\n';
+   }
+
+   if(counters)
+   {
+      std::cout << *counters << '\n';
+      resultsOutput << *counters << '\n';
+   }
+
+   if(vm.count("clusters"))
+   {
+      std::cout << clusters << '\n';
+      resultsOutput << clusters << '\n';
+
+      std::fstream clusterSizeOutput(outputName+"/ClusterSizes.dat", std::ios::out);
+      clusters.writeHistogram(clusterSizeOutput);
+   }
+
+   if(vm.count("correlations"))
+   {
+      std::cout << correlations << '\n';
+      resultsOutput << correlations << '\n';
+
+      std::fstream correlationOutput(outputName+"/Correlation.dat", std::ios::out);
+      for(const auto &shell : correlations.correlation())
+      {
+         correlationOutput << shell.first << ' ' << shell.second << '\n';
+      }
+
+      std::fstream structureFactorOutput(outputName+"/StructureFactor.dat", std::ios::out);
+      for(const auto &shell : correlations.structureFactor())
+      {
+         structureFactorOutput << shell.first << ' ' << shell.second << '\n';
+      }
+   }
+
+   // Compare against the exact engine started from the same lattice.
+   if(vm.count("validate"))
+   {
+      SIRSInputParameters exactParameters = inputParameters;
+      exactParameters.engine = "exact";
+
+      Simulation exactSimulation(exactParameters, validationGenerator);
+      SIRSResults exactResults = exactSimulation.run();
+
+      // Difference between the engines in units of their combined error.
+      double deviation = std::abs(results.orderParameter - exactResults.orderParameter)/
+      std::sqrt(results.orderParameterError*results.orderParameterError + exactResults.orderParameterError*exactResults.orderParameterError);
+
+      std::stringstream validation;
+      validation << "Validation..." << '\n';
+      validation << std::setw(30) << std::setfill(' ') << std::left << "Exact-Order-Parameter: " << 
+      std::right << exactResults.orderParameter << " +/- " << exactResults.orderParameterError << '\n';
+      validation << std::setw(30) << std::setfill(' ') << std::left << "Deviation(sigma): " << 
+      std::right << deviation << '\n';
+
+      std::cout << validation.str() << '\n';
+      resultsOutput << validation.str() << '\n';
+   }
+
    // Report how long the program took to execute.
    std::cout << std::setw(30) << std::setfill(' ') << std::left << "Time take to execute(s) =    " << 
    std::right << timer.elapsed() << '\n';
@@ -0,0 +1,42 @@
+#ifndef parallelFor_hpp
+#define parallelFor_hpp
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/**
+ *\file
+ *\brief Function to split a range of indices into contiguous blocks and process them on separate threads.
+ *\param begin first index of the range.
+ *\param end one past the last index of the range.
+ *\param threadCount integer value representing the number of threads to use, clamped to [1,end-begin].
+ *\param work callable invoked as work(blockBegin, blockEnd, threadIndex) once per block.
+ *
+ * Block t covers [begin + n*t/threadCount, begin + n*(t+1)/threadCount) where n = end - begin, the calling
+ * thread processes block 0 and the function returns once every block has been processed.
+ */
+template<class Index, class Work>
+void parallelFor(Index begin, Index end, int threadCount, Work work)
+{
+	const Index count = end - begin;
+
+	// Clamp while still an int, a negative count converted to an unsigned Index would be huge.
+	threadCount = std::max(1, threadCount);
+	threadCount = static_cast<int>(std::max<Index>(1, std::min<Index>(threadCount, count)));
+
+	std::vector<std::thread> threads;
+	for(int t = 1; t < threadCount; ++t)
+	{
+		threads.emplace_back(work, begin + count * t / threadCount, begin + count * (t + 1) / threadCount, t);
+	}
+
+	work(begin, begin + count / threadCount, 0);
+
+	for(auto &thread : threads)
+	{
+		thread.join();
+	}
+}
+
+#endif /* parallelFor_hpp */
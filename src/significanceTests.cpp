@@ -0,0 +1,167 @@
+#include "significanceTests.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	/**
+	 *\brief Evaluates the continued fraction of the regularised incomplete beta function by Lentz's method.
+	 *\param a first shape parameter.
+	 *\param b second shape parameter.
+	 *\param x point to evaluate at, below (a+1)/(a+b+2) for fast convergence.
+	 *\return floating point value of the continued fraction.
+	 */
+	double betaFraction(double a, double b, double x)
+	{
+		const double tiny = 1e-300;
+		const double epsilon = 1e-15;
+
+		double c = 1.0;
+		double d = 1.0 - (a + b) * x / (a + 1.0);
+		d = (std::abs(d) < tiny) ? 1.0 / tiny : 1.0 / d;
+		double fraction = d;
+
+		for(int m = 1; m < 1000; ++m)
+		{
+			// Even step.
+			double numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+			d = 1.0 + numerator * d;
+			d = (std::abs(d) < tiny) ? 1.0 / tiny : 1.0 / d;
+			c = 1.0 + numerator / c;
+			c = (std::abs(c) < tiny) ? tiny : c;
+			fraction *= d * c;
+
+			// Odd step.
+			numerator = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+			d = 1.0 + numerator * d;
+			d = (std::abs(d) < tiny) ? 1.0 / tiny : 1.0 / d;
+			c = 1.0 + numerator / c;
+			c = (std::abs(c) < tiny) ? tiny : c;
+			double change = d * c;
+			fraction *= change;
+
+			if(std::abs(change - 1.0) < epsilon)
+			{
+				break;
+			}
+		}
+
+		return fraction;
+	}
+
+	/**
+	 *\brief Regularised incomplete beta function I_x(a, b).
+	 *\param a first shape parameter.
+	 *\param b second shape parameter.
+	 *\param x point between 0 and 1.
+	 *\return floating point value between 0 and 1.
+	 */
+	double incompleteBeta(double a, double b, double x)
+	{
+		if(x <= 0.0)
+		{
+			return 0.0;
+		}
+
+		if(x >= 1.0)
+		{
+			return 1.0;
+		}
+
+		double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+
+		// The continued fraction converges quickly on one side of the mean, use the symmetry for the other.
+		if(x < (a + 1.0) / (a + b + 2.0))
+		{
+			return front * betaFraction(a, b, x) / a;
+		}
+
+		return 1.0 - front * betaFraction(b, a, 1.0 - x) / b;
+	}
+
+	/**
+	 *\brief Logarithm of the hypergeometric probability of a 2x2 table with fixed margins.
+	 *\param count number of outcomes in the first group.
+	 *\param firstSize number of trials in the first group.
+	 *\param secondSize number of trials in the second group.
+	 *\param totalCount number of outcomes in both groups.
+	 *\return floating point value of the log probability.
+	 */
+	double logTableProbability(int count, int firstSize, int secondSize, int totalCount)
+	{
+		auto logChoose = [](int n, int k)
+		{
+			return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+		};
+
+		return logChoose(firstSize, count) + logChoose(secondSize, totalCount - count) - logChoose(firstSize + secondSize, totalCount);
+	}
+}
+
+double welchTest(const std::vector<double> &first, const std::vector<double> &second)
+{
+	auto meanAndVariance = [](const std::vector<double> &values, double &mean, double &variance)
+	{
+		mean = 0;
+		for(double value : values)
+		{
+			mean += value;
+		}
+		mean /= values.size();
+
+		variance = 0;
+		for(double value : values)
+		{
+			variance += (value - mean) * (value - mean);
+		}
+		variance /= (values.size() - 1);
+	};
+
+	if(first.size() < 2 || second.size() < 2)
+	{
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	double firstMean, firstVariance, secondMean, secondVariance;
+	meanAndVariance(first, firstMean, firstVariance);
+	meanAndVariance(second, secondMean, secondVariance);
+
+	// Squared standard errors of the two means.
+	double firstError  = firstVariance / first.size();
+	double secondError = secondVariance / second.size();
+	double error = firstError + secondError;
+
+	if(error <= 0)
+	{
+		return (firstMean == secondMean) ? 1.0 : 0.0;
+	}
+
+	double t = (firstMean - secondMean) / std::sqrt(error);
+	double degrees = error * error / (firstError * firstError / (first.size() - 1) + secondError * secondError / (second.size() - 1));
+
+	// Two-sided tail of Student's t distribution.
+	return incompleteBeta(degrees / 2, 0.5, degrees / (degrees + t * t));
+}
+
+double fisherExactTest(int firstCount, int firstSize, int secondCount, int secondSize)
+{
+	const int totalCount = firstCount + secondCount;
+	const int lowest  = std::max(0, totalCount - secondSize);
+	const int highest = std::min(firstSize, totalCount);
+
+	// Tables within rounding of the observed probability count as no more likely.
+	const double observed = logTableProbability(firstCount, firstSize, secondSize, totalCount) + 1e-7;
+
+	double pValue = 0;
+	for(int count = lowest; count <= highest; ++count)
+	{
+		double logProbability = logTableProbability(count, firstSize, secondSize, totalCount);
+		if(logProbability <= observed)
+		{
+			pValue += std::exp(logProbability);
+		}
+	}
+
+	return std::min(1.0, pValue);
+}
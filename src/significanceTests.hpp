@@ -0,0 +1,37 @@
+#ifndef significanceTests_hpp
+#define significanceTests_hpp
+
+#include <vector>
+
+/**
+ *\file
+ *\brief Functions for testing whether two sets of independent samples could come from the same distribution.
+ */
+
+/**
+ *\brief Welch's t-test for equal means of two samples that may have different variances.
+ *\param first vector of independent values, at least two.
+ *\param second vector of independent values, at least two.
+ *\return floating point value representing the two-sided p-value.
+ *
+ * The t statistic uses the standard error of each mean separately and the degrees of freedom come from
+ * the Welch-Satterthwaite equation, so the samples need not be the same size. If neither sample varies
+ * the p-value is 1 if the means are equal and 0 otherwise.
+ */
+double welchTest(const std::vector<double> &first, const std::vector<double> &second);
+
+/**
+ *\brief Fisher's exact test for equal rates of an outcome in two groups.
+ *\param firstCount number of times the outcome happened in the first group.
+ *\param firstSize number of trials in the first group.
+ *\param secondCount number of times the outcome happened in the second group.
+ *\param secondSize number of trials in the second group.
+ *\return floating point value representing the two-sided p-value.
+ *
+ * The p-value is the total probability, with the margins of the 2x2 table held fixed, of every table
+ * no more likely than the one observed. Exact for any number of trials, so it suits the handful of
+ * extinctions seen in a few runs.
+ */
+double fisherExactTest(int firstCount, int firstSize, int secondCount, int secondSize);
+
+#endif /* significanceTests_hpp */
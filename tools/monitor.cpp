@@ -0,0 +1,133 @@
+#include "TelemetryReader.hpp"
+#include "SIRSArray.hpp"
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <signal.h>
+
+/**
+ *\file
+ *\brief Companion program to sirs that prints the live telemetry of running simulations.
+ *
+ * Every named segment, or every sirs-* segment if none are named, is read once and shown as one
+ * row of a table. With --watch the table is redrawn until every run has finished.
+ */
+int main(int argc, char const *argv[])
+{
+    std::vector<std::string> names;
+    double watchInterval;
+
+    boost::program_options::options_description desc("Options for the SIRS telemetry monitor");
+    desc.add_options()
+        ("segment", boost::program_options::value<std::vector<std::string> >(&names), "Names of the telemetry segments to show, all sirs-* segments if none are given.")
+        ("watch,w", boost::program_options::value<double>(&watchInterval)->implicit_value(1.0), "Redraw the table every so many seconds until every run has finished.")
+        ("image", "Print the lattice image of each run under the table.")
+        ("help,h", "Produce help message");
+
+    boost::program_options::positional_options_description positional;
+    positional.add("segment", -1);
+
+    boost::program_options::variables_map vm;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+    boost::program_options::notify(vm);
+
+    if(vm.count("help"))
+    {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    const bool watch = vm.count("watch");
+    const bool showImage = vm.count("image");
+
+    while(true)
+    {
+        std::vector<std::string> segments = names.empty() ? TelemetryReader::listSegments() : names;
+
+        if(watch)
+        {
+            // Clear the terminal and move to the top left.
+            std::cout << "\033[H\033[2J";
+        }
+
+        std::cout << std::left << std::setw(24) << "Segment" << std::right
+        << std::setw(12) << "Sweep" << std::setw(9) << "Done(%)"
+        << std::setw(10) << "S" << std::setw(10) << "I" << std::setw(10) << "R" << std::setw(10) << "Immune"
+        << std::setw(14) << "Updates/s" << std::setw(10) << "ETA(s)" << '\n';
+
+        bool running = false;
+        std::vector<std::pair<std::string, std::string> > images;
+        for(const auto &segment : segments)
+        {
+            TelemetryMetrics metrics;
+            std::vector<unsigned char> image;
+            try
+            {
+                TelemetryReader reader(segment);
+                if(!reader.read(metrics, showImage ? &image : nullptr))
+                {
+                    std::cout << std::left << std::setw(24) << segment << "busy" << '\n';
+                    running = true;
+                    continue;
+                }
+            }
+            catch(const std::runtime_error &error)
+            {
+                // Runs remove their segment when they finish so it may have gone since it was listed.
+                std::cout << std::left << std::setw(24) << segment << error.what() << '\n';
+                continue;
+            }
+
+            // A run that was killed leaves its segment behind without ever finishing.
+            const bool alive = metrics.finished || 0 == kill(metrics.processId, 0);
+            running = running || (alive && !metrics.finished);
+
+            std::cout << std::left << std::setw(24) << segment << std::right
+            << std::setw(12) << metrics.sweep
+            << std::setw(9) << std::fixed << std::setprecision(1) << 100.0 * (metrics.sweep + 1) / std::max<std::int64_t>(1, metrics.totalSweeps)
+            << std::setw(10) << metrics.stateCounts[SIRSArray::Susceptible]
+            << std::setw(10) << metrics.stateCounts[SIRSArray::Infected]
+            << std::setw(10) << metrics.stateCounts[SIRSArray::Recovered]
+            << std::setw(10) << metrics.stateCounts[SIRSArray::Immune]
+            << std::setw(14) << std::setprecision(3) << std::scientific << metrics.updatesPerSecond
+            << std::setw(10) << std::fixed << std::setprecision(0) << (metrics.finished ? 0.0 : metrics.secondsRemaining)
+            << std::defaultfloat << (alive ? "" : "  stopped") << '\n';
+
+            if(showImage && !image.empty())
+            {
+                std::string picture;
+                for(std::uint32_t row = 0; row < metrics.imageRows; ++row)
+                {
+                    for(std::uint32_t col = 0; col < metrics.imageCols; ++col)
+                    {
+                        unsigned char state = image[col + row * metrics.imageCols];
+                        picture += (state < SIRSArray::MAXSTATE) ? static_cast<char>('0' + SIRSArray::stateSymbols[state]) : '?';
+                    }
+                    picture += '\n';
+                }
+                images.push_back(std::make_pair(segment, picture));
+            }
+        }
+
+        for(const auto &image : images)
+        {
+            std::cout << '\n' << image.first << ":\n" << image.second;
+        }
+        std::cout << std::flush;
+
+        if(!watch || !running)
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(watchInterval));
+    }
+
+    return 0;
+}
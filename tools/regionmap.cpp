@@ -0,0 +1,77 @@
+#include "RegionMap.hpp"
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+
+/**
+ *\file
+ *\brief Companion program to sirs that converts region maps between text and the binary map files --region-map reads.
+ *
+ * A text map is the rows, columns and number of regions, p_1, p_2 and p_3 of each region, then the
+ * region of every cell row by row, with anything after a # ignored. For example a 4x4 lattice with
+ * a low infectivity left half is
+ *
+ *     4 4 2
+ *     0.2 0.1 0.01
+ *     1.0 0.1 0.01
+ *     0 0 1 1
+ *     0 0 1 1
+ *     0 0 1 1
+ *     0 0 1 1
+ *
+ * and sirs-regionmap map.txt -o map.bin writes it as a binary map. --text prints a binary map as text.
+ */
+int main(int argc, char const *argv[])
+{
+    std::string inputName;
+    std::string outputName;
+
+    boost::program_options::options_description desc("Options for the SIRS region map converter");
+    desc.add_options()
+        ("input", boost::program_options::value<std::string>(&inputName), "Text region map to convert, or binary map with --text.")
+        ("output,o", boost::program_options::value<std::string>(&outputName)->default_value("RegionMap.bin"), "Binary map file to write.")
+        ("text", "Print the binary map given as input as text instead of converting.")
+        ("help,h", "Produce help message");
+
+    boost::program_options::positional_options_description positional;
+    positional.add("input", 1);
+
+    boost::program_options::variables_map vm;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+    boost::program_options::notify(vm);
+
+    if(vm.count("help") || !vm.count("input"))
+    {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    try
+    {
+        if(vm.count("text"))
+        {
+            RegionMap::load(inputName).writeText(std::cout);
+            return 0;
+        }
+
+        std::ifstream in(inputName);
+        if(!in)
+        {
+            std::cerr << "Cannot read text region map: " << inputName << '\n';
+            return 1;
+        }
+
+        RegionMap map = RegionMap::readText(in);
+        map.save(outputName);
+        std::cout << "Wrote " << map.getRows() << "x" << map.getCols() << " map with " << map.getTable().size() << " regions to " << outputName << '\n';
+    }
+    catch(const std::invalid_argument &error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "TimeSeriesReader.hpp"
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+/**
+ *\file
+ *\brief Companion program to sirs that turns a binary Series.sts back into text.
+ *
+ * By default the infected column is written as "sweep count" lines, exactly the OrderParameter.dat
+ * a text run writes, so the existing plotting scripts can read it. --columns writes every column of
+ * the measurements or of a downsampled level instead.
+ */
+int main(int argc, char const *argv[])
+{
+    std::string fileName;
+    std::string columnName;
+    int level;
+
+    boost::program_options::options_description desc("Options for the SIRS time series reader");
+    desc.add_options()
+        ("file", boost::program_options::value<std::string>(&fileName)->default_value("Series.sts"), "Binary time series written by sirs --series-format binary.")
+        ("column", boost::program_options::value<std::string>(&columnName)->default_value("Infected"), "Column written as sweep count lines, Susceptible, Infected, Recovered or Immune.")
+        ("columns", "Write every column of the chosen level, one row per line, instead of a single column.")
+        ("level", boost::program_options::value<int>(&level)->default_value(0), "Level written by --columns, 0 for the measurements, otherwise the minimum, maximum and mean of each column over its buckets.")
+        ("info", "Print the columns, levels and number of rows of the file instead of its contents.")
+        ("help,h", "Produce help message");
+
+    boost::program_options::positional_options_description positional;
+    positional.add("file", 1);
+
+    boost::program_options::variables_map vm;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+    boost::program_options::notify(vm);
+
+    if(vm.count("help"))
+    {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    try
+    {
+        TimeSeriesReader reader(fileName);
+
+        if(!reader.isComplete())
+        {
+            std::cerr << fileName << " has no end chunk, the run that wrote it did not finish" << '\n';
+        }
+
+        if(vm.count("info"))
+        {
+            std::cout << "Columns:";
+            for(const auto &name : reader.getColumnNames())
+            {
+                std::cout << ' ' << name;
+            }
+            std::cout << '\n';
+
+            for(int n = 0; n <= reader.getLevelCount(); ++n)
+            {
+                std::cout << "Level " << n << ": " << reader.getLevel(n).sweeps.size() << " rows" << '\n';
+            }
+            std::cout << "Level-Factor: " << reader.getLevelFactor() << '\n';
+            return 0;
+        }
+
+        if(vm.count("columns"))
+        {
+            if(level < 0 || level > reader.getLevelCount())
+            {
+                std::cerr << "No level " << level << " in " << fileName << '\n';
+                return 1;
+            }
+
+            reader.writeColumns(std::cout, level);
+            return 0;
+        }
+
+        int column = reader.findColumn(columnName);
+        if(column < 0)
+        {
+            std::cerr << "No column " << columnName << " in " << fileName << '\n';
+            return 1;
+        }
+
+        reader.writeText(std::cout, column);
+    }
+    catch(const std::runtime_error &error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}